@@ -8,12 +8,19 @@ extern "C" {
 
 /* Includes */
 #include <stdbool.h>
+#include <stdarg.h>
 #include "ssd_1306_font.h"
 #include "stm32f4xx_hal.h"
 
+/* Panel geometry - 128x64 by default, 128x32, 96x16 and 64x48 are also supported (e.g. -DSSD1306_HEIGHT=32) */
+#ifndef SSD1306_WIDTH
 #define SSD1306_WIDTH        128
+#endif
+#ifndef SSD1306_HEIGHT
 #define SSD1306_HEIGHT       64
+#endif
 #define SSD1306_BUFFER_SZ    (SSD1306_WIDTH * SSD1306_HEIGHT / 8)
+#define SSD1306_PAGES        (SSD1306_HEIGHT / 8)
 
 /* Values for the user */
 #define SSD1306_CONTRAST_DEFAULT_NOVCC      0xCF    /* Default contrast value - After reset */
@@ -24,10 +31,142 @@ extern "C" {
 #define SSD1306_EXTERNALVCC                 0x01    /* External display voltage source */
 #define SSD1306_SWITCHCAPVCC                0x02    /* Generate display voltage from 3.3V pin */
 
+/* Raster operations - How the drawing routines merge their pixels into the buffer */
+#define SSD1306_ROP_COPY                    0x00    /* Draw both colors as they are (default) */
+#define SSD1306_ROP_OR                      0x01    /* Draw only the black(true) pixels, the rest is transparent */
+#define SSD1306_ROP_AND_NOT                 0x02    /* Clear where black(true) is drawn - Erase by mask */
+#define SSD1306_ROP_XOR                     0x03    /* Invert where black(true) is drawn - Drawing twice undoes it */
+
 /* Extra options */
 #define SSD1306_DEBUG               /* Activate screen debug mode - Thorough printing in the terminal */
 #define SSD1306_DMA_ACTIVE          /* Enable SPI transmissions via DMA */
+#define SSD1306_PARTIAL_REFRESH     /* Track the modified area of the buffer for partial refreshes */
+//#define SSD1306_GLYPH_CACHE       /* Keep the small font glyphs decoded per alignment and inversion (2280 bytes of RAM) */
 #define SSD1306_TIMEOUT     10      /* Timeout for polling SPI - 10ms is enough */
+#define SSD1306_WINDOW_COST 6       /* Cost of a new window in bytes, clean gaps up to this size are sent instead */
+#define SSD1306_MAX_WINDOWS 16      /* Maximum windows sent per partial refresh */
+#define SSD1306_QUEUE_SZ    40      /* Transfers that can be queued for DMA */
+#define SSD1306_CMD_RING_SZ 128     /* Bytes reserved for the queued commands */
+#define SSD1306_MAX_HANDLES 4       /* Screens that can be initialized for DMA at the same time */
+
+/* Buffer needed by the strip rendering - Two pages with DMA, so that one is sent while the other is drawn */
+#ifdef SSD1306_DMA_ACTIVE
+#define SSD1306_STRIP_SZ     (2 * SSD1306_WIDTH)
+#else
+#define SSD1306_STRIP_SZ     SSD1306_WIDTH
+#endif
+
+#ifdef SSD1306_DMA_ACTIVE
+/* A queued SPI transfer - Data transfers may cover the same columns of consecutive pages */
+typedef struct ssd_1306_segment_struct
+{
+    const uint8_t *data;
+    uint16_t len;
+    uint8_t rows;
+    bool type;
+}ssd_1306_segment_t;
+
+/* SPI bus shared by several screens, each with its own CE pin - Transfers are scheduled by the DMA ISR */
+typedef struct ssd_1306_bus_struct
+{
+    SPI_HandleTypeDef *h_spi;
+
+    /* Attached screens and the one being sent - Managed by the library !! */
+    struct ssd_1306_base_struct *handles[SSD1306_MAX_HANDLES];
+    uint8_t nb_handles;
+    struct ssd_1306_base_struct * volatile active;
+}ssd_1306_bus_t;
+#endif
+
+/* Fractional scale factor in Q8.8, for the _q8 variants of the bitmap and text routines (e.g. SSD1306_SCALE_Q8(1.5)) */
+#define SSD1306_SCALE_Q8(scale)     ((uint16_t)((scale) * 256))
+
+/* Save-under buffer needed by a sprite - The pages it may cover at any y-coordinate */
+#define SSD1306_SPRITE_SAVE_SZ(len_x, len_y)    ((len_x) * (((len_y) + 14) / 8))
+
+/* A sprite over the buffer - The image and mask are bitmaps, with the same layout as SSD1306_draw_bitmap() */
+typedef struct ssd_1306_sprite_struct
+{
+    const uint8_t *image;       /* Black where set - With a mask, only where the mask is set too */
+    const uint8_t *mask;        /* Opaque where set, NULL if the whole rectangle is opaque */
+    uint8_t *save;              /* Save-under buffer of SSD1306_SPRITE_SAVE_SZ() bytes */
+    uint8_t len_x, len_y;
+
+    /* Position and z-order (higher is drawn on top) - Change z only while the sprite is removed */
+    uint8_t x, y, z;
+    bool visible;
+
+    /* Area saved under the sprite and the links - Managed by the library !! */
+    uint8_t save_x, save_w, save_p0, save_p1;
+    bool drawn;
+    struct ssd_1306_sprite_struct *next, *under;
+}ssd_1306_sprite_t;
+
+/* Lines of a text box, enough for the small font on the whole screen */
+#define SSD1306_TEXT_LINES  10
+
+/* Justification of the lines of a text box */
+#define SSD1306_JUSTIFY_LEFT        0x00
+#define SSD1306_JUSTIFY_CENTER      0x01
+#define SSD1306_JUSTIFY_RIGHT       0x02
+
+/* A line of a text box - Characters of the string and their place in the box */
+typedef struct ssd_1306_text_line_struct
+{
+    uint16_t start;             /* First character in the string */
+    uint16_t len;               /* Characters drawn */
+    uint8_t x;                  /* Offset from the left of the box */
+    uint8_t width;              /* Columns drawn, the ellipsis included */
+    bool ellipsis;              /* The line ends with "..." */
+}ssd_1306_text_line_t;
+
+/* A box of text, laid out by SSD1306_text_layout() and then drawn by SSD1306_text_draw() as many times as needed */
+typedef struct ssd_1306_text_box_struct
+{
+    const char *str;
+    const ssd_1306_font_t *font;    /* Proportional font, or NULL for the fixed-width font of the option */
+    uint8_t option;                 /* Font type, when there is no proportional font (alignment is not needed) */
+    uint8_t scale;                  /* How much to scale the font, 1 or more */
+    uint8_t x, y, len_x, len_y;     /* The box */
+    uint8_t justify;
+    bool wrap;                      /* Wrap the lines at the spaces between words, otherwise only at newlines */
+    bool ellipsis;                  /* End the text with "..." where it is cut */
+
+    /* Result of the layout - Managed by the library !! */
+    ssd_1306_text_line_t lines[SSD1306_TEXT_LINES];
+    uint8_t nb_lines;
+    uint8_t width, height;          /* Extent of the text in the box */
+}ssd_1306_text_box_t;
+
+/* Characters of the longest number - A sign, 10 digits and the decimal point */
+#define SSD1306_NUMBER_SZ   12
+
+/* A numeric readout, where SSD1306_number_update() redraws only the characters that change */
+typedef struct ssd_1306_number_struct
+{
+    const uint8_t *font;        /* MediumNumbers or BigNumbers */
+    uint8_t x, y;               /* Upper left corner */
+    uint8_t cells;              /* Characters of the readout, the value is right-aligned in them - Up to SSD1306_NUMBER_SZ */
+    uint8_t decimals;           /* Digits after the decimal point, 0 for an integer */
+    bool invert;
+
+    /* Characters on the buffer - Managed by the library, clear drawn to redraw them all (e.g. after a fill) !! */
+    char shown[SSD1306_NUMBER_SZ];
+    bool drawn;
+}ssd_1306_number_t;
+
+/* Draw callback for the strip rendering - Called once per page, with the drawing clipped to it */
+typedef void (*ssd_1306_draw_t)(void *arg);
+
+#ifdef SSD1306_PARTIAL_REFRESH
+/* Statistics of the refreshes - Accumulated until reset by the user */
+typedef struct ssd_1306_stats_struct
+{
+    uint32_t windows;           /* Address windows sent */
+    uint32_t bytes_sent;        /* Bytes sent, both commands and data */
+    uint32_t bytes_skipped;     /* Buffer bytes not sent, compared to a full refresh */
+}ssd_1306_stats_t;
+#endif
 
 /* Structure used for the GPIO definitions */
 typedef struct ssd_1306_base_struct
@@ -36,6 +175,13 @@ typedef struct ssd_1306_base_struct
     SPI_HandleTypeDef *h_spi;
     uint8_t *buffer;
 
+    /* Optional second buffer for double buffering (SSD1306_BUFFER_SZ), NULL if not used.
+     * Kept by the initialization like the pins, so it must be set either way (start from a zeroed handle).
+     * A refresh is rejected (false) while the previous frame is still sent from it. After each refresh, the
+     * frame sent is copied back to the buffer: the whole of it, or with the partial refresh only the columns
+     * modified since - Writes outside the drawing routines must then be marked with SSD1306_mark_dirty() */
+    uint8_t *front_buffer;
+
     /* Port and pin pairs for the GPIOs */
     uint32_t rst_pin, ce_pin, dc_pin;
     GPIO_TypeDef *rst_port, *ce_port, *dc_port;
@@ -46,33 +192,96 @@ typedef struct ssd_1306_base_struct
     /* Extras - Cursor position */
     uint8_t x_pos, y_pos;
 
+    /* Raster operation of the drawing routines - SSD1306_ROP_COPY by default */
+    uint8_t rop;
+
+    /* Sprites sorted by z-order, and the last one drawn (the rest linked under it) - Managed by the library !! */
+    ssd_1306_sprite_t *sprites, *sprite_top;
+
+    /* Rows that can be drawn and first page held by the buffer - Managed by the library !! */
+    uint8_t clip_y0, clip_y1, strip_page;
+
 #ifdef SSD1306_DMA_ACTIVE
     /* Flag for DMA transfer status - User must not write this field during operation !! */
     volatile bool dma_transfer;
 
-    /* We need to have a constant buffer for DMA transfers (commands at least) */
-    uint8_t command_buffer[10];
+    /* Transfer queue, chained by the DMA ISR - Managed by the library !! */
+    ssd_1306_segment_t queue[SSD1306_QUEUE_SZ];
+    volatile uint8_t q_head, q_tail, q_frames;
+
+    /* Commands are copied here, so that callers return immediately */
+    uint8_t cmd_ring[SSD1306_CMD_RING_SZ];
+    volatile uint8_t cmd_head, cmd_tail;
+
+    /* Shared bus, NULL if the SPI is not shared - Set by SSD1306_bus_attach() */
+    ssd_1306_bus_t *bus;
+
+    /* Scheduling on a shared bus - Higher priority first, then the earliest deadline.
+     * The deadline of a refresh is its time plus the frame period (ms) */
+    uint8_t priority;
+    uint32_t period, deadline;
+#endif
+
+#ifdef SSD1306_PARTIAL_REFRESH
+    /* Modified columns of each page since last refresh, a bit per column - Managed by the library !! */
+    uint32_t dirty_map[SSD1306_PAGES][SSD1306_WIDTH / 32];
+
+    /* Columns of the back buffer behind the front one, with double buffering - Managed by the library !! */
+    uint32_t back_map[SSD1306_PAGES][SSD1306_WIDTH / 32];
+    ssd_1306_stats_t stats;
+
+    /* Optional copy of the display RAM (SSD1306_BUFFER_SZ), NULL if not used - Kept by the initialization too */
+    uint8_t *shadow;
+    bool shadow_valid;
+
+    /* Flag for the display's address window, set when it does not cover the whole screen */
+    bool partial_window;
 #endif
 }ssd_1306_t;
 
 /* Initializers */
 bool SSD1306_init(ssd_1306_t *init);
-ssd_1306_t *SSD1306_handle_swap(ssd_1306_t *new);
+ssd_1306_t *SSD1306_handle_swap(ssd_1306_t *h);
+bool SSD1306_init_h(ssd_1306_t *h);
+#ifdef SSD1306_DMA_ACTIVE
+bool SSD1306_bus_attach(ssd_1306_bus_t *bus, ssd_1306_t *h);
+#endif
 
 /* Utilities */
 void SSD1306_fill(bool black);
 bool SSD1306_sleep_mode(bool sleep);
 bool SSD1306_refresh(void);
+bool SSD1306_refresh_partial(void);
+void SSD1306_reset_stats(void);
+void SSD1306_mark_dirty(uint8_t x0, uint8_t x1, uint8_t y0, uint8_t y1);
+bool SSD1306_render_strips(ssd_1306_draw_t draw, void *arg);
 bool SSD1306_invert(bool invert);
 bool SSD1306_contrast(uint8_t contrast);
 bool SSD1306_vcomh(uint8_t vcomh);
 bool SSD1306_timings(uint8_t freq, uint8_t div_ratio);
 bool SSD1306_precharge(uint8_t period);
+void SSD1306_draw_mode(uint8_t rop);
+void SSD1306_fill_h(ssd_1306_t *h, bool black);
+bool SSD1306_sleep_mode_h(ssd_1306_t *h, bool sleep);
+bool SSD1306_refresh_h(ssd_1306_t *h);
+bool SSD1306_refresh_partial_h(ssd_1306_t *h);
+void SSD1306_reset_stats_h(ssd_1306_t *h);
+void SSD1306_mark_dirty_h(ssd_1306_t *h, uint8_t x0, uint8_t x1, uint8_t y0, uint8_t y1);
+bool SSD1306_render_strips_h(ssd_1306_t *h, ssd_1306_draw_t draw, void *arg);
+bool SSD1306_invert_h(ssd_1306_t *h, bool invert);
+bool SSD1306_contrast_h(ssd_1306_t *h, uint8_t contrast);
+bool SSD1306_vcomh_h(ssd_1306_t *h, uint8_t vcomh);
+bool SSD1306_timings_h(ssd_1306_t *h, uint8_t freq, uint8_t div_ratio);
+bool SSD1306_precharge_h(ssd_1306_t *h, uint8_t period);
+void SSD1306_draw_mode_h(ssd_1306_t *h, uint8_t rop);
 
 /* Scrolling */
 bool SSD1306_hscroll(uint8_t timing, bool dir);
 bool SSD1306_hvscroll(uint8_t hspeed, uint8_t vspeed, bool dir);
 bool SSD1306_scroll_disable(void);
+bool SSD1306_hscroll_h(ssd_1306_t *h, uint8_t timing, bool dir);
+bool SSD1306_hvscroll_h(ssd_1306_t *h, uint8_t hspeed, uint8_t vspeed, bool dir);
+bool SSD1306_scroll_disable_h(ssd_1306_t *h);
 
 /* Lines and pixels */
 void SSD1306_set_pixel(uint8_t x, uint8_t y, bool color);
@@ -80,6 +289,11 @@ uint8_t SSD1306_get_pixel(uint8_t x, uint8_t y);
 void SSD1306_draw_line(uint8_t x0, uint8_t x1, uint8_t y0, uint8_t y1, bool color);
 void SSD1306_draw_hline(uint8_t x, uint8_t y, uint8_t len, bool color);
 void SSD1306_draw_vline(uint8_t x, uint8_t y, uint8_t len, bool color);
+void SSD1306_set_pixel_h(ssd_1306_t *h, uint8_t x, uint8_t y, bool color);
+uint8_t SSD1306_get_pixel_h(ssd_1306_t *h, uint8_t x, uint8_t y);
+void SSD1306_draw_line_h(ssd_1306_t *h, uint8_t x0, uint8_t x1, uint8_t y0, uint8_t y1, bool color);
+void SSD1306_draw_hline_h(ssd_1306_t *h, uint8_t x, uint8_t y, uint8_t len, bool color);
+void SSD1306_draw_vline_h(ssd_1306_t *h, uint8_t x, uint8_t y, uint8_t len, bool color);
 
 /* Shape drawing */
 void SSD1306_draw_rectangle(uint8_t x0, uint8_t x1, uint8_t y0, uint8_t y1, bool color, bool fill);
@@ -88,15 +302,64 @@ void SSD1306_draw_fill_triangle(uint8_t x0, uint8_t x1, uint8_t x2, uint8_t y0,
 void SSD1306_draw_circle(uint8_t x, uint8_t y, uint8_t r, bool color);
 void SSD1306_draw_fill_circle(uint8_t x0, uint8_t y0, uint8_t r, bool color);
 void SSD1306_draw_round_rect(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, bool color, bool fill);
+void SSD1306_draw_rectangle_h(ssd_1306_t *h, uint8_t x0, uint8_t x1, uint8_t y0, uint8_t y1, bool color, bool fill);
+void SSD1306_draw_triangle_h(ssd_1306_t *h, uint8_t x0, uint8_t x1, uint8_t x2, uint8_t y0, uint8_t y1, uint8_t y2, bool color);
+void SSD1306_draw_fill_triangle_h(ssd_1306_t *h, uint8_t x0, uint8_t x1, uint8_t x2, uint8_t y0, uint8_t y1, uint8_t y2, bool color);
+void SSD1306_draw_circle_h(ssd_1306_t *h, uint8_t x, uint8_t y, uint8_t r, bool color);
+void SSD1306_draw_fill_circle_h(ssd_1306_t *h, uint8_t x0, uint8_t y0, uint8_t r, bool color);
+void SSD1306_draw_round_rect_h(ssd_1306_t *h, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, bool color, bool fill);
 
 /* Bitmaps */
 void SSD1306_draw_bitmap(const uint8_t *bitmap, uint8_t x0, uint8_t y0, uint8_t len_x, uint8_t len_y, uint8_t scale);
 void SSD1306_draw_bitmap_opt8(const uint8_t *bitmap, uint8_t x0, uint8_t y0, uint8_t len_x, uint8_t len_y);
+void SSD1306_draw_bitmap_q8(const uint8_t *bitmap, uint8_t x0, uint8_t y0, uint8_t len_x, uint8_t len_y, uint16_t scale);
+void SSD1306_draw_bitmap_rle(const uint8_t *rle, uint8_t x0, uint8_t y0, uint8_t len_x, uint8_t len_y);
+void SSD1306_draw_bitmap_h(ssd_1306_t *h, const uint8_t *bitmap, uint8_t x0, uint8_t y0, uint8_t len_x, uint8_t len_y, uint8_t scale);
+void SSD1306_draw_bitmap_opt8_h(ssd_1306_t *h, const uint8_t *bitmap, uint8_t x0, uint8_t y0, uint8_t len_x, uint8_t len_y);
+void SSD1306_draw_bitmap_q8_h(ssd_1306_t *h, const uint8_t *bitmap, uint8_t x0, uint8_t y0, uint8_t len_x, uint8_t len_y, uint16_t scale);
+void SSD1306_draw_bitmap_rle_h(ssd_1306_t *h, const uint8_t *rle, uint8_t x0, uint8_t y0, uint8_t len_x, uint8_t len_y);
+
+/* Sprites */
+bool SSD1306_sprite_add(ssd_1306_sprite_t *sprite);
+void SSD1306_sprite_remove(ssd_1306_sprite_t *sprite);
+void SSD1306_sprites_erase(void);
+void SSD1306_sprites_draw(void);
+bool SSD1306_sprite_add_h(ssd_1306_t *h, ssd_1306_sprite_t *sprite);
+void SSD1306_sprite_remove_h(ssd_1306_t *h, ssd_1306_sprite_t *sprite);
+void SSD1306_sprites_erase_h(ssd_1306_t *h);
+void SSD1306_sprites_draw_h(ssd_1306_t *h);
 
 /* Text */
 void SSD1306_coord(uint8_t x, uint8_t p);
 void SSD1306_print_str(const char *str, uint8_t option, bool invert);
 void SSD1306_print_fstr(const char *str, uint8_t option, uint8_t x, uint8_t y, uint8_t scale, bool invert);
+void SSD1306_print_fstr_q8(const char *str, uint8_t option, uint8_t x, uint8_t y, uint16_t scale, bool invert);
+void SSD1306_print_str_font(const char *str, const ssd_1306_font_t *font, bool invert);
+void SSD1306_print_fstr_font(const char *str, const ssd_1306_font_t *font, uint8_t x, uint8_t y, uint8_t scale, bool invert);
+void SSD1306_coord_h(ssd_1306_t *h, uint8_t x, uint8_t p);
+void SSD1306_print_str_h(ssd_1306_t *h, const char *str, uint8_t option, bool invert);
+void SSD1306_print_fstr_h(ssd_1306_t *h, const char *str, uint8_t option, uint8_t x, uint8_t y, uint8_t scale, bool invert);
+void SSD1306_print_fstr_q8_h(ssd_1306_t *h, const char *str, uint8_t option, uint8_t x, uint8_t y, uint16_t scale, bool invert);
+void SSD1306_print_str_font_h(ssd_1306_t *h, const char *str, const ssd_1306_font_t *font, bool invert);
+void SSD1306_print_fstr_font_h(ssd_1306_t *h, const char *str, const ssd_1306_font_t *font, uint8_t x, uint8_t y, uint8_t scale, bool invert);
+
+/* Text layout */
+void SSD1306_text_measure(const char *str, uint8_t option, const ssd_1306_font_t *font, uint8_t scale, uint16_t *len_x, uint16_t *len_y);
+bool SSD1306_text_layout(ssd_1306_text_box_t *box);
+void SSD1306_text_draw(const ssd_1306_text_box_t *box, bool invert);
+void SSD1306_text_draw_h(ssd_1306_t *h, const ssd_1306_text_box_t *box, bool invert);
+
+/* Numbers */
+void SSD1306_print_num(int32_t value, uint8_t decimals, const uint8_t *font, uint8_t x, uint8_t y, bool invert);
+uint8_t SSD1306_number_update(ssd_1306_number_t *num, int32_t value);
+void SSD1306_print_num_h(ssd_1306_t *h, int32_t value, uint8_t decimals, const uint8_t *font, uint8_t x, uint8_t y, bool invert);
+uint8_t SSD1306_number_update_h(ssd_1306_t *h, ssd_1306_number_t *num, int32_t value);
+
+/* Formatted text */
+void SSD1306_printf(uint8_t option, bool invert, const char *fmt, ...);
+void SSD1306_vprintf(uint8_t option, bool invert, const char *fmt, va_list args);
+void SSD1306_printf_h(ssd_1306_t *h, uint8_t option, bool invert, const char *fmt, ...);
+void SSD1306_vprintf_h(ssd_1306_t *h, uint8_t option, bool invert, const char *fmt, va_list args);
 
 #ifdef __cplusplus
 }
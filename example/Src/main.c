@@ -72,7 +72,7 @@ int main(void)
 /* Showcases initialization and how to set the screen up */
 static void init_example()
 {
-    ssd_1306_t SSD1306_handle;
+    ssd_1306_t SSD1306_handle = {0}; // Optional fields (shadow buffer etc.) are left unused //
     printf("\n\n************DUMMY TEST************\n");
 
     /* Extra GPIOs to be used besides MOSI and CLK for the SPI Alternate function pins
@@ -104,6 +104,12 @@ static void init_example()
      * */
     SSD1306_handle.buffer = SSD1306_buffer;
 
+    /* Optionally, a second buffer can hold a copy of what was last sent to the display. Each refresh
+     * then compares the two and sends only the bytes that changed, so redrawing the whole screen
+     * every frame costs only the actual difference on the bus.
+     * */
+    SSD1306_handle.shadow = NULL;
+
     /* These are the base screen settings. In general the contrast value varies wildly from screen to screen
      * so it might be the first thing needed to modify and experiment with. */
     SSD1306_handle.contast = SSD1306_CONTRAST_DEFAULT_NOVCC;   // In case of problem adjust up/down by steps of 5
@@ -8,6 +8,24 @@
 #define LCDHEIGHT           SSD1306_HEIGHT
 #define LCDBUFFER_SZ        SSD1306_BUFFER_SZ
 #define LCDBANK_SZ          8
+#define LCDPAGES            (LCDHEIGHT / LCDBANK_SZ)
+
+/* Wiring of the COM pins and first column in the display RAM (128 columns) of the supported panels */
+#if (LCDWIDTH == 128) && (LCDHEIGHT == 64)
+#define LCDCOMPINS          0x12    /* Alternative COM pins */
+#define LCDCOLUMN_OFFSET    0
+#elif (LCDWIDTH == 128) && (LCDHEIGHT == 32)
+#define LCDCOMPINS          0x02    /* Sequential COM pins */
+#define LCDCOLUMN_OFFSET    0
+#elif (LCDWIDTH == 96) && (LCDHEIGHT == 16)
+#define LCDCOMPINS          0x02    /* Sequential COM pins */
+#define LCDCOLUMN_OFFSET    0
+#elif (LCDWIDTH == 64) && (LCDHEIGHT == 48)
+#define LCDCOMPINS          0x12    /* Alternative COM pins */
+#define LCDCOLUMN_OFFSET    32      /* Centered in the display RAM */
+#else
+#error "Unsupported panel geometry - SSD1306_WIDTH x SSD1306_HEIGHT must be 128x64, 128x32, 96x16 or 64x48"
+#endif
 
 /***** Fundamental commands *****/
 #define SSD1306_SETCONTRAST         0x81 /* [Set Contrast Control] - 2byte command */
@@ -62,7 +80,6 @@
 #define SSD1306_PRECHARGE_DEFAULT_NOVCC     0xF1    /* [Set Pre-charge Period] default2 */
 #define SSD1306_MEMORYMODE_HORIZONTAL       0x00    /* [Set Memory Addressing Mode] option */
 #define SSD1306_DISPLAYCLOCKDIV_DEFAULT     0x80    /* Default ratio - suggested value */
-#define SSD1306_COMPINS_DEFAULT             0x12    /* Default for 128x64 */
 
 /* Macros to set and reset pins */
 #define SET_GPIO(port, pin)     (HAL_GPIO_WritePin((port), (pin), GPIO_PIN_SET))
@@ -72,7 +89,7 @@
 #ifdef SSD1306_DEBUG
     #define ASSERT_DEBUG(cond, ...) do{ if((cond)) printf(__VA_ARGS__);}while(0)
 #else
-    #define ASSERT_DEBUG(cond, ...)
+    #define ASSERT_DEBUG(cond, ...) ((void)0)
 #endif
 
 /* Swap macro for variables */
@@ -87,1730 +104,4556 @@
 /* Assisting MACROs in common transformations and manipulations */
 #define MSB2LSB_MASK(num)               (~(0xff >> (num)))
 #define LSB2MSB_MASK(num)               ((1 << (num)) - 1)
-#define COORDS2BUFF_POS(x, y)           ((((uint16_t)(y))>>3) * LCDWIDTH + (x))
+#define COORDS2BUFF_POS(h, x, y)        (((((uint16_t)(y))>>3) - (h)->strip_page) * LCDWIDTH + (x))
 #define COORDS2BIT_POS(x, y, width)     ((((uint16_t)(y))>>3) * (width) + (x))
+#define ROW_CLIPPED(h, y)               ((y) < (h)->clip_y0 || (y) > (h)->clip_y1)
+#define ROP_SEL(h)                      (_rop_sel[(h)->rop & 0x03])
+
+/* Dirty area tracking - Coordinates must be already clipped to the screen */
+#ifdef SSD1306_PARTIAL_REFRESH
+    #define MARK_DIRTY(h, x0, x1, y0, y1)   _mark_dirty((h), (x0), (x1), (y0), (y1))
+#else
+    #define MARK_DIRTY(h, x0, x1, y0, y1)   ((void)0)
+#endif
 
 /* Handle to be used for the screen */
 static ssd_1306_t *_screen_h = NULL;
 
 #ifdef SSD1306_DMA_ACTIVE
-    /*!
-        @brief    The internal ISR callback when a DMA transfer is complete.
-        This unfortunately might be need to be defined somewhere else, in case
-        multiple SPIs with DMA are used. For now it is left here as an example.
-        @param    hspi      SPI handle, given by the external ISR
-    */
-    void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi)
-    {
-        /* Chip deselect - Active low */
-        if(hspi->Instance == _screen_h->h_spi->Instance)
-        {
-            _screen_h->dma_transfer = false;
-            SET_GPIO(_screen_h->ce_port, _screen_h->ce_pin);
-        }
-    }
+/* Handles whose transfers are chained by the ISR - Registered by the initialization */
+static ssd_1306_t *_dma_handles[SSD1306_MAX_HANDLES];
+
+/* Shared buses, so that the initialization finds the one of its handle - Registered by SSD1306_bus_attach() */
+static ssd_1306_bus_t *_buses[SSD1306_MAX_HANDLES];
+#endif
+
+#ifdef SSD1306_GLYPH_CACHE
+#define SMALL_FONT_GLYPHS   95  /* Characters 0x20 - 0x7e */
+
+/* Small font glyphs unpacked to 4 columns, per alignment (UP, CENTER, BOTTOM) and inversion - Built on first use */
+static uint8_t _glyph_cache[3][2][SMALL_FONT_GLYPHS][4];
+static uint8_t _glyph_cache_built;  /* A bit per variant */
 #endif
 
 /**********************************************************/
 /************************ OPERATIONS **********************/
 /**********************************************************/
 
+#ifdef SSD1306_DMA_ACTIVE
 /*!
-    @brief    SPI transmission internal routine.
-    @param    data      The SPI packet buffer to be sent
-    @param    nb_data   The number of packets(bytes) to be sent
-    @param    type      Type of transmission, true for data else command.
-    @return             Success(True) or Failure(False) of the SPI transmission.
+    @brief    Drops every queued transfer, after a failure of the SPI.
+    @param    h     The screen handle
 */
-static bool _send_packet(uint8_t *data, uint16_t nb_data , bool type)
+static void _queue_flush(ssd_1306_t *h)
 {
-    HAL_StatusTypeDef ret;
+    h->q_tail = h->q_head;
+    h->cmd_tail = h->cmd_head;
+    h->q_frames = 0;
+    h->dma_transfer = false;
+
+    /* Give the shared bus back */
+    if(h->bus && h->bus->active == h) h->bus->active = NULL;
+
+    /* Chip disable - Active Low */
+    SET_GPIO(h->ce_port, h->ce_pin);
+}
+
+/*!
+    @brief    Starts the DMA transfer of the segment at the tail of the queue.
+    @param    h     The screen handle
+    @return         Success(True) or Failure(False) of the SPI transmission.
+*/
+static bool _queue_start(ssd_1306_t *h)
+{
+    const ssd_1306_segment_t *seg = &h->queue[h->q_tail];
 
     /* Data needs DC high - Command needs DC low */
-    type ? SET_GPIO(_screen_h->dc_port, _screen_h->dc_pin) \
-         : RESET_GPIO(_screen_h->dc_port, _screen_h->dc_pin);
+    seg->type ? SET_GPIO(h->dc_port, h->dc_pin) \
+              : RESET_GPIO(h->dc_port, h->dc_pin);
 
     /* Chip enable - Active Low */
-    RESET_GPIO(_screen_h->ce_port, _screen_h->ce_pin);
-
-    #ifdef SSD1306_DMA_ACTIVE
-        /* Set handler flag */
-        _screen_h->dma_transfer = true;
+    RESET_GPIO(h->ce_port, h->ce_pin);
 
-        /* Transmit through SPI using DMA */
-        ret = HAL_SPI_Transmit_DMA(_screen_h->h_spi, data, nb_data);
-    #else
-        /* Transmit through SPI */
-        ret = HAL_SPI_Transmit(_screen_h->h_spi, data, nb_data, SSD1306_TIMEOUT);
+    /* Set handler flag - The handle also owns the shared bus until it releases it */
+    h->dma_transfer = true;
+    if(h->bus) h->bus->active = h;
 
-        /* Chip disable - Active Low */
-        SET_GPIO(_screen_h->ce_port, _screen_h->ce_pin);
-    #endif
+    /* Transmit through SPI using DMA */
+    if(HAL_SPI_Transmit_DMA(h->h_spi, (uint8_t *)seg->data, seg->len) == HAL_OK) return true;
 
-    return ret == HAL_OK;
+    _queue_flush(h);
+    return false;
 }
 
 /*!
-    @brief    Initializes the display and the library with a new handle.
-    @return   Success(True) or Failure(False) of the procedure.
+    @brief    Picks the handle of a shared bus to be served next.
+    Handles with a higher priority go first, then the one with the earliest deadline.
+    Equal handles are served in turns, starting after the one that was just served.
+    @param    bus   The shared bus
+    @param    last  The handle that was just served
+    @return         The next handle, NULL if no handle has queued transfers.
 */
-bool SSD1306_init(ssd_1306_t *init)
+static ssd_1306_t *_bus_pick(ssd_1306_bus_t *bus, ssd_1306_t *last)
 {
-    /* Initialize the screen handle */
-    _screen_h = init;
+    ssd_1306_t *best = NULL;
+    uint8_t start = 0;
 
-    /* 1) Chip enable initialization - Active low */
-    SET_GPIO(_screen_h->ce_port, _screen_h->ce_pin);
+    for(uint8_t i = 0; i < bus->nb_handles; i++)
+    {
+        if(bus->handles[i] == last) start = i + 1;
+    }
 
-    /* 2) We reset for 10ms - Active low */
-    RESET_GPIO(_screen_h->rst_port, _screen_h->rst_pin);
-    HAL_Delay(10);
-    SET_GPIO(_screen_h->rst_port, _screen_h->rst_pin);
-    HAL_Delay(10);
+    for(uint8_t i = 0; i < bus->nb_handles; i++)
+    {
+        ssd_1306_t *h = bus->handles[(start + i) % bus->nb_handles];
 
-    /* 3) Initialize handle fields and check inputs */
-    bool vcs_flag = _screen_h->vcs == SSD1306_EXTERNALVCC;
-    _screen_h->x_pos = _screen_h->y_pos = 0;
+        /* Nothing to send */
+        if(h->q_tail == h->q_head) continue;
 
-    /* 4a) Send base commands to set the screen up */
-#ifdef SSD1306_DMA_ACTIVE
-    _screen_h->dma_transfer = false;
-    uint8_t *payload = _screen_h->command_buffer;
-#else
-    uint8_t payload[10];
-#endif
+        if(!best || h->priority > best->priority ||
+           (h->priority == best->priority && (int32_t)(h->deadline - best->deadline) < 0))
+        {
+            best = h;
+        }
+    }
 
-    payload[0] = SSD1306_DISPLAYOFF;                         /* Display off to apply settings */
-    payload[1] = SSD1306_SETDISPLAYCLOCKDIV;                 /* Set clockdiv ratio - Command code */
-    payload[2] = SSD1306_DISPLAYCLOCKDIV_DEFAULT;            /* Set clockdiv ratio - Value */
-    payload[3] = SSD1306_SETMULTIPLEX;                       /* Set multiplexing - Command code */
-    payload[4] = LCDHEIGHT - 1;                              /* Set multiplexing - This is also the default after reset */
-    payload[5] = SSD1306_SETDISPLAYOFFSET;                   /* Set display offset - Command code */
-    payload[6] = SSD1306_MEMORYMODE_HORIZONTAL;              /* Set display offset - Value (0 offset) */
-    payload[7] = SSD1306_SETSTARTLINE | 0x00;                /* Set starting line - 0 default */
-    payload[8] = SSD1306_NORMALDISPLAY;                      /* Uninverted */
-    payload[9] = SSD1306_DEACTIVATE_SCROLL;                  /* Deactivate scroll */
+    return best;
+}
 
-    /* Quick return in case of failure */
-    if(!_send_packet(payload, 10, false)) return false;
+/*!
+    @brief    Hands the shared bus to the next handle, once a transfer is complete. Called by the ISR.
+    @param    bus   The shared bus
+    @param    h     The handle that was just served
+*/
+static void _bus_next(ssd_1306_bus_t *bus, ssd_1306_t *h)
+{
+    ssd_1306_t *next = _bus_pick(bus, h);
 
-    #ifdef SSD1306_DMA_ACTIVE
-        while(_screen_h->dma_transfer); // Wait for DMA to finish //
-    #endif
+    /* Another panel takes the bus - Chip disable the current one first */
+    if(next != h)
+    {
+        h->dma_transfer = false;
+        SET_GPIO(h->ce_port, h->ce_pin);
+    }
 
-    /* 4a) Second round of commands */
-    payload[0] = SSD1306_MEMORYMODE;                        /* Set memory mode - Command code */
-    payload[1] = 0x00;                                      /* Set memory mode - Value (Vertical mode) */
-    payload[2] = SSD1306_SEGREMAP | 0x01;                   /* Set Segment Re-map - Map col addr to 127 */
-    payload[3] = SSD1306_COMSCANDEC;                        /* Set COM Output Scan Direction - From [N-1] to [0] */
-    payload[4] = SSD1306_SETCOMPINS;                        /* Set COM Pins Hardware Configuration - Command code */
-    payload[5] = SSD1306_COMPINS_DEFAULT;                   /* Set COM Pins Hardware Configuration - Value */
-    payload[6] = SSD1306_SETCONTRAST;                       /* Set contrast - Command code */
-    payload[7] = _screen_h->contast;                        /* Set contrast - Value */
-    payload[8] = SSD1306_SETPRECHARGE;                      /* Set precharge - Command code */
-    payload[9] = vcs_flag ? SSD1306_PRECHARGE_DEFAULT_VCC:  /* Set precharge - Value */
-                            SSD1306_PRECHARGE_DEFAULT_NOVCC;
+    bus->active = NULL;
+    if(next) _queue_start(next);
+}
 
-    /* Quick return in case of failure */
-    if(!_send_packet(payload, 10, false)) return false;
+/*!
+    @brief    Moves the queue forward, once the current transfer is complete. Called by the ISR.
+    @param    h     The screen handle
+*/
+static void _queue_next(ssd_1306_t *h)
+{
+    ssd_1306_segment_t *seg = &h->queue[h->q_tail];
 
-    #ifdef SSD1306_DMA_ACTIVE
-        while(_screen_h->dma_transfer); // Wait for DMA to finish //
-    #endif
+    /* Same columns on the next page */
+    if(--seg->rows)
+    {
+        seg->data += LCDWIDTH;
+        if(HAL_SPI_Transmit_DMA(h->h_spi, (uint8_t *)seg->data, seg->len) != HAL_OK) _queue_flush(h);
+        return;
+    }
 
-    /* 4a) Third and final round of commands */
-    payload[0] = SSD1306_SETVCOMDETECT;                     /* Set VCOMH Deselect Level - Command code */
-    payload[1] = SSD1306_VCOMDETECT_DEFAULT;                /* Set VCOMH Deselect Level - Value */
-    payload[2] = SSD1306_DISPLAYALLON_RESUME;               /* Set display all on for a sec */
-    payload[3] = SSD1306_SETCHARGEPUMP,                     /* Set charge pump - Command code */
-    payload[4] = vcs_flag ? SSD1306_CHARGEPUMP_OFF:         /* On */
-                            SSD1306_CHARGEPUMP_ON;
-    payload[5] = SSD1306_DISPLAYON;                         /* Finally set display on */
+    /* Release the segment (and its command bytes) */
+    if(seg->type)
+        h->q_frames--;
+    else
+        h->cmd_tail = (seg->data - h->cmd_ring) + seg->len;
+
+    h->q_tail = (h->q_tail + 1) % SSD1306_QUEUE_SZ;
+
+    /* The scheduler of a shared bus chains the transfers of all its panels */
+    if(h->bus)
+    {
+        _bus_next(h->bus, h);
+        return;
+    }
 
-    return _send_packet(payload, 6, false);
+    /* Chain the next transfer or release the bus */
+    if(h->q_tail != h->q_head)
+    {
+        _queue_start(h);
+    }
+    else
+    {
+        h->dma_transfer = false;
+        SET_GPIO(h->ce_port, h->ce_pin);
+    }
 }
 
 /*!
-    @brief    Swaps the current screen handle.
-    This is used to change the current screen that the library sends commands and updates
-    graphics into. Initialization for the new screen is the user's responsibility.
-    @param    new  The new screen handle
-    @return        The old display's handle
+    @brief    Copies command bytes into the command ring of the handle.
+    Must be called with the interrupts disabled.
+    @param    h         The screen handle
+    @param    data      The command bytes
+    @param    nb_data   The number of bytes
+    @return             Where the bytes were copied, NULL if there is no space left.
 */
-ssd_1306_t *PCD8544_handle_swap(ssd_1306_t *new)
+static const uint8_t *_ring_copy(ssd_1306_t *h, const uint8_t *data, uint16_t nb_data)
 {
-    ASSERT_DEBUG(new != NULL, "Null pointer - PCD8544_handle_swap()\n");
+    uint8_t head = h->cmd_head, tail = h->cmd_tail;
 
-    ssd_1306_t *old = _screen_h;
-    _screen_h = new;
+    /* Nothing pending, start over to avoid wrapping */
+    if(head == tail) head = tail = 0;
 
-    return old;
+    if(head >= tail)
+    {
+        /* Commands must be contiguous - Wrap around if they don't fit at the end */
+        if(head + nb_data >= SSD1306_CMD_RING_SZ)
+        {
+            if(nb_data >= tail) return NULL;
+            head = 0;
+        }
+    }
+    else if(head + nb_data >= tail)
+    {
+        return NULL;
+    }
+
+    memcpy(h->cmd_ring + head, data, nb_data);
+    h->cmd_head = head + nb_data;
+    h->cmd_tail = tail;
+
+    return h->cmd_ring + head;
 }
 
 /*!
-    @brief    Draws the contents of the buffer on the display.
-    @return   Success(True) or Failure(False) in sending the data.
+    @brief    Adds a transfer to the queue of the handle and starts it if the bus is idle.
+    Commands are copied, data must remain valid until sent.
+    @param    h         The screen handle
+    @param    data      The SPI packet buffer to be sent
+    @param    nb_data   The number of bytes (per page for data)
+    @param    rows      The number of pages, for data
+    @param    type      Type of transmission, true for data else command.
+    @return             Success(True) or Failure(False) if the queue is full.
 */
-bool SSD1306_refresh(void)
+static bool _queue_push(ssd_1306_t *h, const uint8_t *data, uint16_t nb_data, uint8_t rows, bool type)
 {
-    #ifdef SSD1306_DMA_ACTIVE
-        /* Check for active transmissions */
-        if(_screen_h->dma_transfer) return false;
-    #endif
+    bool ret = false;
+    uint8_t next = (h->q_head + 1) % SSD1306_QUEUE_SZ;
 
-    /* Draw and return */
-    return _send_packet(_screen_h->buffer, LCDBUFFER_SZ, true);
+    /* The ISR also modifies the queue */
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    if(next != h->q_tail && (type || (data = _ring_copy(h, data, nb_data))))
+    {
+        ssd_1306_segment_t *seg = &h->queue[h->q_head];
+        seg->data = data;
+        seg->len = nb_data;
+        seg->rows = rows;
+        seg->type = type;
+
+        h->q_head = next;
+        if(type) h->q_frames++;
+
+        /* Start unless the bus is busy - Its completion will chain this transfer */
+        bool busy = h->bus ? (h->bus->active != NULL) : h->dma_transfer;
+        ret = busy ? true : _queue_start(h);
+    }
+
+    __set_PRIMASK(primask);
+
+    return ret;
 }
 
 /*!
-    @brief    Fills the display buffer with the specified color.
-    @param    color  Fill with black(true) or with white(false).
+    @brief    Registers the handle, so that the ISR can find it when its transfers complete.
+    @param    h     The screen handle
+    @return         Success(True) or Failure(False) if the table is full.
 */
-void SSD1306_fill(bool black)
+static bool _register_handle(ssd_1306_t *h)
 {
-    /* Fill the buffer with it */
-    memset(_screen_h->buffer, black ? 0xff : 0, LCDBUFFER_SZ * sizeof(*_screen_h->buffer));
+    ssd_1306_t **slot = NULL;
+
+    for(uint8_t i = 0; i < SSD1306_MAX_HANDLES; i++)
+    {
+        if(_dma_handles[i] == h) return true;
+        if(!slot && !_dma_handles[i]) slot = &_dma_handles[i];
+    }
+
+    if(!slot) return false;
+
+    *slot = h;
+    return true;
 }
 
 /*!
-    @brief    Inverts or uninverts the display.
-    @param    invert  True(Invert) and False(Uninvert).
-    @return           Success(True) or Failure(False) in sending the command.
+    @brief    Finds the shared bus a screen is attached to.
+    @param    h     The screen handle
+    @return         The bus, NULL if the screen has its own SPI.
 */
-bool SSD1306_invert(bool invert)
+static ssd_1306_bus_t *_find_bus(ssd_1306_t *h)
 {
-#ifdef SSD1306_DMA_ACTIVE
-    /* Check for active transmissions */
-    if(_screen_h->dma_transfer) return false;
+    for(uint8_t i = 0; i < SSD1306_MAX_HANDLES && _buses[i]; i++)
+    {
+        for(uint8_t j = 0; j < _buses[i]->nb_handles; j++)
+        {
+            if(_buses[i]->handles[j] == h) return _buses[i];
+        }
+    }
 
-    /* Command code */
-    _screen_h->command_buffer[0] = invert ? SSD1306_INVERTDISPLAY: SSD1306_NORMALDISPLAY;
+    return NULL;
+}
 
-    return _send_packet(_screen_h->command_buffer, 1, false);
-#else
-    /* Allocate the buffer on the stack */
-    uint8_t rx_data = invert ? SSD1306_INVERTDISPLAY: SSD1306_NORMALDISPLAY;
+/*!
+    @brief    The internal ISR callback when a DMA transfer is complete.
+    The transfer is given to the registered handle that is sending on this SPI.
+    This unfortunately might be need to be defined somewhere else, in case
+    other devices use SPI with DMA. For now it is left here as an example.
+    @param    hspi      SPI handle, given by the external ISR
+*/
+void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi)
+{
+    for(uint8_t i = 0; i < SSD1306_MAX_HANDLES; i++)
+    {
+        ssd_1306_t *h = _dma_handles[i];
 
-    return _send_packet(&rx_data, 1, false);
-#endif
+        if(h && h->dma_transfer && (h->h_spi->Instance == hspi->Instance))
+        {
+            _queue_next(h);
+            return;
+        }
+    }
 }
+#endif
 
 /*!
-    @brief    Enables or disables sleep mode.
-    @param    enable  Enable(true) sleep mode or disable(false).
-    @return           Success(True) or Failure(False) in sending the command.
+    @brief    SPI transmission internal routine.
+    With DMA, the transmission is queued and the routine returns immediately.
+    @param    h         The screen handle
+    @param    data      The SPI packet buffer to be sent
+    @param    nb_data   The number of packets(bytes) to be sent
+    @param    type      Type of transmission, true for data else command.
+    @return             Success(True) or Failure(False) of the SPI transmission.
 */
-bool SSD1306_sleep_mode(bool sleep)
+static bool _send_packet(ssd_1306_t *h, uint8_t *data, uint16_t nb_data , bool type)
 {
 #ifdef SSD1306_DMA_ACTIVE
-    /* Check for active transmissions */
-    if(_screen_h->dma_transfer) return false;
+    return _queue_push(h, data, nb_data, 1, type);
+#else
+    HAL_StatusTypeDef ret;
 
-    /* Command code */
-    _screen_h->command_buffer[0] = sleep ? SSD1306_DISPLAYOFF: SSD1306_DISPLAYON;
+    /* Data needs DC high - Command needs DC low */
+    type ? SET_GPIO(h->dc_port, h->dc_pin) \
+         : RESET_GPIO(h->dc_port, h->dc_pin);
 
-    return _send_packet(_screen_h->command_buffer, 1, false);
-#else
-    /* Allocate the buffer on the stack */
-    uint8_t rx_data = sleep ? SSD1306_DISPLAYOFF: SSD1306_DISPLAYON;
+    /* Chip enable - Active Low */
+    RESET_GPIO(h->ce_port, h->ce_pin);
+
+    /* Transmit through SPI */
+    ret = HAL_SPI_Transmit(h->h_spi, data, nb_data, SSD1306_TIMEOUT);
+
+    /* Chip disable - Active Low */
+    SET_GPIO(h->ce_port, h->ce_pin);
 
-    return _send_packet(&rx_data, 1, false);
+    return ret == HAL_OK;
 #endif
 }
 
 /*!
-    @brief    Set display's contrast value.
-    @param    contrast  The contrast value.
-    @return             Success(True) or Failure(False) in sending the command.
+    @brief    Loads a 32-bit word from a byte array, regardless of alignment.
+    @param    src   The source array
+    @return         The word.
 */
-bool SSD1306_contrast(uint8_t contrast)
+static uint32_t _load_word(const uint8_t *src)
 {
-#ifdef SSD1306_DMA_ACTIVE
-    /* Check for active transmissions */
-    if(_screen_h->dma_transfer) return false;
-
-    /* Command */
-    _screen_h->command_buffer[0] = SSD1306_SETCONTRAST;
-    _screen_h->command_buffer[1] = contrast;
+    uint32_t word;
+    memcpy(&word, src, sizeof(word)); // Compiles to a single load //
+    return word;
+}
 
-    return _send_packet(_screen_h->command_buffer, 2, false);
-#else
-    /* Allocate the buffer on the stack */
-    uint8_t rx_data[2] = {SSD1306_SETCONTRAST, contrast};
+/*!
+    @brief    Stores a 32-bit word into a byte array, regardless of alignment.
+    @param    dst   The destination array
+    @param    word  The word
+*/
+static void _store_word(uint8_t *dst, uint32_t word)
+{
+    memcpy(dst, &word, sizeof(word)); // Compiles to a single store //
+}
 
-    return _send_packet(rx_data, 2, false);
+/*!
+    @brief    Sets the column and page address window of the display.
+    @param    h      The screen handle
+    @param    x0     Starting column
+    @param    x1     Ending column
+    @param    p0     Starting page
+    @param    p1     Ending page
+    @return          Success(True) or Failure(False) in sending the command.
+*/
+static bool _set_window(ssd_1306_t *h, uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1)
+{
+    uint8_t payload[6];
+
+    payload[0] = SSD1306_COLUMNADDR;
+    payload[1] = x0 + LCDCOLUMN_OFFSET;
+    payload[2] = x1 + LCDCOLUMN_OFFSET;
+    payload[3] = SSD1306_PAGEADDR;
+    payload[4] = p0;
+    payload[5] = p1;
+
+#ifdef SSD1306_PARTIAL_REFRESH
+    /* Keep track, so that full refreshes can restore it */
+    h->partial_window = (x0 != 0) || (x1 != LCDWIDTH - 1) || (p0 != 0) || (p1 != LCDPAGES - 1);
 #endif
+
+    return _send_packet(h, payload, 6, false);
 }
 
+#ifdef SSD1306_PARTIAL_REFRESH
+/* Address window to be sent by the partial refresh */
+typedef struct
+{
+    uint8_t x0, x1, p0, p1;
+}ssd_1306_window_t;
+
 /*!
-    @brief    Set vcomh value (dim or brighten the screen).
-    @param    vcomh     The vcomh value.
-    @return             Success(True) or Failure(False) in sending the command.
+    @brief    Sends the same columns of consecutive pages of the buffer.
+    @param    h         The screen handle
+    @param    data      Start of the first page's data
+    @param    nb_data   The number of bytes per page
+    @param    rows      The number of pages
+    @return             Success(True) or Failure(False) of the SPI transmission.
 */
-bool SSD1306_vcomh(uint8_t vcomh)
+static bool _send_rows(ssd_1306_t *h, uint8_t *data, uint16_t nb_data, uint8_t rows)
 {
-    /* Check that it a valid input */
-    switch(vcomh)
+#ifdef SSD1306_DMA_ACTIVE
+    return _queue_push(h, data, nb_data, rows, true);
+#else
+    for(; rows; rows--, data += LCDWIDTH)
     {
-        case SSD1306_VCOMDETECT_DEFAULT:
-        case SSD1306_VCOMDETECT_LOW:
-        case SSD1306_VCOMDETECT_HIGH: break;
-        default: return false;
+        if(!_send_packet(h, data, nb_data, true)) return false;
     }
 
-#ifdef SSD1306_DMA_ACTIVE
-    /* Check for active transmissions */
-    if(_screen_h->dma_transfer) return false;
+    return true;
+#endif
+}
+
+/*!
+    @brief    Marks the rectangle as modified in the dirty map.
+    Internal routine, no error checking performed.
+    @param    h      The screen handle
+    @param    x0     Leftmost x-coordinate
+    @param    x1     Rightmost x-coordinate
+    @param    y0     Upper y-coordinate
+    @param    y1     Lower y-coordinate
+*/
+static void _mark_dirty(ssd_1306_t *h, uint8_t x0, uint8_t x1, uint8_t y0, uint8_t y1)
+{
+    ASSERT_DEBUG(x1 >= LCDWIDTH || y1 >= LCDHEIGHT, "Error at _mark_dirty %d %d\n", x1, y1);
 
-    /* Command */
-    _screen_h->command_buffer[0] = SSD1306_SETVCOMDETECT;
-    _screen_h->command_buffer[1] = vcomh;
+    uint8_t w0 = x0 >> 5, w1 = x1 >> 5;
+    uint32_t mask0 = 0xffffffff << (x0 & 0x1f);
+    uint32_t mask1 = 0xffffffff >> (0x1f - (x1 & 0x1f));
 
-    return _send_packet(_screen_h->command_buffer, 2, false);
-#else
-    /* Allocate the buffer on the stack */
-    uint8_t rx_data[2] = {SSD1306_SETVCOMDETECT, vcomh};
+    for(uint8_t p = y0 >> 3; p <= (y1 >> 3); p++)
+    {
+        uint32_t *row = h->dirty_map[p];
 
-    return _send_packet(rx_data, 2, false);
-#endif
+        if(w0 == w1)
+        {
+            row[w0] |= mask0 & mask1;
+            continue;
+        }
+
+        row[w0] |= mask0;
+        for(uint8_t w = w0 + 1; w < w1; w++) row[w] = 0xffffffff;
+        row[w1] |= mask1;
+    }
 }
 
 /*!
-    @brief    Activate horizontal scrolling.
-    @param    speed     The speed of the scrolling, can be from 0 to 7, with
-    higher values meaning more speed.
-    @param    dir       The direction, right (true) or left (false)
-    @return             Success(True) or Failure(False) in sending the command.
+    @brief    Resets the dirty map to empty (nothing to send).
+    @param    h     The screen handle
 */
-bool SSD1306_hscroll(uint8_t speed, bool dir)
+static void _clear_dirty(ssd_1306_t *h)
 {
-    /* Speeds in frames: 2, 3, 4, 5, 25, 64, 128, 256 */
-    const uint8_t timing_table[8] = {0x07, 0x04, 0x05, 0x00, 0x06, 0x01, 0x02, 0x03};
+    /* With double buffering, the back buffer has to catch up with these columns after the swap */
+    if(h->front_buffer)
+    {
+        uint32_t *back = h->back_map[0];
+        const uint32_t *dirty = h->dirty_map[0];
 
-#ifdef SSD1306_DMA_ACTIVE
-    /* Check for active transmissions */
-    if(_screen_h->dma_transfer) return false;
+        for(uint8_t i = 0; i < sizeof(h->dirty_map) / sizeof(uint32_t); i++) back[i] |= dirty[i];
+    }
 
-    /* Max speed supported */
-    if(speed > 7) speed = 7;
+    memset(h->dirty_map, 0, sizeof(h->dirty_map));
+}
 
-    /* Commands */
-    _screen_h->command_buffer[0] = dir ? SSD1306_RIGHT_HORIZONTAL_SCROLL:
-                                         SSD1306_LEFT_HORIZONTAL_SCROLL;
-    _screen_h->command_buffer[1] = 0x00;                    /* Dummy */
-    _screen_h->command_buffer[2] = 0x00;                    /* Start page address */
-    _screen_h->command_buffer[3] = timing_table[speed];     /* Scroll speed */
-    _screen_h->command_buffer[4] = 0xFF;                    /* End page address */
-    _screen_h->command_buffer[5] = 0x00;                    /* Dummy */
-    _screen_h->command_buffer[6] = 0xFF;                    /* Dummy */
-    _screen_h->command_buffer[7] = SSD1306_ACTIVATE_SCROLL;
-
-    return _send_packet(_screen_h->command_buffer, 8, false);
-#else
-    /* Allocate the buffer on the stack */
-    uint8_t rx_data[8];
+/*!
+    @brief    Finds the next run of modified columns in a page of the dirty map.
+    @param    row       The page's dirty map
+    @param    x         Column to start searching from
+    @param    start     First column of the run
+    @param    end       Last column of the run
+    @return             True if a run was found, false otherwise.
+*/
+static bool _next_dirty_run(const uint32_t *row, uint16_t x, uint8_t *start, uint8_t *end)
+{
+    /* Skip clean columns, a whole word at a time when possible */
+    while(x < LCDWIDTH)
+    {
+        uint32_t word = row[x >> 5] >> (x & 0x1f);
+        if(word) { x += __builtin_ctz(word); break; }
+        x = (x | 0x1f) + 1;
+    }
 
-    /* Max speed supported */
-    if(speed > 7) speed = 7;
+    if(x >= LCDWIDTH) return false;
+    *start = x;
 
-    /* Commands */
-    rx_data[0] = dir ? SSD1306_RIGHT_HORIZONTAL_SCROLL:
-                       SSD1306_LEFT_HORIZONTAL_SCROLL;
-    rx_data[1] = 0x00;                      /* Dummy */
-    rx_data[2] = 0x00;                      /* Start page address */
-    rx_data[3] = timing_table[speed];       /* Scroll speed */
-    rx_data[4] = 0xFF;                      /* End page address */
-    rx_data[5] = 0x00;                      /* Dummy */
-    rx_data[6] = 0xFF;                      /* Dummy */
-    rx_data[7] = SSD1306_ACTIVATE_SCROLL;
+    /* Same for the dirty ones */
+    while(x < LCDWIDTH)
+    {
+        uint32_t word = ~row[x >> 5] >> (x & 0x1f);
+        if(word) { x += __builtin_ctz(word); break; }
+        x = (x | 0x1f) + 1;
+    }
 
-    return _send_packet(rx_data, 8, false);
-#endif
+    if(x > LCDWIDTH) x = LCDWIDTH;
+    *end = x - 1;
+
+    return true;
 }
 
 /*!
-    @brief    Activate horizontal and vertical scrolling.
-    @param    hspeed     The speed of horizontal scrolling, can be from 0 to 7, with
-    higher values meaning more speed.
-    @param    vspeed    The vertical speed (or scrolling offset), can be from 0 to 0x3f
-    @param    dir       The direction, right (true) or left (false)
-    @return             Success(True) or Failure(False) in sending the command.
+    @brief    Turns the dirty map into a set of address windows.
+    Runs of the same page are merged when the clean gap between them is cheaper to send than
+    a new window. Runs are also merged with windows of the page above when resending the extra
+    clean bytes costs less than starting a new window.
+    @param    h     The screen handle
+    @param    win   The windows array, of SSD1306_MAX_WINDOWS size
+    @return         The number of windows.
 */
-bool SSD1306_hvscroll(uint8_t hspeed, uint8_t vspeed, bool dir)
+static uint8_t _plan_windows(ssd_1306_t *h, ssd_1306_window_t *win)
 {
-    /* Speeds in frames: 2, 3, 4, 5, 25, 64, 128, 256 */
-    const uint8_t timing_table[8] = {0x07, 0x04, 0x05, 0x00, 0x06, 0x01, 0x02, 0x03};
+    uint8_t nb_win = 0;
 
-#ifdef SSD1306_DMA_ACTIVE
-    /* Check for active transmissions */
-    if(_screen_h->dma_transfer) return false;
+    for(uint8_t p = 0; p < LCDPAGES; p++)
+    {
+        const uint32_t *row = h->dirty_map[p];
+        uint8_t r0, r1, n0, n1;
+        uint16_t x = 0;
 
-    /* Max speed supported */
-    if(hspeed > 7) hspeed = 7;
+        while(_next_dirty_run(row, x, &r0, &r1))
+        {
+            x = r1 + 1;
 
-    /* Commands */
-    _screen_h->command_buffer[0] = dir ? SSD1306_VERTICAL_AND_RIGHT_HORIZONTAL_SCROLL:
-                                         SSD1306_VERTICAL_AND_LEFT_HORIZONTAL_SCROLL;
-    _screen_h->command_buffer[1] = 0x00;                    /* Dummy */
-    _screen_h->command_buffer[2] = 0x00;                    /* Start page address */
-    _screen_h->command_buffer[3] = timing_table[hspeed];    /* Scroll speed */
-    _screen_h->command_buffer[4] = 0xFF;                    /* End page address */
-    _screen_h->command_buffer[5] = vspeed;                  /* Vertical scrolling offset */
-    _screen_h->command_buffer[6] = SSD1306_ACTIVATE_SCROLL;
-
-    return _send_packet(_screen_h->command_buffer, 7, false);
-#else
-    /* Allocate the buffer on the stack */
-    uint8_t rx_data[8];
+            /* Merge the following runs while the gap is cheap */
+            while(_next_dirty_run(row, x, &n0, &n1) && (n0 - r1 - 1) <= SSD1306_WINDOW_COST)
+            {
+                r1 = n1;
+                x = n1 + 1;
+            }
 
-    /* Max speed supported */
-    if(hspeed > 7) hspeed = 7;
+            /* Try to extend a window that ends at the previous page */
+            bool merged = false;
+            for(uint8_t i = 0; i < nb_win && !merged; i++)
+            {
+                ssd_1306_window_t *w = &win[i];
+                if(w->p1 + 1 != p) continue;
 
-    /* Commands */
-    rx_data[0] = dir ? SSD1306_VERTICAL_AND_RIGHT_HORIZONTAL_SCROLL:
-                       SSD1306_VERTICAL_AND_LEFT_HORIZONTAL_SCROLL;
-    rx_data[1] = 0x00;                      /* Dummy */
-    rx_data[2] = 0x00;                      /* Start page address */
-    rx_data[3] = timing_table[hspeed];       /* Scroll speed */
-    rx_data[4] = 0xFF;                      /* End page address */
-    rx_data[5] = vspeed;                    /* Vertical scrolling offset */
-    rx_data[6] = SSD1306_ACTIVATE_SCROLL;
+                uint8_t u0 = (r0 < w->x0) ? r0 : w->x0;
+                uint8_t u1 = (r1 > w->x1) ? r1 : w->x1;
+                uint16_t cost_merged = (uint16_t)(p - w->p0 + 1) * (u1 - u0 + 1);
+                uint16_t cost_split = (uint16_t)(w->p1 - w->p0 + 1) * (w->x1 - w->x0 + 1) +
+                                      (r1 - r0 + 1) + SSD1306_WINDOW_COST;
 
-    return _send_packet(rx_data, 7, false);
-#endif
+                if(cost_merged <= cost_split)
+                {
+                    w->x0 = u0;
+                    w->x1 = u1;
+                    w->p1 = p;
+                    merged = true;
+                }
+            }
+
+            if(merged) continue;
+
+            if(nb_win < SSD1306_MAX_WINDOWS)
+            {
+                win[nb_win].x0 = r0;
+                win[nb_win].x1 = r1;
+                win[nb_win].p0 = win[nb_win].p1 = p;
+                nb_win++;
+            }
+            else /* Out of windows - Grow the last one to cover the run */
+            {
+                ssd_1306_window_t *w = &win[nb_win - 1];
+                if(r0 < w->x0) w->x0 = r0;
+                if(r1 > w->x1) w->x1 = r1;
+                w->p1 = p;
+            }
+        }
+    }
+
+    return nb_win;
 }
 
 /*!
-    @brief    Deactivate any scrolling currently on the screen.
-    @return   Success(True) or Failure(False) in sending the command.
+    @brief    Sends the windows planned from the dirty map and clears it.
+    @param    h     The screen handle
+    @return   Success(True) or Failure(False) in sending the data.
 */
-bool SSD1306_scroll_disable(void)
+static bool _send_windows(ssd_1306_t *h)
 {
-#ifdef SSD1306_DMA_ACTIVE
-    /* Check for active transmissions */
-    if(_screen_h->dma_transfer) return false;
+    ssd_1306_window_t win[SSD1306_MAX_WINDOWS];
+    uint8_t nb_win = _plan_windows(h, win);
+    uint16_t data_sent = 0;
 
-    /* Command */
-    _screen_h->command_buffer[0] = SSD1306_DEACTIVATE_SCROLL;
+    for(uint8_t i = 0; i < nb_win; i++)
+    {
+        if(!_set_window(h, win[i].x0, win[i].x1, win[i].p0, win[i].p1)) return false;
 
-    return _send_packet(_screen_h->command_buffer, 1, false);
-#else
-    /* Allocate the buffer on the stack */
-    uint8_t rx_data = SSD1306_DEACTIVATE_SCROLL;
+        uint16_t pos = COORDS2BUFF_POS(h, win[i].x0, win[i].p0 << 3);
+        uint16_t len = win[i].x1 - win[i].x0 + 1;
+        uint8_t rows = win[i].p1 - win[i].p0 + 1;
 
-    return _send_packet(&rx_data, 1, false);
-#endif
+        /* Full width windows are contiguous in the buffer as well */
+        if(len == LCDWIDTH)
+        {
+            len *= rows;
+            rows = 1;
+        }
+
+        /* One transmission per page, since the window is not contiguous in the buffer */
+        if(!_send_rows(h, h->buffer + pos, len, rows)) return false;
+        data_sent += len * rows;
+    }
+
+    _clear_dirty(h);
+
+    /* Update the statistics */
+    h->stats.windows += nb_win;
+    h->stats.bytes_sent += data_sent + 6 * nb_win;
+    h->stats.bytes_skipped += LCDBUFFER_SZ - data_sent;
+
+    return true;
 }
 
 /*!
-    @brief    Set display's oscillator frequency and display clock divide ratio.
-    @param    freq       The oscillator frequency value (values of 0 to 15).
-    @param    div_ratio  The clock division ration (values of 0 to 15).
-    @return              Success(True) or Failure(False) in sending the command.
+    @brief    Compares the buffer against the shadow of the display RAM, a word at a time.
+    The dirty map is replaced with the changed bytes and the shadow is brought up to date.
+    @param    h     The screen handle
 */
-bool SSD1306_timings(uint8_t freq, uint8_t div_ratio)
+static void _diff_shadow(ssd_1306_t *h)
 {
-#ifdef SSD1306_DMA_ACTIVE
-    /* Check for active transmissions */
-    if(_screen_h->dma_transfer) return false;
+    const uint8_t *cur = h->buffer;
+    uint8_t *old = h->shadow;
 
-    /* Clip in case the values are larger */
-    if(freq > 15) freq = 15;
-    if(div_ratio > 15) div_ratio = 15;
+    _clear_dirty(h);
 
-    /* Command */
-    _screen_h->command_buffer[0] = SSD1306_SETDISPLAYCLOCKDIV;
-    _screen_h->command_buffer[1] = (freq << 4) | div_ratio;
+    for(uint16_t pos = 0; pos < LCDBUFFER_SZ; pos += sizeof(uint32_t))
+    {
+        uint32_t diff = _load_word(cur + pos) ^ _load_word(old + pos);
+        if(!diff) continue;
 
-    return _send_packet(_screen_h->command_buffer, 2, false);
-#else
-    /* Clip in case the values are larger */
-    if(freq > 15) freq = 15;
-    if(div_ratio > 15) div_ratio = 15;
+        memcpy(old + pos, cur + pos, sizeof(uint32_t));
 
-    /* Allocate the buffer on the stack */
-    uint8_t rx_data[2] = {SSD1306_SETDISPLAYCLOCKDIV, (freq << 4) | div_ratio};
+        /* Little endian - First changed byte is the lowest one */
+        uint8_t x = pos % LCDWIDTH;
+        uint8_t y = (pos / LCDWIDTH) << 3;
+        uint8_t first = __builtin_ctz(diff) >> 3;
+        uint8_t last = (31 - __builtin_clz(diff)) >> 3;
 
-    return _send_packet(rx_data, 2, false);
-#endif
+        _mark_dirty(h, x + first, x + last, y, y);
+    }
 }
+#endif
 
 /*!
-    @brief    Set display's precharge period value.
-    @param    period     The period value (values of 1 to 15).
-    @return              Success(True) or Failure(False) in sending the command.
+    @brief    Initializes the display of a handle. The current screen handle is not changed.
+    @param    h     The screen handle
+    @return         Success(True) or Failure(False) of the procedure.
 */
-bool SSD1306_precharge(uint8_t period)
+bool SSD1306_init_h(ssd_1306_t *h)
 {
-#ifdef SSD1306_DMA_ACTIVE
-    /* Check for active transmissions */
-    if(_screen_h->dma_transfer) return false;
+    /* 1) Chip enable initialization - Active low */
+    SET_GPIO(h->ce_port, h->ce_pin);
 
-    /* In case input is 0 - Invalid */
-    period += !period;
+    /* 2) We reset for 10ms - Active low */
+    RESET_GPIO(h->rst_port, h->rst_pin);
+    HAL_Delay(10);
+    SET_GPIO(h->rst_port, h->rst_pin);
+    HAL_Delay(10);
 
-    /* Also check that is not above 15DCLK */
-    if(period > 15) period = 15;
+    /* 3) Initialize handle fields and check inputs */
+    bool vcs_flag = h->vcs == SSD1306_EXTERNALVCC;
+    h->x_pos = h->y_pos = 0;
+    h->rop = SSD1306_ROP_COPY;
+    h->sprites = h->sprite_top = NULL;
+    h->clip_y0 = h->strip_page = 0;
+    h->clip_y1 = LCDHEIGHT - 1;
+
+#ifdef SSD1306_PARTIAL_REFRESH
+    /* Display RAM contents are unknown, so everything is dirty */
+    h->partial_window = false;
+    h->shadow_valid = false;
+    memset(h->dirty_map, 0xff, sizeof(h->dirty_map));
+    memset(h->back_map, 0xff, sizeof(h->back_map));
+    memset(&h->stats, 0, sizeof(h->stats));
+#endif
 
-    /* Command */
-    _screen_h->command_buffer[0] = SSD1306_SETPRECHARGE;
-    _screen_h->command_buffer[1] = period;
+    /* 4a) Send base commands to set the screen up */
+#ifdef SSD1306_DMA_ACTIVE
+    h->dma_transfer = false;
+    h->q_head = h->q_tail = h->q_frames = 0;
+    h->cmd_head = h->cmd_tail = 0;
+    h->bus = _find_bus(h);
+    h->deadline = 0;
+
+    /* The ISR has to find the handle to chain its transfers */
+    if(!_register_handle(h)) return false;
+#endif
+    uint8_t payload[10];
 
-    return _send_packet(_screen_h->command_buffer, 2, false);
-#else
-    /* In case input is 0 - Invalid */
-    period += !period;
+    payload[0] = SSD1306_DISPLAYOFF;                         /* Display off to apply settings */
+    payload[1] = SSD1306_SETDISPLAYCLOCKDIV;                 /* Set clockdiv ratio - Command code */
+    payload[2] = SSD1306_DISPLAYCLOCKDIV_DEFAULT;            /* Set clockdiv ratio - Value */
+    payload[3] = SSD1306_SETMULTIPLEX;                       /* Set multiplexing - Command code */
+    payload[4] = LCDHEIGHT - 1;                              /* Set multiplexing - This is also the default after reset */
+    payload[5] = SSD1306_SETDISPLAYOFFSET;                   /* Set display offset - Command code */
+    payload[6] = SSD1306_MEMORYMODE_HORIZONTAL;              /* Set display offset - Value (0 offset) */
+    payload[7] = SSD1306_SETSTARTLINE | 0x00;                /* Set starting line - 0 default */
+    payload[8] = SSD1306_NORMALDISPLAY;                      /* Uninverted */
+    payload[9] = SSD1306_DEACTIVATE_SCROLL;                  /* Deactivate scroll */
 
-    /* Also check that is not above 15DCLK */
-    if(period > 15) period = 15;
+    /* Quick return in case of failure */
+    if(!_send_packet(h, payload, 10, false)) return false;
 
-    /* Allocate the buffer on the stack */
-    uint8_t rx_data[2] = {SSD1306_SETPRECHARGE, period};
+    /* 4a) Second round of commands */
+    payload[0] = SSD1306_MEMORYMODE;                        /* Set memory mode - Command code */
+    payload[1] = 0x00;                                      /* Set memory mode - Value (Vertical mode) */
+    payload[2] = SSD1306_SEGREMAP | 0x01;                   /* Set Segment Re-map - Map col addr to 127 */
+    payload[3] = SSD1306_COMSCANDEC;                        /* Set COM Output Scan Direction - From [N-1] to [0] */
+    payload[4] = SSD1306_SETCOMPINS;                        /* Set COM Pins Hardware Configuration - Command code */
+    payload[5] = LCDCOMPINS;                                /* Set COM Pins Hardware Configuration - Value */
+    payload[6] = SSD1306_SETCONTRAST;                       /* Set contrast - Command code */
+    payload[7] = h->contast;                                /* Set contrast - Value */
+    payload[8] = SSD1306_SETPRECHARGE;                      /* Set precharge - Command code */
+    payload[9] = vcs_flag ? SSD1306_PRECHARGE_DEFAULT_VCC:  /* Set precharge - Value */
+                            SSD1306_PRECHARGE_DEFAULT_NOVCC;
+
+    /* Quick return in case of failure */
+    if(!_send_packet(h, payload, 10, false)) return false;
 
-    return _send_packet(rx_data, 2, false);
+    /* 4a) Third and final round of commands */
+    payload[0] = SSD1306_SETVCOMDETECT;                     /* Set VCOMH Deselect Level - Command code */
+    payload[1] = SSD1306_VCOMDETECT_DEFAULT;                /* Set VCOMH Deselect Level - Value */
+    payload[2] = SSD1306_DISPLAYALLON_RESUME;               /* Set display all on for a sec */
+    payload[3] = SSD1306_SETCHARGEPUMP,                     /* Set charge pump - Command code */
+    payload[4] = vcs_flag ? SSD1306_CHARGEPUMP_OFF:         /* On */
+                            SSD1306_CHARGEPUMP_ON;
+    payload[5] = SSD1306_DISPLAYON;                         /* Finally set display on */
+
+#if (LCDWIDTH == 128) && (LCDHEIGHT == 64)
+    return _send_packet(h, payload, 6, false);
+#else
+    /* The address window covers the whole display RAM after reset, not only the panel */
+    return _send_packet(h, payload, 6, false) && _set_window(h, 0, LCDWIDTH - 1, 0, LCDPAGES - 1);
 #endif
 }
 
-/**********************************************************/
-/************************ GRAPHICS ************************/
-/**********************************************************/
-
 /*!
-    @brief    Set a pixel's value. Internal routine, no error checking performed.
-    @param    x         x-coordinate
-    @param    y         y-coordinate
-    @param    color     Black(True) or White(False).
+    @brief    Initializes the display and the library with a new handle.
+    The handle becomes the current one, used by the routines without the _h suffix.
+    @param    init  The screen handle
+    @return         Success(True) or Failure(False) of the procedure.
 */
-static void _set_single_pixel(uint8_t x, uint8_t y, bool color)
+bool SSD1306_init(ssd_1306_t *init)
 {
-    uint16_t pos = COORDS2BUFF_POS(x, y);
-    ASSERT_DEBUG(pos >= LCDBUFFER_SZ, "Error at _set_single_pixel %d\n", pos);
+    /* Initialize the screen handle */
+    _screen_h = init;
 
-    if(color)
-        _screen_h->buffer[pos] |= 1 << (y & 0x07);
-    else
-        _screen_h->buffer[pos] &= ~(1 << (y & 0x07));
+    return SSD1306_init_h(init);
 }
 
 /*!
-    @brief    Set a pixel's value. Internal routine used for loops, no error checking performed.
-    @param    pos       Position in the buffer
-    @param    mask      The mask to apply
-    @param    color     Black(True) or White(False).
+    @brief    Swaps the current screen handle.
+    This is used to change the current screen that the library sends commands and updates
+    graphics into. Initialization for the new screen is the user's responsibility.
+    The routines with the _h suffix take the handle directly and do not need this.
+    @param    new  The new screen handle
+    @return        The old display's handle
 */
-static void _set_single_pixel_opt(uint16_t pos, uint8_t mask, bool color)
+ssd_1306_t *SSD1306_handle_swap(ssd_1306_t *h)
 {
-    ASSERT_DEBUG(pos >= LCDBUFFER_SZ, "Error at _set_single_pixel_opt %d\n", pos);
+    ASSERT_DEBUG(h == NULL, "Null pointer - SSD1306_handle_swap()\n");
 
-    if(color)
-        _screen_h->buffer[pos] |= mask;
-    else
-        _screen_h->buffer[pos] &= ~mask;
+    ssd_1306_t *old = _screen_h;
+    _screen_h = h;
+
+    return old;
 }
 
+#ifdef SSD1306_DMA_ACTIVE
 /*!
-    @brief    Get a pixel's value. Internal routine, no error checking performed.
-    @param    x     x-coordinate
-    @param    y     y-coordinate
-    @return         Black(True) or White(False).
+    @brief    Attaches a screen to an SPI bus shared with other screens.
+    Transfers of all the attached screens are then scheduled by priority and deadline, and
+    chained back-to-back by the DMA ISR. Must be called before the screen's initialization.
+    @param    bus   The shared bus, its SPI handle set by the user
+    @param    h     The screen handle
+    @return         Success(True) or Failure(False) if the bus has no room for the screen,
+                    or if SSD1306_MAX_HANDLES buses are already in use.
 */
-static uint8_t _get_single_pixel(uint8_t x, uint8_t y)
+bool SSD1306_bus_attach(ssd_1306_bus_t *bus, ssd_1306_t *h)
 {
-    /* First find the exact position */
-    uint16_t pos = COORDS2BUFF_POS(x, y);
-    ASSERT_DEBUG(pos >= LCDBUFFER_SZ, "Error at _get_single_pixel %d\n", pos);
+    for(uint8_t i = 0; i < bus->nb_handles; i++)
+    {
+        if(bus->handles[i] == h) return true;
+    }
 
-    return (_screen_h->buffer[pos] >> (y & 0x07)) & 0x01;
-}
+    if(bus->nb_handles >= SSD1306_MAX_HANDLES) return false;
 
-/*!
-    @brief    Set multiple pixel values. Internal routine, no error checking performed.
-    The routine sets pixels of a single bank(check documentation for the display's pixel layout).
-    The color goes from the LSB to MSB in the buffer, or from the bottom to the top in the actual
-    display.
-    @param    pos     The bank position in the buffer
-    @param    num     Number of pixels to color, must be less than 8(bank size).
-    @param    color   Either set pixels to black(true) or white(false).
-*/
-static void _set_pixels_lsb2msb(uint16_t pos, uint8_t num, bool color)
-{
-    ASSERT_DEBUG(pos >= LCDBUFFER_SZ, "Error at _set_pixels_lsb2msb\n");
-    ASSERT_DEBUG(num >= 8, "Error at _set_pixels_lsb2msb\n");
-    uint8_t mask = LSB2MSB_MASK(num);
+    /* Register the bus with its first screen */
+    if(!bus->nb_handles)
+    {
+        uint8_t i = 0;
 
-    if(color)
-        _screen_h->buffer[pos] |= mask;
-    else
-        _screen_h->buffer[pos] &= ~mask;
-}
+        while(i < SSD1306_MAX_HANDLES && _buses[i] && _buses[i] != bus) i++;
+        if(i == SSD1306_MAX_HANDLES) return false;
 
-/*!
-    @brief    Set multiple pixel values. Internal routine, no error checking performed.
-    The routine sets pixels of a single bank(check documentation for the display's pixel layout).
-    The color goes from the MSB to LSB in the buffer, or from the top to the bottom in the actual
-    display.
-    @param    pos     The bank position in the buffer
-    @param    num     Number of pixels to color, must be less than 8(bank size).
-    @param    color   Either set pixels to black(true) or white(false).
-*/
-static void _set_pixels_msb2lsb(uint16_t pos, uint8_t num, bool color)
-{
-    ASSERT_DEBUG(pos >= LCDBUFFER_SZ, "Error at _set_pixels_invert_msb2lsb\n");
-    ASSERT_DEBUG(num >= 8, "Error at _set_pixels_invert_msb2lsb\n");
-    uint8_t mask = MSB2LSB_MASK(num);
+        _buses[i] = bus;
+    }
 
-    if(color)
-        _screen_h->buffer[pos] |= mask;
-    else
-        _screen_h->buffer[pos] &= ~mask;
+    bus->handles[bus->nb_handles++] = h;
+    h->h_spi = bus->h_spi;
+    h->bus = bus;
+
+    return true;
 }
+#endif
 
 /*!
-    @brief    Draws a generic line. Internal routine, it uses Bresenhm's algorithm and is based on the implementation
-    by the Adafruit GFX library.
-    @param    x0     Starting x-coordinate
-    @param    x1     Ending x-coordinate
-    @param    y0     Starting y-coordinate
-    @param    y1     Ending y-coordinate
-    @param    color  Black(true)/white(false)
+    @brief    Sends the whole buffer, or only its difference from the shadow if there is one.
+    @param    h     The screen handle
+    @return   Success(True) or Failure(False) in sending the data.
 */
-static void _draw_generic_line(uint8_t x0, uint8_t x1, uint8_t y0, uint8_t y1, bool color)
+static bool _refresh(ssd_1306_t *h)
 {
-    int16_t steep = abs(y1 - y0) > abs(x1 - x0);
-
-    if(steep)
+#ifdef SSD1306_PARTIAL_REFRESH
+    /* Send only the difference when the display's contents are known */
+    if(h->shadow && h->shadow_valid)
     {
-        SWAP_VAR(x0, y0);
-        SWAP_VAR(x1, y1);
+        _diff_shadow(h);
+
+        if(_send_windows(h)) return true;
+
+        h->shadow_valid = false;
+        return false;
     }
 
-    if(x0 > x1)
+    /* Restore the address window in case a partial refresh changed it */
+    if(h->partial_window)
     {
-        SWAP_VAR(x0, x1);
-        SWAP_VAR(y0, y1);
+        if(!_set_window(h, 0, LCDWIDTH - 1, 0, LCDPAGES - 1)) return false;
+        h->stats.bytes_sent += 6;
     }
 
-    int16_t dx = x1 - x0;
-    int16_t dy = abs(y1 - y0);
-    int16_t err = dx >> 1;
-    int16_t ystep = (y0 < y1) ? 1 : -1;
+    /* Whatever was written to the buffer is sent, so the whole of it is copied on the swap */
+    _clear_dirty(h);
+    memset(h->back_map, 0xff, sizeof(h->back_map));
+    h->stats.windows++;
+    h->stats.bytes_sent += LCDBUFFER_SZ;
 
-    for (; x0 <= x1; x0++)
+    /* Display contents are now the same as the buffer */
+    if(h->shadow)
     {
-        if(steep)
-        {
-            SSD1306_set_pixel(y0, x0, color);
-        }
-        else
-        {
-            SSD1306_set_pixel(x0, y0, color);
-        }
+        memcpy(h->shadow, h->buffer, LCDBUFFER_SZ * sizeof(uint8_t));
+        h->shadow_valid = _send_packet(h, h->buffer, LCDBUFFER_SZ, true);
+        return h->shadow_valid;
+    }
+#endif
 
-        err -= dy;
-        if(err < 0)
-        {
-            y0 += ystep;
-            err += dx;
-        }
-    }
-}
-
-/*!
-    @brief    Set a pixel's value.
-    @param    x       x-coordinate
-    @param    y       y-coordinate
-    @param    color   Black(true) or white(false)
-*/
-void SSD1306_set_pixel(uint8_t x, uint8_t y, bool color)
-{
-    /* Sanity check */
-    if((x >= LCDWIDTH) || (y >= LCDHEIGHT)) return;
-
-    /* Call the internal routine */
-    _set_single_pixel(x, y, color);
+    /* Draw and return */
+    return _send_packet(h, h->buffer, LCDBUFFER_SZ, true);
 }
 
 /*!
-    @brief    Returns a pixel's value.
-    @param    x   x-coordinate
-    @param    y   y-coordinate
-    @return       In case of error, 0xFF is returned, otherwise true or false.
+    @brief    Swaps the front and back buffers after a refresh, when double buffering is used.
+    The buffer that was just sent becomes the front one and it is only read by the DMA from now on.
+    The new back buffer is brought up to the frame just sent, so that drawing continues from it.
+    With the partial refresh, only the columns modified since the previous swap are copied
+    (the whole buffer after a full refresh without a shadow).
+    @param    h     The screen handle
 */
-uint8_t SSD1306_get_pixel(uint8_t x, uint8_t y)
+static void _swap_buffers(ssd_1306_t *h)
 {
-    /* Return max value in case of failure */
-    return ((x >= LCDWIDTH) || (y >= LCDHEIGHT)) ? 0xff : _get_single_pixel(x, y);
-}
+    uint8_t *front = h->buffer;
 
-/*!
-    @brief    Draw a horizontal line.
-    @param    x      Left-most x-coordinate
-    @param    y      Left-most y-coordinate
-    @param    len    The length of the line including the starting pixel
-    @param    color  Black(true)/white(false)
-*/
-void SSD1306_draw_hline(uint8_t x, uint8_t y, uint8_t len, bool color)
-{
-    /* Sanity check - x value is taken care of by the loop conditions */
-    if(y >= LCDHEIGHT || x >= LCDWIDTH) return;
+    if(!h->front_buffer) return;
 
-    uint16_t pos = COORDS2BUFF_POS(x, y);
-    if(((uint16_t)x + len) > LCDWIDTH) len = LCDWIDTH - x;
-    uint8_t mask = 1 << (y & 0x07);
+    h->buffer = h->front_buffer;
+    h->front_buffer = front;
 
-    if(color)
-    {
-        for(uint8_t i = 0; i < len; i++)
-        {
-            ASSERT_DEBUG((pos + i) >= LCDBUFFER_SZ, "Error at SSD1306_draw_hline\n");
-            _screen_h->buffer[pos + i] |= mask;
-        }
-    }
-    else
+#ifdef SSD1306_PARTIAL_REFRESH
+    for(uint8_t p = 0; p < LCDPAGES; p++)
     {
-        for(uint8_t i = 0; i < len; i++)
+        for(uint8_t w = 0; w < LCDWIDTH / 32; w++)
         {
-            ASSERT_DEBUG((pos + i) >= LCDBUFFER_SZ, "Error at SSD1306_draw_hline\n");
-            _screen_h->buffer[pos + i] &= ~mask;
+            uint32_t word = h->back_map[p][w];
+            uint16_t pos = p * LCDWIDTH + (w << 5);
+
+            /* Copy each run of modified columns */
+            while(word)
+            {
+                uint8_t x = __builtin_ctz(word);
+                uint32_t run = ~(word >> x);
+                uint8_t len = run ? __builtin_ctz(run) : 32;
+
+                memcpy(h->buffer + pos + x, front + pos + x, len * sizeof(uint8_t));
+                word &= (len == 32) ? 0 : ~(((1u << len) - 1) << x);
+            }
         }
     }
+
+    memset(h->back_map, 0, sizeof(h->back_map));
+#else
+    memcpy(h->buffer, front, LCDBUFFER_SZ * sizeof(uint8_t));
+#endif
 }
 
 /*!
-    @brief    Draw a vertical line.
-    @param    x      Left-most x-coordinate
-    @param    y      Left-most y-coordinate
-    @param    len    The length of the line including the starting pixel
-    @param    color  Black(true)/white(false)
+    @brief    Draws the contents of the buffer on the display.
+    With DMA, the call fails while the previous frame is still being sent, nothing is queued
+    then. If a front buffer is used, drawing can continue on the (back) buffer during the
+    transfer, and the refresh tried again.
+    If the handle has a shadow buffer, only the bytes that differ from what was last sent
+    to the display are transmitted.
+    @param    h     The screen handle
+    @return   Success(True) or Failure(False) in sending the data.
 */
-void SSD1306_draw_vline(uint8_t x, uint8_t y, uint8_t len, bool color)
+bool SSD1306_refresh_h(ssd_1306_t *h)
 {
-    /* Sanity check - y value is taken care of by the loop conditions */
-    if(x >= LCDWIDTH || y >= LCDHEIGHT) return;
+    #ifdef SSD1306_DMA_ACTIVE
+        /* The front buffer is still being sent */
+        if(h->q_frames) return false;
 
-    /* Limit in case we exceed maximum height */
-    if(((uint16_t)y + len) >= LCDHEIGHT) len = LCDHEIGHT - y;
+        h->deadline = HAL_GetTick() + h->period;
+    #endif
 
-    const uint8_t color_fill = color ? 0xff : 0;
-    uint16_t pos = COORDS2BUFF_POS(x, y);
-    uint8_t temp = y & 0x07;
+    if(!_refresh(h)) return false;
 
-    /* Partial bank fill */
-    if(temp)
-    {
-        ASSERT_DEBUG(pos >= LCDBUFFER_SZ, "Error at SSD1306_draw_vline\n");
-        uint8_t pixel_num = 8 - temp;
+    _swap_buffers(h);
+    return true;
+}
 
-        if(len <= pixel_num) /* Sub-case that needs to be handled */
-        {
-            pixel_num = len;
-            _set_pixels_msb2lsb(pos, pixel_num, color);
-            return;
-        }
+#ifdef SSD1306_PARTIAL_REFRESH
+/*!
+    @brief    Draws only the modified part of the buffer on the display.
+    The modified columns of each page are grouped into address windows (see _plan_windows),
+    and only the bytes inside them are sent. If the handle has a shadow buffer, this is the
+    same as SSD1306_refresh().
+    @param    h     The screen handle
+    @return   Success(True) or Failure(False) in sending the data.
+*/
+bool SSD1306_refresh_partial_h(ssd_1306_t *h)
+{
+    #ifdef SSD1306_DMA_ACTIVE
+        /* The front buffer is still being sent */
+        if(h->q_frames) return false;
 
-        _set_pixels_msb2lsb(pos, pixel_num, color);
-        pos += LCDWIDTH;
-        len -= pixel_num;
-    }
+        h->deadline = HAL_GetTick() + h->period;
+    #endif
 
-    /* Number of complete banks to fill */
-    while(len >= 8)
-    {
-        ASSERT_DEBUG(pos >= LCDBUFFER_SZ, "Error at SSD1306_draw_vline\n");
-        _screen_h->buffer[pos] = color_fill;
-        pos += LCDWIDTH;
-        len -= 8;
-    }
+    /* With a shadow, the content difference is exact and cheap to find */
+    if(!(h->shadow ? _refresh(h) : _send_windows(h))) return false;
 
-    /* Draw leftovers */
-    if(len) _set_pixels_lsb2msb(pos, len, color);
+    _swap_buffers(h);
+    return true;
 }
 
 /*!
-    @brief    Draw a generic line.
-    @param    x0     Starting x-coordinate
-    @param    x1     Ending x-coordinate
-    @param    y0     Starting y-coordinate
-    @param    y1     Ending y-coordinate
-    @param    color  Black(true)/white(false)
+    @brief    Resets the refresh statistics of the current screen.
+    @param    h     The screen handle
 */
-void SSD1306_draw_line(uint8_t x0, uint8_t x1, uint8_t y0, uint8_t y1, bool color)
+void SSD1306_reset_stats_h(ssd_1306_t *h)
 {
-    if(x0 == x1) /* Horizontal line -> Call optimized version */
-    {
-        if(y0 > y1) SWAP_VAR(y0, y1);
-
-        SSD1306_draw_vline(x0, y0, y1 - y0 + 1, color);
-    }
-    else if(y0 == y1) /* Vertical line -> Call optimized version */
-    {
-        if(x0 > x1) SWAP_VAR(x0, x1);
-
-        SSD1306_draw_hline(x0, y0, x1 - x0 + 1, color);
-    }
-    else /* General case */
-    {
-        _draw_generic_line(x0, x1, y0, y1, color);
-    }
+    memset(&h->stats, 0, sizeof(h->stats));
 }
 
 /*!
-    @brief    Draw a rectangle.
-    @param    x0     Upper left x-coordinate
-    @param    x1     Lower right x-coordinate
-    @param    y0     Upper left y-coordinate
-    @param    y1     Lower right y-coordinate
-    @param    color  Black(true)/white(false)
-    @param    fill   If true also fill the rectangle with the specified color
+    @brief    Marks a rectangle of the buffer as modified, for drawing done outside the library routines
+    (e.g. straight into the buffer), so that the partial refresh sends it.
+    @param    h      The screen handle
+    @param    x0     Leftmost x-coordinate
+    @param    x1     Rightmost x-coordinate
+    @param    y0     Upper y-coordinate
+    @param    y1     Lower y-coordinate
 */
-void SSD1306_draw_rectangle(uint8_t x0, uint8_t x1, uint8_t y0, uint8_t y1, bool color, bool fill)
+void SSD1306_mark_dirty_h(ssd_1306_t *h, uint8_t x0, uint8_t x1, uint8_t y0, uint8_t y1)
 {
     /* Sanity check */
-    if(x0 >= LCDWIDTH || y0 >= LCDHEIGHT) return;
+    if(x0 > x1 || y0 > y1 || x0 >= LCDWIDTH || y0 >= LCDHEIGHT) return;
 
-    /* Just in case mistakes were made */
-    if(x0 > x1) SWAP_VAR(x0, x1);
-    if(y0 > y1) SWAP_VAR(y0, y1);
+    if(x1 >= LCDWIDTH) x1 = LCDWIDTH - 1;
+    if(y1 >= LCDHEIGHT) y1 = LCDHEIGHT - 1;
 
-    /* Set the line lengths */
-    uint8_t len_x = x1 - x0 + 1;
-    uint8_t len_y = y1 - y0 + 1;
+    _mark_dirty(h, x0, x1, y0, y1);
+}
+#endif
 
-    if(!fill)
+#ifdef SSD1306_DMA_ACTIVE
+/*!
+    @brief    Waits until at most the given number of frames are queued, like the polling SPI.
+    @param    h       The screen handle
+    @param    frames  Frames that may still be queued
+    @return           Success(True) or Failure(False) if it takes more than SSD1306_TIMEOUT ms.
+*/
+static bool _wait_frames(ssd_1306_t *h, uint8_t frames)
+{
+    uint32_t start = HAL_GetTick();
+
+    while(h->q_frames > frames)
     {
-        /* Connect 4 lines together */
-        SSD1306_draw_hline(x0, y0, len_x, color);
-        SSD1306_draw_hline(x0, y1, len_x, color);
-        SSD1306_draw_vline(x0, y0, len_y, color);
-        SSD1306_draw_vline(x1, y0, len_y, color);
-        return;
+        if(HAL_GetTick() - start > SSD1306_TIMEOUT) return false;
     }
 
-    /* It's more efficient to use vertical lines to draw for filling.
-     * That's the case since fewer memory accesses and instructions happen (on average) */
-    if(((uint16_t)y0 + len_y) >= LCDHEIGHT) len_y = LCDHEIGHT - y0;
-    if(((uint16_t)x0 + len_x) >= LCDWIDTH) len_x = LCDWIDTH - x0;
+    return true;
+}
+#endif
 
-    const uint8_t color_fill = color ? 0xff : 0;
-    uint16_t pos = COORDS2BUFF_POS(x0, y0);
-    uint8_t temp = y0 & 0x07;
+/*!
+    @brief    Renders a frame one page at a time, so that the buffer only holds SSD1306_STRIP_SZ bytes.
+    For every page, the strip is cleared, the callback draws the whole frame with the primitives
+    clipped to the page and the page is sent. With DMA, two strips are used in turns and a page is
+    sent while the next one is drawn. The callback must not depend on state left by its previous
+    call (e.g. set the text cursor itself), and the buffer must not be used for anything else.
+    With DMA, the call waits on the SPI DMA interrupt between the pages, so it must not be made
+    with the interrupts masked or from an interrupt of the same or higher priority. The wait
+    fails after SSD1306_TIMEOUT ms (as long as the HAL tick runs) and so does the rendering.
+    @param    h      The screen handle
+    @param    draw   The callback that draws the frame
+    @param    arg    Argument passed to the callback
+    @return          Success(True) or Failure(False) in sending the data.
+*/
+bool SSD1306_render_strips_h(ssd_1306_t *h, ssd_1306_draw_t draw, void *arg)
+{
+    uint8_t *strip = h->buffer;
 
-    /* Partial bank fill */
-    if(temp)
-    {
-        ASSERT_DEBUG(pos >= LCDBUFFER_SZ, "Error at SSD1306_draw_rectangle\n");
-        uint8_t pixel_num = 8 - temp;
+    /* The pages are streamed into the whole display */
+    bool ret = _set_window(h, 0, LCDWIDTH - 1, 0, LCDPAGES - 1);
 
-        if(len_y <= pixel_num) /* Sub-case that needs to be handled */
+    for(uint8_t p = 0; ret && (p < LCDPAGES); p++)
+    {
+#ifdef SSD1306_DMA_ACTIVE
+        /* The other strip may still be sent, wait for the one sent two pages ago */
+        h->buffer = strip + (p & 0x01) * LCDWIDTH;
+        if(!_wait_frames(h, 1))
         {
-            pixel_num = len_y;
-            for(uint8_t i = 0; i < len_x; i++) _set_pixels_msb2lsb(pos + i, pixel_num, color);
-            return;
+            ret = false;
+            break;
         }
+#endif
+        h->strip_page = p;
+        h->clip_y0 = p * LCDBANK_SZ;
+        h->clip_y1 = h->clip_y0 + LCDBANK_SZ - 1;
 
-        for(uint8_t i = 0; i < len_x; i++) _set_pixels_msb2lsb(pos + i, pixel_num, color);
-        pos += LCDWIDTH;
-        len_y -= pixel_num;
-    }
+        memset(h->buffer, 0, LCDWIDTH * sizeof(uint8_t));
+        draw(arg);
 
-    /* Number of complete banks to fill */
-    while(len_y >= 8)
-    {
-        ASSERT_DEBUG(pos >= LCDBUFFER_SZ, "Error at SSD1306_draw_rectangle\n");
-        memset(_screen_h->buffer + pos, color_fill, len_x * sizeof(uint8_t));
-        pos += LCDWIDTH;
-        len_y -= 8;
+        ret = _send_packet(h, h->buffer, LCDWIDTH, true);
     }
 
-    /* Draw leftovers */
-    if(len_y)
-    {
-        for(uint8_t i = 0; i < len_x; i++) _set_pixels_lsb2msb(pos + i, len_y, color);
-    }
+    /* Restore the full screen clipping */
+    h->buffer = strip;
+    h->clip_y0 = h->strip_page = 0;
+    h->clip_y1 = LCDHEIGHT - 1;
+
+#ifdef SSD1306_PARTIAL_REFRESH
+    /* Whatever was tracked does not describe the display anymore */
+    _clear_dirty(h);
+    h->shadow_valid = false;
+#endif
+
+    return ret;
 }
 
 /*!
-    @brief    Draws a triangle. Also taken by the Adafruit GFX library.
-    @param    x0     First x-coordinate
-    @param    x1     Second x-coordinate
-    @param    x2     Third x-coordinate
-    @param    y0     First y-coordinate
-    @param    y1     Second y-coordinate
-    @param    y2     Third y-coordinate
-    @param    color  Black(true)/white(false)
+    @brief    Fills the display buffer with the specified color. The draw mode does not apply here.
+    @param    h      The screen handle
+    @param    color  Fill with black(true) or with white(false).
 */
-void SSD1306_draw_triangle(uint8_t x0, uint8_t x1, uint8_t x2, uint8_t y0, uint8_t y1, uint8_t y2, bool color)
+void SSD1306_fill_h(ssd_1306_t *h, bool black)
 {
-    SSD1306_draw_line(x0, x1, y0, y1, color);
-    SSD1306_draw_line(x1, x2, y1, y2, color);
-    SSD1306_draw_line(x0, x2, y0, y2, color);
+    uint16_t pos = COORDS2BUFF_POS(h, 0, h->clip_y0);
+    uint16_t len = ((h->clip_y1 - h->clip_y0 + 1) >> 3) * LCDWIDTH;
+
+    /* Fill the buffer with it - Only the pages it holds when rendering strips */
+    memset(h->buffer + pos, black ? 0xff : 0, len * sizeof(*h->buffer));
+    MARK_DIRTY(h, 0, LCDWIDTH - 1, h->clip_y0, h->clip_y1);
 }
 
 /*!
-    @brief    Draws a filled triangle. Also taken by the Adafruit GFX library.
-    @param    x0     First x-coordinate
-    @param    x1     Second x-coordinate
-    @param    x2     Third x-coordinate
-    @param    y0     First y-coordinate
-    @param    y1     Second y-coordinate
-    @param    y2     Third y-coordinate
-    @param    color  Triangle color, Black(true)/white(false)
+    @brief    Sets how the drawing routines merge their pixels into the buffer.
+    With SSD1306_ROP_COPY both colors are drawn, with the rest only black(true) pixels
+    (and bitmap bits) have an effect, set, cleared or inverted respectively.
+    @param    h      The screen handle
+    @param    rop    The raster operation, one of SSD1306_ROP_xxx.
 */
-void SSD1306_draw_fill_triangle(uint8_t x0, uint8_t x1, uint8_t x2, uint8_t y0, uint8_t y1, uint8_t y2, bool color)
+void SSD1306_draw_mode_h(ssd_1306_t *h, uint8_t rop)
 {
-    uint8_t a, b, y, last;
+    if(rop <= SSD1306_ROP_XOR) h->rop = rop;
+}
 
-    /* Sort coordinates by Y order (y2 >= y1 >= y0) */
-    if (y0 > y1)
-    {
-        SWAP_VAR(y0, y1);
-        SWAP_VAR(x0, x1);
-    }
+/*!
+    @brief    Inverts or uninverts the display.
+    @param    h       The screen handle
+    @param    invert  True(Invert) and False(Uninvert).
+    @return           Success(True) or Failure(False) in sending the command.
+*/
+bool SSD1306_invert_h(ssd_1306_t *h, bool invert)
+{
+    /* Allocate the buffer on the stack */
+    uint8_t rx_data = invert ? SSD1306_INVERTDISPLAY: SSD1306_NORMALDISPLAY;
 
-    if (y1 > y2)
-    {
-        SWAP_VAR(y2, y1);
-        SWAP_VAR(x2, x1);
-    }
+    return _send_packet(h, &rx_data, 1, false);
+}
 
-    if (y0 > y1)
-    {
-        SWAP_VAR(y0, y1);
-        SWAP_VAR(x0, x1);
-    }
+/*!
+    @brief    Enables or disables sleep mode.
+    @param    h       The screen handle
+    @param    enable  Enable(true) sleep mode or disable(false).
+    @return           Success(True) or Failure(False) in sending the command.
+*/
+bool SSD1306_sleep_mode_h(ssd_1306_t *h, bool sleep)
+{
+    /* Allocate the buffer on the stack */
+    uint8_t rx_data = sleep ? SSD1306_DISPLAYOFF: SSD1306_DISPLAYON;
 
-    /* Handle awkward all-on-same-line case as its own thing */
-    if(y0 == y2)
-    {
-        a = b = x0;
-        if (x1 < a)       a = x1;
-        else if (x1 > b)  b = x1;
+    return _send_packet(h, &rx_data, 1, false);
+}
 
-        if (x2 < a)       a = x2;
-        else if (x2 > b)  b = x2;
+/*!
+    @brief    Set display's contrast value.
+    @param    h         The screen handle
+    @param    contrast  The contrast value.
+    @return             Success(True) or Failure(False) in sending the command.
+*/
+bool SSD1306_contrast_h(ssd_1306_t *h, uint8_t contrast)
+{
+    /* Allocate the buffer on the stack */
+    uint8_t rx_data[2] = {SSD1306_SETCONTRAST, contrast};
 
-        SSD1306_draw_hline(a, y0, b - a + 1, color);
-        return;
+    return _send_packet(h, rx_data, 2, false);
+}
+
+/*!
+    @brief    Set vcomh value (dim or brighten the screen).
+    @param    h         The screen handle
+    @param    vcomh     The vcomh value.
+    @return             Success(True) or Failure(False) in sending the command.
+*/
+bool SSD1306_vcomh_h(ssd_1306_t *h, uint8_t vcomh)
+{
+    /* Check that it a valid input */
+    switch(vcomh)
+    {
+        case SSD1306_VCOMDETECT_DEFAULT:
+        case SSD1306_VCOMDETECT_LOW:
+        case SSD1306_VCOMDETECT_HIGH: break;
+        default: return false;
     }
 
-    uint8_t dx01 = x1 - x0, dy01 = y1 - y0, dx02 = x2 - x0, dy02 = y2 - y0,
-            dx12 = x2 - x1, dy12 = y2 - y1;
-    uint16_t sa = 0, sb = 0;
+    /* Allocate the buffer on the stack */
+    uint8_t rx_data[2] = {SSD1306_SETVCOMDETECT, vcomh};
 
-    /* For upper part of triangle, find scanline crossings for segments 0-1 and 0-2.
-     * If y1=y2 (flat-bottomed triangle), the scanline y1
-     * is included here (and second loop will be skipped, avoiding a /0
-     * error there), otherwise scanline y1 is skipped here and handled
-     * in the second loop...which also avoids a /0 error here if y0=y1
-     * (flat-topped triangle).
-     */
-
-    /* Include y1 scanline(?) or skip it(:) */
-    last = (y1 == y2) ? y1 : (y1 - 1);
-
-    for (y = y0; y <= last; y++)
-    {
-        a = x0 + sa / dy01;
-        b = x0 + sb / dy02;
-        sa += dx01;
-        sb += dx02;
-        /* longhand:
-        a = x0 + (x1 - x0) * (y - y0) / (y1 - y0);
-        b = x0 + (x2 - x0) * (y - y0) / (y2 - y0);
-        */
-        if (a > b) SWAP_VAR(a, b);
-        SSD1306_draw_hline(a, y, b - a + 1, color);
-    }
-
-    /* For lower part of triangle, find scanline crossings for segments
-     * 0-2 and 1-2.  This loop is skipped if y1=y2.
-     */
-    sa = (uint16_t)dx12 * (y - y1);
-    sb = (uint16_t)dx02 * (y - y0);
-    for (; y <= y2; y++)
-    {
-        a = x1 + sa / dy12;
-        b = x0 + sb / dy02;
-        sa += dx12;
-        sb += dx02;
-        /* longhand:
-        a = x1 + (x2 - x1) * (y - y1) / (y2 - y1);
-        b = x0 + (x2 - x0) * (y - y0) / (y2 - y0);
-        */
-        if (a > b) SWAP_VAR(a, b);
-        SSD1306_draw_hline(a, y, b - a + 1, color);
-    }
+    return _send_packet(h, rx_data, 2, false);
 }
 
 /*!
-    @brief    Draws a circle - Uses the Midpoint circle algorithm.
-    @param    x0   Center x-coordinate
-    @param    y0   Center y-coordinate
-    @param    r    Circle radius
-    @param    color - black(true)/white(false)
+    @brief    Activate horizontal scrolling.
+    @param    h         The screen handle
+    @param    speed     The speed of the scrolling, can be from 0 to 7, with
+    higher values meaning more speed.
+    @param    dir       The direction, right (true) or left (false)
+    @return             Success(True) or Failure(False) in sending the command.
 */
-void SSD1306_draw_circle(uint8_t x, uint8_t y, uint8_t r, bool color)
+bool SSD1306_hscroll_h(ssd_1306_t *h, uint8_t speed, bool dir)
 {
-    int8_t a = 0;
-    int8_t b = r;
-    int8_t p = 1 - r;
+    /* Speeds in frames: 2, 3, 4, 5, 25, 64, 128, 256 */
+    const uint8_t timing_table[8] = {0x07, 0x04, 0x05, 0x00, 0x06, 0x01, 0x02, 0x03};
 
-    do
-    {
-        SSD1306_set_pixel(x+a, y+b, color);
-        SSD1306_set_pixel(x+b, y+a, color);
-        SSD1306_set_pixel(x+a, y-b, color);
-        SSD1306_set_pixel(x+b, y-a, color);
-        SSD1306_set_pixel(x-a, y+b, color);
-        SSD1306_set_pixel(x-b, y+a, color);
-        SSD1306_set_pixel(x-a, y-b, color);
-        SSD1306_set_pixel(x-b, y-a, color);
+    /* Allocate the buffer on the stack */
+    uint8_t rx_data[8];
 
-        if(p < 0)
-        {
-            p += (3 + 2*a);
-            a++;
-        }
-        else
-        {
-            p += (5 + 2*(a-b));
-            a++;
-            b--;
-        }
-    }while(a <= b);
+    /* Max speed supported */
+    if(speed > 7) speed = 7;
+
+    /* Commands */
+    rx_data[0] = dir ? SSD1306_RIGHT_HORIZONTAL_SCROLL:
+                       SSD1306_LEFT_HORIZONTAL_SCROLL;
+    rx_data[1] = 0x00;                      /* Dummy */
+    rx_data[2] = 0x00;                      /* Start page address */
+    rx_data[3] = timing_table[speed];       /* Scroll speed */
+    rx_data[4] = LCDPAGES - 1;              /* End page address */
+    rx_data[5] = 0x00;                      /* Dummy */
+    rx_data[6] = 0xFF;                      /* Dummy */
+    rx_data[7] = SSD1306_ACTIVATE_SCROLL;
+
+    return _send_packet(h, rx_data, 8, false);
 }
 
 /*!
-    @brief    Draws a filled circle - Uses the Midpoint circle algorithm.
-    @param    x0   Center x-coordinate
-    @param    y0   Center y-coordinate
-    @param    r    Circle radius
-    @param    color - black(true)/white(false)
+    @brief    Activate horizontal and vertical scrolling.
+    @param    h          The screen handle
+    @param    hspeed     The speed of horizontal scrolling, can be from 0 to 7, with
+    higher values meaning more speed.
+    @param    vspeed    The vertical speed (or scrolling offset), can be from 0 to 0x3f
+    @param    dir       The direction, right (true) or left (false)
+    @return             Success(True) or Failure(False) in sending the command.
 */
-void SSD1306_draw_fill_circle(uint8_t x0, uint8_t y0, uint8_t r, bool color)
+bool SSD1306_hvscroll_h(ssd_1306_t *h, uint8_t hspeed, uint8_t vspeed, bool dir)
 {
-    /* Write out the middle line - we use the pixel setters since lines might be out of bounds */
-    for(uint8_t i = 0; i < (2 * r + 1); i++) SSD1306_set_pixel(x0, y0 - r + i, color);
+    /* Speeds in frames: 2, 3, 4, 5, 25, 64, 128, 256 */
+    const uint8_t timing_table[8] = {0x07, 0x04, 0x05, 0x00, 0x06, 0x01, 0x02, 0x03};
 
-    int16_t f = 1 - r;
-    int16_t ddF_x = 1;
-    int16_t ddF_y = -2 * r;
-    int16_t x = 0;
-    int16_t y = r;
-    int16_t px = x;
-    int16_t py = y;
+    /* Allocate the buffer on the stack */
+    uint8_t rx_data[8];
 
-    while (x < y)
-    {
-        if (f >= 0)
-        {
-            y--;
-            ddF_y += 2;
-            f += ddF_y;
-        }
+    /* Max speed supported */
+    if(hspeed > 7) hspeed = 7;
 
-        x++;
-        ddF_x += 2;
-        f += ddF_x;
+    /* Commands */
+    rx_data[0] = dir ? SSD1306_VERTICAL_AND_RIGHT_HORIZONTAL_SCROLL:
+                       SSD1306_VERTICAL_AND_LEFT_HORIZONTAL_SCROLL;
+    rx_data[1] = 0x00;                      /* Dummy */
+    rx_data[2] = 0x00;                      /* Start page address */
+    rx_data[3] = timing_table[hspeed];       /* Scroll speed */
+    rx_data[4] = LCDPAGES - 1;              /* End page address */
+    rx_data[5] = vspeed;                    /* Vertical scrolling offset */
+    rx_data[6] = SSD1306_ACTIVATE_SCROLL;
 
-        // These checks avoid double-drawing certain lines, important
-        // for the SSD1306 library which has an INVERT drawing mode.
-        if (x < (y + 1))
-        {
-            for(uint i = 0; i < 2 * y; i++) /* Same as initial vline drawing */
-            {
-                SSD1306_set_pixel(x0 + x, y0 - y + i, color);
-                SSD1306_set_pixel(x0 - x, y0 - y + i, color);
-            }
-        }
+    return _send_packet(h, rx_data, 7, false);
+}
 
-        if (y != py)
-        {
-            for(uint i = 0; i < 2 * px; i++) /* Same as initial vline drawing */
-            {
-                SSD1306_set_pixel(x0 + py, y0 - px + i, color);
-                SSD1306_set_pixel(x0 - py, y0 - px + i, color);
-            }
+/*!
+    @brief    Deactivate any scrolling currently on the screen.
+    @param    h     The screen handle
+    @return   Success(True) or Failure(False) in sending the command.
+*/
+bool SSD1306_scroll_disable_h(ssd_1306_t *h)
+{
+    /* Allocate the buffer on the stack */
+    uint8_t rx_data = SSD1306_DEACTIVATE_SCROLL;
 
-            py = y;
-        }
+    return _send_packet(h, &rx_data, 1, false);
+}
 
-        px = x;
-    }
+/*!
+    @brief    Set display's oscillator frequency and display clock divide ratio.
+    @param    h          The screen handle
+    @param    freq       The oscillator frequency value (values of 0 to 15).
+    @param    div_ratio  The clock division ration (values of 0 to 15).
+    @return              Success(True) or Failure(False) in sending the command.
+*/
+bool SSD1306_timings_h(ssd_1306_t *h, uint8_t freq, uint8_t div_ratio)
+{
+    /* Clip in case the values are larger */
+    if(freq > 15) freq = 15;
+    if(div_ratio > 15) div_ratio = 15;
+
+    /* Allocate the buffer on the stack */
+    uint8_t rx_data[2] = {SSD1306_SETDISPLAYCLOCKDIV, (freq << 4) | div_ratio};
 
+    return _send_packet(h, rx_data, 2, false);
 }
 
 /*!
-    @brief    Draw a rounded rectangle.
-    @param    x0     Upper left x-coordinate
-    @param    x1     Lower right x-coordinate
-    @param    y0     Upper left y-coordinate
-    @param    y1     Lower right y-coordinate
-    @param    color  Black(true)/white(false)
-    @param    fill   If true also fill the rectangle with the specified color
+    @brief    Set display's precharge period value.
+    @param    h          The screen handle
+    @param    period     The period value (values of 1 to 15).
+    @return              Success(True) or Failure(False) in sending the command.
 */
-void SSD1306_draw_round_rect(uint8_t x0, uint8_t x1, uint8_t y0, uint8_t y1, bool color, bool fill)
+bool SSD1306_precharge_h(ssd_1306_t *h, uint8_t period)
 {
-    /* Just in case mistakes were made */
-    if(x0 > x1) SWAP_VAR(x0, x1);
-    if(y0 > y1) SWAP_VAR(y0, y1);
+    /* In case input is 0 - Invalid */
+    period += !period;
 
-    /* As long as it is a valid rectangle */
-    if((x1 - x0) > 4 && (y1 - y0) > 4)
-    {
-        if(fill)
-        {
-            /* Draw a normal filed rectangle and opposite color for the other bits */
-            SSD1306_draw_rectangle(x0, x1, y0, y1, color, true);
-
-            /* Upper left corner */
-            SSD1306_set_pixel(x0, y0, !color);
-            SSD1306_set_pixel(x0 + 1, y0, !color);
-            SSD1306_set_pixel(x0, y0 + 1, !color);
-
-            /* Upper right corner */
-            SSD1306_set_pixel(x1, y0, !color);
-            SSD1306_set_pixel(x1 - 1, y0, !color);
-            SSD1306_set_pixel(x1, y0 + 1, !color);
-
-            /* Lower left corner */
-            SSD1306_set_pixel(x0, y1, !color);
-            SSD1306_set_pixel(x0 + 1, y1, !color);
-            SSD1306_set_pixel(x0, y1 - 1, !color);
-
-            /* Lower right corner */
-            SSD1306_set_pixel(x1, y1, !color);
-            SSD1306_set_pixel(x1 - 1, y1, !color);
-            SSD1306_set_pixel(x1, y1 - 1, !color);
-        }
-        else
-        {
-            SSD1306_set_pixel(x0 + 1, y0 + 1, color);
-            SSD1306_set_pixel(x1 - 1, y0 + 1, color);
-            SSD1306_set_pixel(x0 + 1, y1 - 1, color);
-            SSD1306_set_pixel(x1 - 1, y1 - 1, color);
-            SSD1306_draw_hline(x0 + 2, y0, x1 - x0 - 3, color);
-            SSD1306_draw_hline(x0 + 2, y1, x1 - x0 - 3, color);
-            SSD1306_draw_vline(x0, y0 + 2, y1 - y0 - 3, color);
-            SSD1306_draw_vline(x1, y0 + 2, y1 - y0 - 3, color);
-        }
-    }
+    /* Also check that is not above 15DCLK */
+    if(period > 15) period = 15;
+
+    /* Allocate the buffer on the stack */
+    uint8_t rx_data[2] = {SSD1306_SETPRECHARGE, period};
+
+    return _send_packet(h, rx_data, 2, false);
 }
 
 /**********************************************************/
-/************************ BITMAPS *************************/
+/************************ GRAPHICS ************************/
 /**********************************************************/
 
+/* Raster operations as (dst & ~clear) ^ toggle, for source bits src under the mask.
+ * Cleared are (mask & [0]) | (src & [1]), toggled src & [2] */
+static const uint8_t _rop_sel[4][3] =
+{
+    {0xff, 0x00, 0xff},     /* SSD1306_ROP_COPY */
+    {0x00, 0xff, 0xff},     /* SSD1306_ROP_OR */
+    {0x00, 0xff, 0x00},     /* SSD1306_ROP_AND_NOT */
+    {0x00, 0x00, 0xff}      /* SSD1306_ROP_XOR */
+};
+
 /*!
-    @brief    Get a pixel's value from a bitmap array.
-    @param    bitmap    The bitmap array
-    @param    x         x-coordinate
-    @param    y         y-coordinate
-    @param    bit_w     The bitmap width
-    @return             Black(True) or White(False).
+    @brief    Merges source bits into a buffer byte with a raster operation.
+    @param    sel     The raster operation selectors (from _rop_sel)
+    @param    dst     The buffer byte
+    @param    mask    The bits to draw
+    @param    src     The source bits, only the ones under the mask are used
+    @return           The new buffer byte.
 */
-static bool _get_bmp_pixel(const uint8_t *bitmap, uint8_t x, uint8_t y, uint8_t bit_w)
+static inline uint8_t _rop_merge(const uint8_t *sel, uint8_t dst, uint8_t mask, uint8_t src)
 {
-    /* First find the exact position */
-    uint16_t pos = COORDS2BIT_POS(x, y, bit_w);//((uint16_t)y>>3) * bit_w + x;
+    src &= mask;
 
-    return (bitmap[pos] >> (y & 0x07)) & 0x01;
+    return (dst & ~((mask & sel[0]) | (src & sel[1]))) ^ (src & sel[2]);
 }
 
 /*!
-    @brief    Get a pixel's value from a bitmap array.
-    Internal routine and different variant than the normal version.
-    @param    bitmap    The bitmap array
-    @param    pos       The position in the array
-    @param    shift     The shift value
-    @return             Black(True) or White(False).
+    @brief    Set a pixel's value. Internal routine, no error checking performed.
+    @param    h         The screen handle
+    @param    x         x-coordinate
+    @param    y         y-coordinate
+    @param    color     Black(True) or White(False).
 */
-static bool _get_bmp_pixel_opt(const uint8_t *bitmap, uint16_t pos, uint8_t shift)
+static void _set_single_pixel(ssd_1306_t *h, uint8_t x, uint8_t y, bool color)
 {
-    return (bitmap[pos] >> shift) & 0x01;
+    uint16_t pos = COORDS2BUFF_POS(h, x, y);
+    ASSERT_DEBUG(pos >= LCDBUFFER_SZ, "Error at _set_single_pixel %d\n", pos);
+
+    h->buffer[pos] = _rop_merge(ROP_SEL(h), h->buffer[pos], 1 << (y & 0x07), color ? 0xff : 0);
 }
 
 /*!
-    @brief    Draws a bitmap on the screen.
-    @param    bitmap    The bitmap array
-    @param    x0        Leftmost x-coordinate
-    @param    y0        Leftmost y-coordinate
-    @param    len_x     The width of the bitmap
-    @param    len_y     The height of the bitmap
+    @brief    Set a pixel's value. Internal routine used for loops, no error checking performed.
+    @param    h         The screen handle
+    @param    pos       Position in the buffer
+    @param    mask      The mask to apply
+    @param    color     Black(True) or White(False).
 */
-static void _draw_bitmap(const uint8_t *bitmap, uint8_t x0, uint8_t y0, uint8_t draw_x, uint8_t draw_y, uint8_t len_x)
+static void _set_single_pixel_opt(ssd_1306_t *h, uint16_t pos, uint8_t mask, bool color)
 {
-    for(uint8_t j = 0; j < draw_y; j++)
-    {
-        /* Since we use the opt version of set, we calculate it ourselves */
-        uint8_t mask = 1 << ((y0 + j) & 0x07);
-        uint8_t bmp_shift = (j & 0x07);
-        uint16_t pos = COORDS2BUFF_POS(x0, y0 + j);
-        uint16_t pos_src = COORDS2BIT_POS(0, j, len_x);
+    ASSERT_DEBUG(pos >= LCDBUFFER_SZ, "Error at _set_single_pixel_opt %d\n", pos);
 
-        for(uint8_t i = 0; i < draw_x; i++)
-        {
-            bool bmp_color = _get_bmp_pixel_opt(bitmap, pos_src + i, bmp_shift);
-            _set_single_pixel_opt(pos + i, mask, bmp_color);
-        }
-    }
+    h->buffer[pos] = _rop_merge(ROP_SEL(h), h->buffer[pos], mask, color ? 0xff : 0);
 }
 
 /*!
-    @brief    The optimized scaler kernel for nearest neighbor - x2 scale.
-    @param    bitmap    The bitmap array
-    @param    x0        Leftmost x-coordinate
-    @param    y0        Leftmost y-coordinate
-    @param    draw_x    Draw length on the x-axis
-    @param    draw_y    Draw length on the y-axis
-    @param    len_x     The width of the bitmap
-*/
-static void _scale_bitmap_nb_x2(const uint8_t *bitmap, uint8_t x0, uint8_t y0, uint8_t draw_x, uint8_t draw_y, uint8_t len_x)
-{
-    const uint8_t scale = 2;
-    const uint8_t high_mask = 0x80;
-    const uint8_t low_mask = 0x01;
-
-    for(uint8_t j = 0; j < draw_y; j++, y0 += scale)
-     {
-         uint16_t pos = COORDS2BUFF_POS(x0, y0);
-         uint16_t src_pos = COORDS2BIT_POS(0, j, len_x);
-         uint8_t bmp_shift = (j & 0x07);
-
-         if((y0 & 0x07) == 0x07)
-         {
-             for(uint8_t i = 0; i < draw_x; i++)
-             {
-                 bool color = _get_bmp_pixel_opt(bitmap, src_pos + i, bmp_shift);
-
-                 if(color)
-                 {
-                     _screen_h->buffer[pos] |= high_mask;
-                     _screen_h->buffer[pos + 1] |= high_mask;
-                     _screen_h->buffer[pos + LCDWIDTH] |= low_mask;
-                     _screen_h->buffer[pos + LCDWIDTH + 1] |= low_mask;
-                 }
-                 else
-                 {
-                     _screen_h->buffer[pos] &= ~high_mask;
-                     _screen_h->buffer[pos + 1] &= ~high_mask;
-                     _screen_h->buffer[pos + LCDWIDTH] &= ~low_mask;
-                     _screen_h->buffer[pos + LCDWIDTH + 1] &= ~low_mask;
-                 }
-
-                 pos += scale;
-             }
-         }
-         else
-         {
-             uint8_t mask = 3 << (y0 & 0x07);
-
-             for(uint8_t i = 0; i < draw_x; i++)
-             {
-                 bool color = _get_bmp_pixel_opt(bitmap, src_pos + i, bmp_shift);
-
-                 if(color)
-                 {
-                     _screen_h->buffer[pos] |= mask;
-                     _screen_h->buffer[pos + 1] |= mask;
-                 }
-                 else
-                 {
-                     _screen_h->buffer[pos] &= ~mask;
-                     _screen_h->buffer[pos + 1] &= ~mask;
-                 }
-
-                 pos += scale;
-             }
-         }
-     }
-}
-
-/*!
-    @brief    The optimized scaler kernel for nearest neighbor - x3 scale.
-    @param    bitmap    The bitmap array
-    @param    x0        Leftmost x-coordinate
-    @param    y0        Leftmost y-coordinate
-    @param    draw_x    Draw length on the x-axis
-    @param    draw_y    Draw length on the y-axis
-    @param    len_x     The width of the bitmap
+    @brief    Get a pixel's value. Internal routine, no error checking performed.
+    @param    h     The screen handle
+    @param    x     x-coordinate
+    @param    y     y-coordinate
+    @return         Black(True) or White(False).
 */
-static void _scale_bitmap_nb_x3(const uint8_t *bitmap, uint8_t x0, uint8_t y0, uint8_t draw_x, uint8_t draw_y, uint8_t len_x)
+static uint8_t _get_single_pixel(ssd_1306_t *h, uint8_t x, uint8_t y)
 {
-    const uint8_t scale = 3;
-
-    for(uint8_t j = 0; j < draw_y; j++, y0 += scale)
-    {
-        uint16_t pos = COORDS2BUFF_POS(x0, y0);
-        uint16_t src_pos = COORDS2BIT_POS(0, j, len_x);
-        uint8_t bmp_shift = (j & 0x07);
-
-        if((y0 & 0x07) >= 0x06)
-        {
-            uint8_t butes_num = 8 - (y0 & 0x07);
-            uint8_t up_mask = MSB2LSB_MASK(butes_num);
-            uint8_t low_mask = LSB2MSB_MASK(scale - butes_num);
+    /* First find the exact position */
+    uint16_t pos = COORDS2BUFF_POS(h, x, y);
+    ASSERT_DEBUG(pos >= LCDBUFFER_SZ, "Error at _get_single_pixel %d\n", pos);
 
-            for(uint8_t i = 0; i < draw_x; i++)
-            {
-                bool color = _get_bmp_pixel_opt(bitmap, src_pos + i, bmp_shift);
+    return (h->buffer[pos] >> (y & 0x07)) & 0x01;
+}
 
-                if(color)
-                {
-                    _screen_h->buffer[pos] |= up_mask;
-                    _screen_h->buffer[pos + 1] |= up_mask;
-                    _screen_h->buffer[pos + 2] |= up_mask;
-                    _screen_h->buffer[pos + LCDWIDTH] |= low_mask;
-                    _screen_h->buffer[pos + LCDWIDTH + 1] |= low_mask;
-                    _screen_h->buffer[pos + LCDWIDTH + 2] |= low_mask;
-                }
-                else
-                {
-                    _screen_h->buffer[pos] &= ~up_mask;
-                    _screen_h->buffer[pos + 1] &= ~up_mask;
-                    _screen_h->buffer[pos + 2] &= ~up_mask;
-                    _screen_h->buffer[pos + LCDWIDTH] &= ~low_mask;
-                    _screen_h->buffer[pos + LCDWIDTH + 1] &= ~low_mask;
-                    _screen_h->buffer[pos + LCDWIDTH + 2] &= ~low_mask;
-                }
-
-                pos += scale;
-            }
-        }
-        else
-        {
-            uint8_t mask = 7 << (y0 & 0x07);
-
-            for(uint8_t i = 0; i < draw_x; i++)
-            {
-                bool color = _get_bmp_pixel_opt(bitmap, src_pos + i, bmp_shift);
-
-                if(color)
-                {
-                    _screen_h->buffer[pos] |= mask;
-                    _screen_h->buffer[pos + 1] |= mask;
-                    _screen_h->buffer[pos + 2] |= mask;
-                }
-                else
-                {
-                    _screen_h->buffer[pos] &= ~mask;
-                    _screen_h->buffer[pos + 1] &= ~mask;
-                    _screen_h->buffer[pos + 2] &= ~mask;
-                }
-
-                pos += scale;
-            }
-        }
-    }
+/*!
+    @brief    Set multiple pixel values. Internal routine, no error checking performed.
+    The routine sets pixels of a single bank(check documentation for the display's pixel layout).
+    The color goes from the LSB to MSB in the buffer, or from the bottom to the top in the actual
+    display.
+    @param    h       The screen handle
+    @param    pos     The bank position in the buffer
+    @param    num     Number of pixels to color, must be less than 8(bank size).
+    @param    color   Either set pixels to black(true) or white(false).
+*/
+static void _set_pixels_lsb2msb(ssd_1306_t *h, uint16_t pos, uint8_t num, bool color)
+{
+    ASSERT_DEBUG(pos >= LCDBUFFER_SZ, "Error at _set_pixels_lsb2msb\n");
+    ASSERT_DEBUG(num >= 8, "Error at _set_pixels_lsb2msb\n");
+    _set_single_pixel_opt(h, pos, LSB2MSB_MASK(num), color);
+}
 
+/*!
+    @brief    Set multiple pixel values. Internal routine, no error checking performed.
+    The routine sets pixels of a single bank(check documentation for the display's pixel layout).
+    The color goes from the MSB to LSB in the buffer, or from the top to the bottom in the actual
+    display.
+    @param    h       The screen handle
+    @param    pos     The bank position in the buffer
+    @param    num     Number of pixels to color, must be less than 8(bank size).
+    @param    color   Either set pixels to black(true) or white(false).
+*/
+static void _set_pixels_msb2lsb(ssd_1306_t *h, uint16_t pos, uint8_t num, bool color)
+{
+    ASSERT_DEBUG(pos >= LCDBUFFER_SZ, "Error at _set_pixels_invert_msb2lsb\n");
+    ASSERT_DEBUG(num >= 8, "Error at _set_pixels_invert_msb2lsb\n");
+    _set_single_pixel_opt(h, pos, MSB2LSB_MASK(num), color);
 }
 
 /*!
-    @brief    The optimized scaler kernel for nearest neighbor - x4 scale.
-    @param    bitmap    The bitmap array
-    @param    x0        Leftmost x-coordinate
-    @param    y0        Leftmost y-coordinate
-    @param    draw_x    Draw length on the x-axis
-    @param    draw_y    Draw length on the y-axis
-    @param    len_x     The width of the bitmap
+    @brief    Applies a bank mask to consecutive bytes of a page. Internal routine, no error checking performed.
+    The bytes up to a word boundary are written one by one, the rest a word at a time with the
+    mask replicated in every byte.
+    @param    h       The screen handle
+    @param    pos     Position of the first byte in the buffer
+    @param    len     Number of bytes
+    @param    mask    The bank mask
+    @param    color   Black(True) or White(False).
 */
-static void _scale_bitmap_nb_x4(const uint8_t *bitmap, uint8_t x0, uint8_t y0, uint8_t draw_x, uint8_t draw_y, uint8_t len_x)
+static void _set_span(ssd_1306_t *h, uint16_t pos, uint8_t len, uint8_t mask, bool color)
 {
-    const uint8_t scale = 4;
+    ASSERT_DEBUG((pos + len) > LCDBUFFER_SZ, "Error at _set_span %d\n", pos);
 
-    for(uint8_t j = 0; j < draw_y; j++, y0 += scale)
-    {
-        uint16_t pos = COORDS2BUFF_POS(x0, y0);
-        uint16_t src_pos = COORDS2BIT_POS(0, j, len_x);
-        uint8_t bmp_shift = (j & 0x07);
+    uint8_t *dst = h->buffer + pos;
 
-        if((y0 & 0x07) >= 0x05)
-        {
-            uint8_t butes_num = 8 - (y0 & 0x07);
-            uint8_t up_mask = MSB2LSB_MASK(butes_num);
-            uint8_t low_mask = LSB2MSB_MASK(scale - butes_num);
+    /* The same bits are cleared and toggled in every byte */
+    const uint8_t toggle = _rop_merge(ROP_SEL(h), 0, mask, color ? 0xff : 0);
+    const uint8_t clear = ~(_rop_merge(ROP_SEL(h), 0xff, mask, color ? 0xff : 0) ^ toggle);
+    const uint32_t clear_w = clear * 0x01010101UL;
+    const uint32_t toggle_w = toggle * 0x01010101UL;
 
-            for(uint8_t i = 0; i < draw_x; i++)
-            {
-                bool color = _get_bmp_pixel_opt(bitmap, src_pos + i, bmp_shift);
+    /* Whole bytes are simply overwritten */
+    if(clear == 0xff)
+    {
+        memset(dst, toggle, len);
+        return;
+    }
 
-                if(color)
-                {
-                    _screen_h->buffer[pos] |= up_mask;
-                    _screen_h->buffer[pos + 1] |= up_mask;
-                    _screen_h->buffer[pos + 2] |= up_mask;
-                    _screen_h->buffer[pos + 3] |= up_mask;
-                    _screen_h->buffer[pos + LCDWIDTH] |= low_mask;
-                    _screen_h->buffer[pos + LCDWIDTH + 1] |= low_mask;
-                    _screen_h->buffer[pos + LCDWIDTH + 2] |= low_mask;
-                    _screen_h->buffer[pos + LCDWIDTH + 3] |= low_mask;
-                }
-                else
-                {
-                    _screen_h->buffer[pos] &= ~up_mask;
-                    _screen_h->buffer[pos + 1] &= ~up_mask;
-                    _screen_h->buffer[pos + 2] &= ~up_mask;
-                    _screen_h->buffer[pos + 3] &= ~up_mask;
-                    _screen_h->buffer[pos + LCDWIDTH] &= ~low_mask;
-                    _screen_h->buffer[pos + LCDWIDTH + 1] &= ~low_mask;
-                    _screen_h->buffer[pos + LCDWIDTH + 2] &= ~low_mask;
-                    _screen_h->buffer[pos + LCDWIDTH + 3] &= ~low_mask;
-                }
+    /* Head - Unaligned bytes */
+    for(; len && ((uintptr_t)dst & 0x03); len--, dst++)
+    {
+        *dst = (*dst & ~clear) ^ toggle;
+    }
 
-                pos += scale;
-            }
-        }
-        else
-        {
-            uint8_t mask = 15 << (y0 & 0x07);
+    /* Body - Whole words */
+    for(; len >= 4; len -= 4, dst += 4)
+    {
+        _store_word(dst, (_load_word(dst) & ~clear_w) ^ toggle_w);
+    }
 
-            for(uint8_t i = 0; i < draw_x; i++)
-            {
-                bool color = _get_bmp_pixel_opt(bitmap, src_pos + i, bmp_shift);
+    /* Tail - Leftover bytes */
+    for(; len; len--, dst++)
+    {
+        *dst = (*dst & ~clear) ^ toggle;
+    }
+}
 
-                if(color)
-                {
-                    _screen_h->buffer[pos] |= mask;
-                    _screen_h->buffer[pos + 1] |= mask;
-                    _screen_h->buffer[pos + 2] |= mask;
-                    _screen_h->buffer[pos + 3] |= mask;
-                }
-                else
-                {
-                    _screen_h->buffer[pos] &= ~mask;
-                    _screen_h->buffer[pos + 1] &= ~mask;
-                    _screen_h->buffer[pos + 2] &= ~mask;
-                    _screen_h->buffer[pos + 3] &= ~mask;
-                }
+/*!
+    @brief    Clips a vertical run of pixels to the rows that can be drawn.
+    These are the whole screen, or only the page being rendered in strip mode.
+    @param    h      The screen handle
+    @param    y      Upper y-coordinate, moved down to the first drawable row
+    @param    len    The number of rows, reduced to the drawable ones
+    @return          True if any of the rows can be drawn.
+*/
+static bool _clip_rows(ssd_1306_t *h, uint8_t *y, uint8_t *len)
+{
+    const uint8_t y0 = h->clip_y0, y1 = h->clip_y1;
 
-                pos += scale;
-            }
-        }
+    if(*y > y1 || ((uint16_t)*y + *len) <= y0) return false;
+
+    if(*y < y0)
+    {
+        *len -= y0 - *y;
+        *y = y0;
     }
 
+    if(((uint16_t)*y + *len) > ((uint16_t)y1 + 1)) *len = y1 + 1 - *y;
+
+    return *len != 0;
 }
 
 /*!
-    @brief    Draws a bitmap on the screen and scale upwards by the argument scale.
-    The scaling is performed by using the nearest neighbor interpolation method.
-    If scale is set to 1, then simply draw the bitmap as is.
-    @param    bitmap    The bitmap array
-    @param    x0        Leftmost x-coordinate
-    @param    y0        Leftmost y-coordinate
-    @param    len_x     The width of the bitmap
-    @param    len_y     The height of the bitmap
-    @param    scale     The scale factor, can be 1, 2, 3 or 4
+    @brief    Draws a generic line. Internal routine, it uses Bresenhm's algorithm and is based on the implementation
+    by the Adafruit GFX library.
+    @param    h      The screen handle
+    @param    x0     Starting x-coordinate
+    @param    x1     Ending x-coordinate
+    @param    y0     Starting y-coordinate
+    @param    y1     Ending y-coordinate
+    @param    color  Black(true)/white(false)
 */
-void SSD1306_draw_bitmap(const uint8_t *bitmap, uint8_t x0, uint8_t y0, uint8_t len_x, uint8_t len_y, uint8_t scale)
+static void _draw_generic_line(ssd_1306_t *h, uint8_t x0, uint8_t x1, uint8_t y0, uint8_t y1, bool color)
 {
-    /* Illegal format of the bitmap or initial position */
-    if(x0 >= LCDWIDTH || y0 >= LCDHEIGHT) return;
+    int16_t steep = abs(y1 - y0) > abs(x1 - x0);
 
-    /* Draw lengths */
-    uint8_t draw_y = len_y, draw_x = len_x;
+    if(steep)
+    {
+        SWAP_VAR(x0, y0);
+        SWAP_VAR(x1, y1);
+    }
+
+    if(x0 > x1)
+    {
+        SWAP_VAR(x0, x1);
+        SWAP_VAR(y0, y1);
+    }
 
-    /* Adjust traverse length of bitmap if need be */
-    if(((uint16_t)y0 + scale * len_y) > LCDHEIGHT) draw_y = (LCDHEIGHT - y0)/scale;
-    if(((uint16_t)x0 + scale * len_x) > LCDWIDTH) draw_x = (LCDWIDTH - x0)/scale;
+    int16_t dx = x1 - x0;
+    int16_t dy = abs(y1 - y0);
+    int16_t err = dx >> 1;
+    int16_t ystep = (y0 < y1) ? 1 : -1;
 
-    /* Factor has to be x2, x3, x4 */
-    switch(scale)
+    for (; x0 <= x1; x0++)
     {
-        case 1: /* No scaling */
-        {
-            _draw_bitmap(bitmap, x0, y0, draw_x, draw_y, len_x);
-            break;
-        }
-        case 2:
+        if(steep)
         {
-            _scale_bitmap_nb_x2(bitmap, x0, y0, draw_x, draw_y, len_x);
-            break;
+            SSD1306_set_pixel_h(h, y0, x0, color);
         }
-        case 3:
+        else
         {
-            _scale_bitmap_nb_x3(bitmap, x0, y0, draw_x, draw_y, len_x);
-            break;
+            SSD1306_set_pixel_h(h, x0, y0, color);
         }
-        case 4:
+
+        err -= dy;
+        if(err < 0)
         {
-            _scale_bitmap_nb_x4(bitmap, x0, y0, draw_x, draw_y, len_x);
-            break;
+            y0 += ystep;
+            err += dx;
         }
-        default: return;
     }
 }
 
 /*!
-    @brief    Draws a bitmap on the screen.
-    Optimized version that draws bitmaps with height a multiple of 8
-    and that start from a multiple of 8 y-coordinate.
-    Basically we draw from the start of a bank continuously.
-
-    @param    bitmap    The bitmap array
-    @param    x0        Leftmost x-coordinate
-    @param    y0        Leftmost y-coordinate
-    @param    len_x     The width of the bitmap
-    @param    len_y     The height of the bitmap
+    @brief    Set a pixel's value.
+    @param    h       The screen handle
+    @param    x       x-coordinate
+    @param    y       y-coordinate
+    @param    color   Black(true) or white(false)
 */
-void SSD1306_draw_bitmap_opt8(const uint8_t *bitmap, uint8_t x0, uint8_t y0, uint8_t len_x, uint8_t len_y)
+void SSD1306_set_pixel_h(ssd_1306_t *h, uint8_t x, uint8_t y, bool color)
 {
-    /* Illegal format of the bitmap or initial position or height */
-    if(x0 >= LCDWIDTH || y0 >= LCDHEIGHT) return;
-    if((y0 & 0x07) || (len_y & 0x07)) return;
-
-    /* Fix drawing length */
-    if(((uint16_t)y0 + len_y) >= LCDHEIGHT) len_y = LCDHEIGHT - y0;
-    if(((uint16_t)x0 + len_x) >= LCDWIDTH) len_x = LCDWIDTH - x0;
+    /* Sanity check - Also keeps to the page being rendered in strip mode */
+    if((x >= LCDWIDTH) || ROW_CLIPPED(h, y)) return;
 
-    uint8_t full_banks = len_y >> 3;
-    uint16_t pos = COORDS2BUFF_POS(x0, y0);
-    uint16_t pos_src = 0;
-
-    for(uint8_t j = 0; j < full_banks; j++)
-    {
-        ASSERT_DEBUG((pos) >= LCDBUFFER_SZ, "Error at SSD1306_draw_bitmap_opt8 -> %d\n", pos);
-        ASSERT_DEBUG((pos_src) >= (len_x*len_y), "Error at SSD1306_draw_bitmap_opt8 -> %d\n", pos_src);
-
-        memcpy(_screen_h->buffer + pos, bitmap + pos_src, len_x * sizeof(uint8_t));
-        pos += LCDWIDTH;
-        pos_src += len_x;
-    }
+    /* Call the internal routine */
+    _set_single_pixel(h, x, y, color);
+    MARK_DIRTY(h, x, x, y, y);
 }
 
-/**********************************************************/
-/************************* TEXT ***************************/
-/**********************************************************/
-
 /*!
-    @brief    Set the cursor position for the default printer.
-    @param    x  x-coordinate
-    @param    y  y-coordinate
+    @brief    Returns a pixel's value.
+    @param    h   The screen handle
+    @param    x   x-coordinate
+    @param    y   y-coordinate
+    @return       In case of error, 0xFF is returned, otherwise true or false.
 */
-void SSD1306_coord(uint8_t x, uint8_t y)
+uint8_t SSD1306_get_pixel_h(ssd_1306_t *h, uint8_t x, uint8_t y)
 {
-    if(x < LCDWIDTH) _screen_h->x_pos = x;
-    if(y < LCDHEIGHT) _screen_h->y_pos = y >> 3;
+    /* Return max value in case of failure */
+    return ((x >= LCDWIDTH) || ROW_CLIPPED(h, y)) ? 0xff : _get_single_pixel(h, x, y);
 }
 
 /*!
-    @brief    Draws a string on the screen.
-    This is the default printer that draws on the preassigned coordinates with the
-    preassigned font (small, medium, large).
-    The printing is done on the bank borders, so text can be aligned UP, CENTER and LOW.
+    @brief    Draw a horizontal line.
+    @param    h      The screen handle
+    @param    x      Left-most x-coordinate
+    @param    y      Left-most y-coordinate
+    @param    len    The length of the line including the starting pixel
+    @param    color  Black(true)/white(false)
+*/
+void SSD1306_draw_hline_h(ssd_1306_t *h, uint8_t x, uint8_t y, uint8_t len, bool color)
+{
+    /* Sanity check - x value is taken care of by the loop conditions */
+    if(ROW_CLIPPED(h, y) || x >= LCDWIDTH) return;
 
-    CENTER:    Text aligned exactly at the center
-    BOTTOM:    Text aligned exactly at the lowest part
-    TOP:       Text aligned exactly at the highest possible spot
+    uint16_t pos = COORDS2BUFF_POS(h, x, y);
+    if(((uint16_t)x + len) > LCDWIDTH) len = LCDWIDTH - x;
+    uint8_t mask = 1 << (y & 0x07);
 
-    In the case of LARGE text, no option is available.
-    In the case of MEDIUM text, only TOP and BOTTOM options available.
-    In the case of SMALL text, all options are available.
+    if(!len) return;
+    MARK_DIRTY(h, x, x + len - 1, y, y);
 
-    @param    str       The string to print
-    @param    option    The options (font and potential centering)
-    @param    invert    Flag to invert the text, if true inverts (black bg with white character)
-    otherwise left as is
+    _set_span(h, pos, len, mask, color);
+}
+
+/*!
+    @brief    Draw a vertical line.
+    @param    h      The screen handle
+    @param    x      Left-most x-coordinate
+    @param    y      Left-most y-coordinate
+    @param    len    The length of the line including the starting pixel
+    @param    color  Black(true)/white(false)
 */
-void SSD1306_print_str(const char *str, uint8_t option, bool invert)
+void SSD1306_draw_vline_h(ssd_1306_t *h, uint8_t x, uint8_t y, uint8_t len, bool color)
 {
-    /* Sanity check */
-    if(!str) return;
+    /* Sanity check - Limit in case we exceed maximum height (or the rendered page) */
+    if(x >= LCDWIDTH || !_clip_rows(h, &y, &len)) return;
+    MARK_DIRTY(h, x, x, y, y + len - 1);
 
-    uint8_t width, shift, byte_num, *font;
-    const char offset = 0x20; /* For now this is constant - TODO No big number fonts */
+    uint16_t pos = COORDS2BUFF_POS(h, x, y);
+    uint8_t temp = y & 0x07;
 
-    /* Get the parameters of the text */
-    switch(option & FONT_MASK)
+    /* Partial bank fill */
+    if(temp)
     {
-        case LARGE_FONT:
-        {
-            shift = 0;
-            width = 6;
-            byte_num = 6;
-            font = (uint8_t *)large_font; // For Compiler warnings //
-            break;
-        }
-        case MEDIUM_FONT:
-        {
-            shift = (option & ALIGMENT_MASK) >> 1; /* Only up or bottom alignment for medium */
-            width = 5;
-            byte_num = 5;
-            font = (uint8_t *)medium_font; // For Compiler warnings //
-            break;
-        }
-        case SMALL_FONT:
-        {
-            shift = option & ALIGMENT_MASK;
-            width = 4;
-            byte_num = 3;
-            font = (uint8_t *)small_font; // For Compiler warnings //
-            break;
-        }
-        default: return; /* Illegal option */
-    }
-
-    /* Print buffer in case we need to edit a character */
-    uint8_t buffer[6];
+        ASSERT_DEBUG(pos >= LCDBUFFER_SZ, "Error at SSD1306_draw_vline\n");
+        uint8_t pixel_num = 8 - temp;
 
-    for(; *str; str++)
-    {
-        /* Screen bounds exceeded or newline found */
-        if((_screen_h->x_pos + width) >= LCDWIDTH || *str == '\n')
+        if(len <= pixel_num) /* Sub-case - The line ends inside this bank */
         {
-            _screen_h->x_pos = 0;
-            _screen_h->y_pos++;
+            _set_single_pixel_opt(h, pos, MSB2LSB_MASK(pixel_num) & LSB2MSB_MASK(temp + len), color);
+            return;
         }
 
-        /* Screen bounds exceeded, reset back to start */
-        if(_screen_h->y_pos >= LCDHEIGHT/8) _screen_h->y_pos = 0;
-
-        if(*str >= offset)
-        {
-            uint16_t dest_pos = ((uint16_t)_screen_h->y_pos) * LCDWIDTH + _screen_h->x_pos;
-            uint16_t src_pos = (*str - offset) * byte_num;
-
-            /* Copy to the print buffer */
-            memcpy(buffer, font + src_pos, byte_num * sizeof(uint8_t));
-
-            /* Small font has to be decoded since the bytes are packed */
-            if((option & FONT_MASK) == SMALL_FONT)
-            {
-                /* Unpack the 3 bytes into 4 */
-                buffer[3] = (buffer[0] & 0xfc) >> 2;
-                buffer[4] = ((buffer[0] & 0x03) << 4) | ((buffer[1] & 0xf0) >> 4);
-                buffer[5] = ((buffer[1] & 0x0f) << 2) | ((buffer[2] & 0xc0) >> 6);
-                uint8_t temp = buffer[2] & 0x3f;
-
-                /* Correct position */
-                buffer[0] = buffer[3];
-                buffer[1] = buffer[4];
-                buffer[2] = buffer[5];
-                buffer[3] = temp;
-            }
-
-            /* Shifting */
-            if(shift)
-            {
-                for(uint8_t i = 0; i < width; i++) buffer[i] = buffer[i] << shift;
-            }
-
-            /* Invert option */
-            if(invert)
-            {
-                for(uint8_t i = 0; i < width; i++) buffer[i] = ~buffer[i];
-            }
-
-            memcpy(_screen_h->buffer + dest_pos, buffer, width * sizeof(uint8_t));
+        _set_pixels_msb2lsb(h, pos, pixel_num, color);
+        pos += LCDWIDTH;
+        len -= pixel_num;
+    }
 
-            _screen_h->x_pos += width;
-        }
+    /* Number of complete banks to fill */
+    while(len >= 8)
+    {
+        ASSERT_DEBUG(pos >= LCDBUFFER_SZ, "Error at SSD1306_draw_vline\n");
+        _set_single_pixel_opt(h, pos, 0xff, color);
+        pos += LCDWIDTH;
+        len -= 8;
     }
+
+    /* Draw leftovers */
+    if(len) _set_pixels_lsb2msb(h, pos, len, color);
 }
 
 /*!
-    @brief    Draws a string on the screen.
-    This variant prints a string on any xy coordinate in the screen (starting positions) freely, hence
-    the 'f' in method name. The starting position is the uppermost left point of where a character should be.
-    This variant can also scale the letters upwards if need be.
-    @param    str       The string to print
-    @param    option    Font type (Alignment is not needed here)
-    @param    x         Starting x-coordinate
-    @param    y         Starting y-coordinate
-    @param    scale     How much to scale the existing font (x1, x2, x3, x4 only)
-    @param    invert    Flag to invert the text, if true inverts (black bg with white character)
-    otherwise left as is.
+    @brief    Draw a generic line.
+    @param    h      The screen handle
+    @param    x0     Starting x-coordinate
+    @param    x1     Ending x-coordinate
+    @param    y0     Starting y-coordinate
+    @param    y1     Ending y-coordinate
+    @param    color  Black(true)/white(false)
 */
-void SSD1306_print_fstr(const char *str, uint8_t option, uint8_t x, uint8_t y, uint8_t scale, bool invert)
+void SSD1306_draw_line_h(ssd_1306_t *h, uint8_t x0, uint8_t x1, uint8_t y0, uint8_t y1, bool color)
+{
+    if(x0 == x1) /* Horizontal line -> Call optimized version */
+    {
+        if(y0 > y1) SWAP_VAR(y0, y1);
+
+        SSD1306_draw_vline_h(h, x0, y0, y1 - y0 + 1, color);
+    }
+    else if(y0 == y1) /* Vertical line -> Call optimized version */
+    {
+        if(x0 > x1) SWAP_VAR(x0, x1);
+
+        SSD1306_draw_hline_h(h, x0, y0, x1 - x0 + 1, color);
+    }
+    else /* General case */
+    {
+        _draw_generic_line(h, x0, x1, y0, y1, color);
+    }
+}
+
+/*!
+    @brief    Draw a rectangle.
+    @param    h      The screen handle
+    @param    x0     Upper left x-coordinate
+    @param    x1     Lower right x-coordinate
+    @param    y0     Upper left y-coordinate
+    @param    y1     Lower right y-coordinate
+    @param    color  Black(true)/white(false)
+    @param    fill   If true also fill the rectangle with the specified color
+*/
+void SSD1306_draw_rectangle_h(ssd_1306_t *h, uint8_t x0, uint8_t x1, uint8_t y0, uint8_t y1, bool color, bool fill)
 {
     /* Sanity check */
-    if(!str) return;
+    if(x0 >= LCDWIDTH || y0 >= LCDHEIGHT) return;
 
-    uint8_t width, height, byte_num, *font;
-    uint8_t real_width, real_height;
-    const char offset = 0x20; /* For now this is constant - TODO No big number fonts */
+    /* Just in case mistakes were made */
+    if(x0 > x1) SWAP_VAR(x0, x1);
+    if(y0 > y1) SWAP_VAR(y0, y1);
 
-    /* Get the parameters of the text */
-    switch(option & FONT_MASK)
+    /* Set the line lengths */
+    uint8_t len_x = x1 - x0 + 1;
+    uint8_t len_y = y1 - y0 + 1;
+
+    if(!fill)
     {
-        case LARGE_FONT:
-        {
-            height = 8;
-            width = 6;
-            byte_num = 6;
-            font = (uint8_t *)large_font; // For Compiler warnings //
-            break;
-        }
-        case MEDIUM_FONT:
-        {
-            height = 7;
-            width = 5;
-            byte_num = 5;
-            font = (uint8_t *)medium_font; // For Compiler warnings //
-            break;
-        }
-        case SMALL_FONT:
+        /* Connect 4 lines together - Every pixel is drawn once, so that XOR draws can be undone */
+        SSD1306_draw_hline_h(h, x0, y0, len_x, color);
+        if(len_y > 1) SSD1306_draw_hline_h(h, x0, y1, len_x, color);
+
+        if(len_y > 2)
         {
-            height = 6;
-            width = 4;
-            byte_num = 3;
-            font = (uint8_t *)small_font; // For Compiler warnings //
-            break;
+            SSD1306_draw_vline_h(h, x0, y0 + 1, len_y - 2, color);
+            if(len_x > 1) SSD1306_draw_vline_h(h, x1, y0 + 1, len_y - 2, color);
         }
-        default: return; /* Illegal option */
+        return;
     }
 
-    /* Set parameters for the scaling */
-    real_width = width * scale;
-    real_height = height * scale;
+    /* It's more efficient to use vertical lines to draw for filling.
+     * That's the case since fewer memory accesses and instructions happen (on average) */
+    if(((uint16_t)x0 + len_x) >= LCDWIDTH) len_x = LCDWIDTH - x0;
 
-    /* Print buffer in case we need to edit a character */
-    uint8_t buffer[6];
+    if(!len_x || !_clip_rows(h, &y0, &len_y)) return;
+    MARK_DIRTY(h, x0, x0 + len_x - 1, y0, y0 + len_y - 1);
+
+    uint16_t pos = COORDS2BUFF_POS(h, x0, y0);
+    uint8_t temp = y0 & 0x07;
 
-    for(; *str; str++)
+    /* Partial bank fill */
+    if(temp)
     {
-        /* Screen bounds exceeded or newline found */
-        if((x + real_width) >= LCDWIDTH || *str == '\n')
+        ASSERT_DEBUG(pos >= LCDBUFFER_SZ, "Error at SSD1306_draw_rectangle\n");
+        uint8_t pixel_num = 8 - temp;
+
+        if(len_y <= pixel_num) /* Sub-case - The rectangle ends inside this bank */
         {
-            x = 0;
-            y += real_height;
+            _set_span(h, pos, len_x, MSB2LSB_MASK(pixel_num) & LSB2MSB_MASK(temp + len_y), color);
+            return;
         }
 
-        /* Screen bounds exceeded, reset back to start */
-        if(y >= LCDHEIGHT) y = 0;
+        _set_span(h, pos, len_x, MSB2LSB_MASK(pixel_num), color);
+        pos += LCDWIDTH;
+        len_y -= pixel_num;
+    }
 
-        if(*str >= offset)
-        {
-            uint16_t src_pos = (*str - offset) * byte_num;
+    /* Number of complete banks to fill */
+    while(len_y >= 8)
+    {
+        ASSERT_DEBUG(pos >= LCDBUFFER_SZ, "Error at SSD1306_draw_rectangle\n");
+        _set_span(h, pos, len_x, 0xff, color);
+        pos += LCDWIDTH;
+        len_y -= 8;
+    }
 
-            /* Copy to the print buffer */
-            memcpy(buffer, font + src_pos, byte_num * sizeof(uint8_t));
+    /* Draw leftovers */
+    if(len_y) _set_span(h, pos, len_x, LSB2MSB_MASK(len_y), color);
+}
 
-            /* Small font has to be decoded since the bytes are packed */
-            if((option & FONT_MASK) == SMALL_FONT)
-            {
-                /* Unpack the 3 bytes into 4 */
-                buffer[3] = (buffer[0] & 0xfc) >> 2;
-                buffer[4] = ((buffer[0] & 0x03) << 4) | ((buffer[1] & 0xf0) >> 4);
-                buffer[5] = ((buffer[1] & 0x0f) << 2) | ((buffer[2] & 0xc0) >> 6);
-                uint8_t temp = buffer[2] & 0x3f;
-
-                /* Correct position */
-                buffer[0] = buffer[3];
-                buffer[1] = buffer[4];
-                buffer[2] = buffer[5];
-                buffer[3] = temp;
-            }
+/*!
+    @brief    Draws a triangle. Also taken by the Adafruit GFX library.
+    The sides meet (and may overlap) at the corners, so with SSD1306_ROP_XOR those pixels are inverted back.
+    @param    h      The screen handle
+    @param    x0     First x-coordinate
+    @param    x1     Second x-coordinate
+    @param    x2     Third x-coordinate
+    @param    y0     First y-coordinate
+    @param    y1     Second y-coordinate
+    @param    y2     Third y-coordinate
+    @param    color  Black(true)/white(false)
+*/
+void SSD1306_draw_triangle_h(ssd_1306_t *h, uint8_t x0, uint8_t x1, uint8_t x2, uint8_t y0, uint8_t y1, uint8_t y2, bool color)
+{
+    SSD1306_draw_line_h(h, x0, x1, y0, y1, color);
+    SSD1306_draw_line_h(h, x1, x2, y1, y2, color);
+    SSD1306_draw_line_h(h, x0, x2, y0, y2, color);
+}
 
-            /* Invert option */
-            if(invert)
-            {
-                for(uint8_t i = 0; i < width; i++) buffer[i] = ~buffer[i];
-            }
+/*!
+    @brief    Draws a filled triangle. Also taken by the Adafruit GFX library.
+    @param    h      The screen handle
+    @param    x0     First x-coordinate
+    @param    x1     Second x-coordinate
+    @param    x2     Third x-coordinate
+    @param    y0     First y-coordinate
+    @param    y1     Second y-coordinate
+    @param    y2     Third y-coordinate
+    @param    color  Triangle color, Black(true)/white(false)
+*/
+void SSD1306_draw_fill_triangle_h(ssd_1306_t *h, uint8_t x0, uint8_t x1, uint8_t x2, uint8_t y0, uint8_t y1, uint8_t y2, bool color)
+{
+    /* Wide scanline variables - Avoid wrapping around when y1 = 0 or y2 = 255 */
+    uint8_t a, b;
+    uint16_t y;
+    int16_t last;
 
-            /* Draw the bitmap */
-            SSD1306_draw_bitmap(buffer, x, y, width, height * sizeof(uint8_t), scale);
+    /* Sort coordinates by Y order (y2 >= y1 >= y0) */
+    if (y0 > y1)
+    {
+        SWAP_VAR(y0, y1);
+        SWAP_VAR(x0, x1);
+    }
 
-            x += real_width;
-        }
+    if (y1 > y2)
+    {
+        SWAP_VAR(y2, y1);
+        SWAP_VAR(x2, x1);
+    }
+
+    if (y0 > y1)
+    {
+        SWAP_VAR(y0, y1);
+        SWAP_VAR(x0, x1);
+    }
+
+    /* Handle awkward all-on-same-line case as its own thing */
+    if(y0 == y2)
+    {
+        a = b = x0;
+        if (x1 < a)       a = x1;
+        else if (x1 > b)  b = x1;
+
+        if (x2 < a)       a = x2;
+        else if (x2 > b)  b = x2;
+
+        SSD1306_draw_hline_h(h, a, y0, b - a + 1, color);
+        return;
+    }
+
+    /* Signed steps - The sides may go left as well as right */
+    int16_t dx01 = x1 - x0, dy01 = y1 - y0, dx02 = x2 - x0, dy02 = y2 - y0,
+            dx12 = x2 - x1, dy12 = y2 - y1;
+    int32_t sa = 0, sb = 0;
+
+    /* For upper part of triangle, find scanline crossings for segments 0-1 and 0-2.
+     * If y1=y2 (flat-bottomed triangle), the scanline y1
+     * is included here (and second loop will be skipped, avoiding a /0
+     * error there), otherwise scanline y1 is skipped here and handled
+     * in the second loop...which also avoids a /0 error here if y0=y1
+     * (flat-topped triangle).
+     */
+
+    /* Include y1 scanline(?) or skip it(:) */
+    last = (y1 == y2) ? y1 : (y1 - 1);
+
+    for (y = y0; y <= last; y++)
+    {
+        a = x0 + sa / dy01;
+        b = x0 + sb / dy02;
+        sa += dx01;
+        sb += dx02;
+        /* longhand:
+        a = x0 + (x1 - x0) * (y - y0) / (y1 - y0);
+        b = x0 + (x2 - x0) * (y - y0) / (y2 - y0);
+        */
+        if (a > b) SWAP_VAR(a, b);
+        SSD1306_draw_hline_h(h, a, y, b - a + 1, color);
+    }
+
+    /* For lower part of triangle, find scanline crossings for segments
+     * 0-2 and 1-2.  This loop is skipped if y1=y2.
+     */
+    sa = (int32_t)dx12 * (y - y1);
+    sb = (int32_t)dx02 * (y - y0);
+    for (; y <= y2; y++)
+    {
+        a = x1 + sa / dy12;
+        b = x0 + sb / dy02;
+        sa += dx12;
+        sb += dx02;
+        /* longhand:
+        a = x1 + (x2 - x1) * (y - y1) / (y2 - y1);
+        b = x0 + (x2 - x0) * (y - y0) / (y2 - y0);
+        */
+        if (a > b) SWAP_VAR(a, b);
+        SSD1306_draw_hline_h(h, a, y, b - a + 1, color);
+    }
+}
+
+/*!
+    @brief    Draws a vertical span of a filled shape. Internal routine, the coordinates wrap around like the
+    8-bit ones of the pixel setters, so a span that wraps past row 255 is split in two vertical lines.
+    @param    h      The screen handle
+    @param    x      x-coordinate
+    @param    y      Upper y-coordinate
+    @param    len    The number of rows
+    @param    color  Black(true)/white(false)
+*/
+static void _draw_vspan(ssd_1306_t *h, uint8_t x, uint8_t y, uint16_t len, bool color)
+{
+    while(len)
+    {
+        uint16_t seg = 256 - y;
+        if(seg > len) seg = len;
+
+        /* Only the part up to the screen height can be visible */
+        if(y < LCDHEIGHT) SSD1306_draw_vline_h(h, x, y, (seg > LCDHEIGHT) ? LCDHEIGHT : seg, color);
+
+        len -= seg;
+        y = 0;
+    }
+}
+
+/*!
+    @brief    Sets a pixel mirrored in the four quadrants around a center. Pixels that coincide on
+    the axes are only set once.
+    @param    h      The screen handle
+    @param    x      Center x-coordinate
+    @param    y      Center y-coordinate
+    @param    dx     Distance on the x-axis
+    @param    dy     Distance on the y-axis
+    @param    color  Black(true)/white(false)
+*/
+static void _set_mirrored_pixels(ssd_1306_t *h, uint8_t x, uint8_t y, uint8_t dx, uint8_t dy, bool color)
+{
+    SSD1306_set_pixel_h(h, x + dx, y + dy, color);
+    if(dx) SSD1306_set_pixel_h(h, x - dx, y + dy, color);
+
+    if(dy)
+    {
+        SSD1306_set_pixel_h(h, x + dx, y - dy, color);
+        if(dx) SSD1306_set_pixel_h(h, x - dx, y - dy, color);
     }
 }
+
+/*!
+    @brief    Draws a circle - Uses the Midpoint circle algorithm.
+    @param    h    The screen handle
+    @param    x0   Center x-coordinate
+    @param    y0   Center y-coordinate
+    @param    r    Circle radius
+    @param    color - black(true)/white(false)
+*/
+void SSD1306_draw_circle_h(ssd_1306_t *h, uint8_t x, uint8_t y, uint8_t r, bool color)
+{
+    int8_t a = 0;
+    int8_t b = r;
+    int8_t p = 1 - r;
+
+    do
+    {
+        /* The octants meet on the axes and the diagonals */
+        _set_mirrored_pixels(h, x, y, a, b, color);
+        if(a != b) _set_mirrored_pixels(h, x, y, b, a, color);
+
+        if(p < 0)
+        {
+            p += (3 + 2*a);
+            a++;
+        }
+        else
+        {
+            p += (5 + 2*(a-b));
+            a++;
+            b--;
+        }
+    }while(a <= b);
+}
+
+/*!
+    @brief    Draws a filled circle - Uses the Midpoint circle algorithm.
+    @param    h    The screen handle
+    @param    x0   Center x-coordinate
+    @param    y0   Center y-coordinate
+    @param    r    Circle radius
+    @param    color - black(true)/white(false)
+*/
+void SSD1306_draw_fill_circle_h(ssd_1306_t *h, uint8_t x0, uint8_t y0, uint8_t r, bool color)
+{
+    /* Write out the middle line */
+    _draw_vspan(h, x0, y0 - r, 2 * r + 1, color);
+
+    int16_t f = 1 - r;
+    int16_t ddF_x = 1;
+    int16_t ddF_y = -2 * r;
+    int16_t x = 0;
+    int16_t y = r;
+    int16_t px = x;
+    int16_t py = y;
+
+    while (x < y)
+    {
+        if (f >= 0)
+        {
+            y--;
+            ddF_y += 2;
+            f += ddF_y;
+        }
+
+        x++;
+        ddF_x += 2;
+        f += ddF_x;
+
+        // These checks avoid double-drawing certain lines, important
+        // for the SSD1306 library which has an INVERT drawing mode.
+        if (x < (y + 1))
+        {
+            _draw_vspan(h, x0 + x, y0 - y, 2 * y, color);
+            _draw_vspan(h, x0 - x, y0 - y, 2 * y, color);
+        }
+
+        if (y != py)
+        {
+            _draw_vspan(h, x0 + py, y0 - px, 2 * px, color);
+            _draw_vspan(h, x0 - py, y0 - px, 2 * px, color);
+
+            py = y;
+        }
+
+        px = x;
+    }
+}
+
+/*!
+    @brief    Draw a rounded rectangle.
+    @param    h      The screen handle
+    @param    x0     Upper left x-coordinate
+    @param    x1     Lower right x-coordinate
+    @param    y0     Upper left y-coordinate
+    @param    y1     Lower right y-coordinate
+    @param    color  Black(true)/white(false)
+    @param    fill   If true also fill the rectangle with the specified color
+*/
+void SSD1306_draw_round_rect_h(ssd_1306_t *h, uint8_t x0, uint8_t x1, uint8_t y0, uint8_t y1, bool color, bool fill)
+{
+    /* Just in case mistakes were made */
+    if(x0 > x1) SWAP_VAR(x0, x1);
+    if(y0 > y1) SWAP_VAR(y0, y1);
+
+    /* As long as it is a valid rectangle */
+    if((x1 - x0) > 4 && (y1 - y0) > 4)
+    {
+        if(fill)
+        {
+            /* Rows with the rounded corners left out, and a normal filled rectangle in between */
+            SSD1306_draw_hline_h(h, x0 + 2, y0, x1 - x0 - 3, color);
+            SSD1306_draw_hline_h(h, x0 + 1, y0 + 1, x1 - x0 - 1, color);
+            SSD1306_draw_rectangle_h(h, x0, x1, y0 + 2, y1 - 2, color, true);
+            SSD1306_draw_hline_h(h, x0 + 1, y1 - 1, x1 - x0 - 1, color);
+            SSD1306_draw_hline_h(h, x0 + 2, y1, x1 - x0 - 3, color);
+        }
+        else
+        {
+            SSD1306_set_pixel_h(h, x0 + 1, y0 + 1, color);
+            SSD1306_set_pixel_h(h, x1 - 1, y0 + 1, color);
+            SSD1306_set_pixel_h(h, x0 + 1, y1 - 1, color);
+            SSD1306_set_pixel_h(h, x1 - 1, y1 - 1, color);
+            SSD1306_draw_hline_h(h, x0 + 2, y0, x1 - x0 - 3, color);
+            SSD1306_draw_hline_h(h, x0 + 2, y1, x1 - x0 - 3, color);
+            SSD1306_draw_vline_h(h, x0, y0 + 2, y1 - y0 - 3, color);
+            SSD1306_draw_vline_h(h, x1, y0 + 2, y1 - y0 - 3, color);
+        }
+    }
+}
+
+/**********************************************************/
+/************************ BITMAPS *************************/
+/**********************************************************/
+
+/*!
+    @brief    Returns the mask of the rows of a page that are inside a vertical run.
+    @param    page   The page (bank) on the screen
+    @param    y0     Upper y-coordinate of the run
+    @param    y1     Lower y-coordinate of the run (exclusive)
+    @return          The rows as a bank mask, 0 if none.
+*/
+static uint8_t _page_rows_mask(uint8_t page, uint8_t y0, uint8_t y1)
+{
+    uint8_t top = page * LCDBANK_SZ;
+
+    if(y1 <= top || y0 >= top + LCDBANK_SZ) return 0;
+
+    uint8_t mask = 0xff;
+    if(y0 > top) mask &= MSB2LSB_MASK(top + LCDBANK_SZ - y0);
+    if(y1 < top + LCDBANK_SZ) mask &= LSB2MSB_MASK(y1 - top);
+
+    return mask;
+}
+
+/*!
+    @brief    Draws a bitmap on the screen, a bank at a time. Every bank of the bitmap is shifted into place and
+    merged into the (up to) two pages it covers, with the rows outside the drawable ones masked.
+    Banks that land aligned on a page are copied as they are (SSD1306_ROP_COPY).
+    @param    h         The screen handle
+    @param    bitmap    The bitmap array
+    @param    x0        Leftmost x-coordinate
+    @param    y0        Leftmost y-coordinate
+    @param    draw_x    Draw length on the x-axis
+    @param    draw_y    Draw length on the y-axis
+    @param    len_x     The width of the bitmap
+*/
+static void _draw_bitmap(ssd_1306_t *h, const uint8_t *bitmap, uint8_t x0, uint8_t y0, uint8_t draw_x, uint8_t draw_y, uint8_t len_x)
+{
+    /* Only the rows of the page being rendered in strip mode */
+    uint8_t y = y0, len = draw_y;
+    if(!draw_x || !_clip_rows(h, &y, &len)) return;
+    MARK_DIRTY(h, x0, x0 + draw_x - 1, y, y + len - 1);
+
+    const uint8_t *sel = ROP_SEL(h);
+    const uint8_t y_end = y + len;
+    const uint8_t shift = y0 & 0x07;
+    const uint8_t page0 = y0 >> 3;
+
+    /* The banks of the bitmap that reach the drawable rows */
+    uint8_t bank = (y >> 3) - page0;
+    uint8_t last = ((y_end - 1) >> 3) - page0;
+    if(bank && shift) bank--;
+    if(last >= ((draw_y + 7) >> 3)) last = ((draw_y + 7) >> 3) - 1;
+
+    for(; bank <= last; bank++)
+    {
+        const uint8_t *src = bitmap + (uint16_t)bank * len_x;
+        uint8_t page = page0 + bank;
+
+        /* The bank's rows on its first page, and on the next one when shifted */
+        uint8_t mask_lo = _page_rows_mask(page, y, y_end) & (0xff << shift);
+        uint8_t mask_hi = shift ? (_page_rows_mask(page + 1, y, y_end) & LSB2MSB_MASK(shift)) : 0;
+
+        if(mask_lo == 0xff && h->rop == SSD1306_ROP_COPY)
+        {
+            memcpy(h->buffer + COORDS2BUFF_POS(h, x0, page << 3), src, draw_x);
+        }
+        else if(mask_lo)
+        {
+            uint8_t *dst = h->buffer + COORDS2BUFF_POS(h, x0, page << 3);
+            ASSERT_DEBUG((dst - h->buffer) + draw_x > LCDBUFFER_SZ, "Error at _draw_bitmap\n");
+
+            for(uint8_t i = 0; i < draw_x; i++) dst[i] = _rop_merge(sel, dst[i], mask_lo, src[i] << shift);
+        }
+
+        if(mask_hi)
+        {
+            uint8_t *dst = h->buffer + COORDS2BUFF_POS(h, x0, (page + 1) << 3);
+            ASSERT_DEBUG((dst - h->buffer) + draw_x > LCDBUFFER_SZ, "Error at _draw_bitmap\n");
+
+            for(uint8_t i = 0; i < draw_x; i++) dst[i] = _rop_merge(sel, dst[i], mask_hi, src[i] >> (8 - shift));
+        }
+    }
+}
+
+/*!
+    @brief    Draws a bitmap scaled upwards with nearest neighbor, by any factor in fixed-point.
+    Every output page is built a byte per column: the source rows it needs fit in one byte (the factor is 1 or more),
+    which is expanded to the output rows through two nibble tables. Columns that repeat a source column reuse its byte.
+    @param    h         The screen handle
+    @param    bitmap    The bitmap array
+    @param    x0        Leftmost x-coordinate
+    @param    y0        Leftmost y-coordinate
+    @param    len_x     The width of the bitmap
+    @param    len_y     The height of the bitmap
+    @param    scale     The scale factor in Q8.8 (0x0100 is x1), 1 or more
+*/
+static void _draw_bitmap_scaled(ssd_1306_t *h, const uint8_t *bitmap, uint8_t x0, uint8_t y0, uint8_t len_x, uint8_t len_y, uint16_t scale)
+{
+    /* Output size, cut to the screen (and the page being rendered) */
+    uint16_t out_x = ((uint32_t)len_x * scale) >> 8;
+    uint16_t out_y = ((uint32_t)len_y * scale) >> 8;
+    if(out_x > (uint16_t)(LCDWIDTH - x0)) out_x = LCDWIDTH - x0;
+    if(out_y > (uint16_t)(LCDHEIGHT - y0)) out_y = LCDHEIGHT - y0;
+
+    uint8_t y = y0, len = out_y;
+    if(!out_x || !_clip_rows(h, &y, &len)) return;
+    MARK_DIRTY(h, x0, x0 + out_x - 1, y, y + len - 1);
+
+    const uint8_t *sel = ROP_SEL(h);
+    const uint8_t banks = (len_y + 7) >> 3;
+    const uint8_t y_end = y + len;
+
+    for(uint8_t page = y >> 3; page <= ((y_end - 1) >> 3); page++)
+    {
+        uint8_t mask = _page_rows_mask(page, y, y_end);
+        uint8_t row = (page << 3) > y ? (page << 3) : y;
+        uint8_t *dst = h->buffer + COORDS2BUFF_POS(h, x0, page << 3);
+
+        /* Source row of the first output row, and of the rest relative to it */
+        uint8_t sy0 = ((uint16_t)(row - y0) << 8) / scale;
+        uint8_t rows_of[8] = {0};
+
+        for(; row < y_end && (row >> 3) == page; row++)
+        {
+            uint8_t sy = ((uint16_t)(row - y0) << 8) / scale;
+            rows_of[sy - sy0] |= 1 << (row & 0x07);
+        }
+
+        /* Output bits of every combination of 4 source rows */
+        uint8_t lo[16], hi[16];
+        lo[0] = hi[0] = 0;
+
+        for(uint8_t v = 1; v < 16; v++)
+        {
+            uint8_t low = __builtin_ctz(v);
+            lo[v] = lo[v & (v - 1)] | rows_of[low];
+            hi[v] = hi[v & (v - 1)] | rows_of[low + 4];
+        }
+
+        const uint8_t *src = bitmap + (uint16_t)(sy0 >> 3) * len_x;
+        const bool next_bank = ((sy0 >> 3) + 1) < banks;
+        const bool copy = (mask == 0xff) && (h->rop == SSD1306_ROP_COPY);
+        const uint8_t shift = sy0 & 0x07;
+        uint32_t frac = 0;
+        uint8_t sx = 0, out = 0;
+        bool fresh = false;
+
+        for(uint8_t i = 0; i < out_x; i++)
+        {
+            if(!fresh)
+            {
+                uint16_t window = src[sx] | (next_bank ? (src[sx + len_x] << 8) : 0);
+                uint8_t v = window >> shift;
+
+                out = lo[v & 0x0f] | hi[v >> 4];
+                fresh = true;
+            }
+
+            dst[i] = copy ? out : _rop_merge(sel, dst[i], mask, out);
+
+            /* Next source column - At most one step, since the factor is 1 or more */
+            frac += 0x0100;
+            if(frac >= scale)
+            {
+                frac -= scale;
+                sx++;
+                fresh = false;
+            }
+        }
+    }
+}
+
+/*!
+    @brief    Draws a bitmap on the screen and scale upwards by the argument scale.
+    The scaling is performed by using the nearest neighbor interpolation method.
+    If scale is set to 1, then simply draw the bitmap as is.
+    @param    h         The screen handle
+    @param    bitmap    The bitmap array
+    @param    x0        Leftmost x-coordinate
+    @param    y0        Leftmost y-coordinate
+    @param    len_x     The width of the bitmap
+    @param    len_y     The height of the bitmap
+    @param    scale     The scale factor, 1 or more
+*/
+void SSD1306_draw_bitmap_h(ssd_1306_t *h, const uint8_t *bitmap, uint8_t x0, uint8_t y0, uint8_t len_x, uint8_t len_y, uint8_t scale)
+{
+    /* Illegal format of the bitmap or initial position */
+    if(x0 >= LCDWIDTH || y0 >= LCDHEIGHT || !scale) return;
+
+    if(scale > 1)
+    {
+        _draw_bitmap_scaled(h, bitmap, x0, y0, len_x, len_y, (uint16_t)scale << 8);
+        return;
+    }
+
+    /* No scaling - Adjust the draw lengths, the blitter clips to the page being rendered itself */
+    uint8_t draw_y = len_y, draw_x = len_x;
+    if(((uint16_t)y0 + len_y) > LCDHEIGHT) draw_y = LCDHEIGHT - y0;
+    if(((uint16_t)x0 + len_x) > LCDWIDTH) draw_x = LCDWIDTH - x0;
+
+    _draw_bitmap(h, bitmap, x0, y0, draw_x, draw_y, len_x);
+}
+
+/*!
+    @brief    Draws a bitmap on the screen scaled upwards by a fractional factor (such as x1.5 or x2.5),
+    with the nearest neighbor interpolation method.
+    @param    h         The screen handle
+    @param    bitmap    The bitmap array
+    @param    x0        Leftmost x-coordinate
+    @param    y0        Leftmost y-coordinate
+    @param    len_x     The width of the bitmap
+    @param    len_y     The height of the bitmap
+    @param    scale     The scale factor in Q8.8, 1.0 or more - See SSD1306_SCALE_Q8()
+*/
+void SSD1306_draw_bitmap_q8_h(ssd_1306_t *h, const uint8_t *bitmap, uint8_t x0, uint8_t y0, uint8_t len_x, uint8_t len_y, uint16_t scale)
+{
+    if(x0 >= LCDWIDTH || y0 >= LCDHEIGHT || scale < 0x0100) return;
+
+    if(scale == 0x0100)
+        SSD1306_draw_bitmap_h(h, bitmap, x0, y0, len_x, len_y, 1);
+    else
+        _draw_bitmap_scaled(h, bitmap, x0, y0, len_x, len_y, scale);
+}
+
+/*!
+    @brief    Draws a bitmap on the screen.
+    Optimized version that draws bitmaps with height a multiple of 8
+    and that start from a multiple of 8 y-coordinate.
+    Basically we draw from the start of a bank continuously, every bank is copied as it is.
+    SSD1306_draw_bitmap() with no scaling goes through the same path for such bitmaps.
+
+    @param    h         The screen handle
+    @param    bitmap    The bitmap array
+    @param    x0        Leftmost x-coordinate
+    @param    y0        Leftmost y-coordinate
+    @param    len_x     The width of the bitmap
+    @param    len_y     The height of the bitmap
+*/
+void SSD1306_draw_bitmap_opt8_h(ssd_1306_t *h, const uint8_t *bitmap, uint8_t x0, uint8_t y0, uint8_t len_x, uint8_t len_y)
+{
+    /* Illegal format of the bitmap or initial position or height */
+    if(x0 >= LCDWIDTH || y0 >= LCDHEIGHT) return;
+    if((y0 & 0x07) || (len_y & 0x07)) return;
+
+    /* Fix drawing length - The banks stay aligned, so they are copied as they are */
+    uint8_t draw_x = len_x, draw_y = len_y;
+    if(((uint16_t)x0 + len_x) > LCDWIDTH) draw_x = LCDWIDTH - x0;
+    if(((uint16_t)y0 + len_y) > LCDHEIGHT) draw_y = LCDHEIGHT - y0;
+
+    _draw_bitmap(h, bitmap, x0, y0, draw_x, draw_y, len_x);
+}
+
+/* Control bytes of the compressed bitmaps */
+#define RLE_REPEAT          0x80    /* A repeated byte, otherwise literal bytes */
+#define RLE_REPEAT_MIN      2       /* Bytes of the shortest repeat */
+
+/* The part of the buffer a bank of a compressed bitmap is decoded to */
+typedef struct
+{
+    uint8_t *lo, *hi;       /* Columns on the bank's first page, and on the next one when shifted */
+    uint8_t mask_lo;        /* Their drawable rows, 0 if none */
+    uint8_t mask_hi;
+    uint8_t shift;
+    bool copy;              /* Whole bytes drawn as they are */
+}_rle_bank_t;
+
+/*!
+    @brief    Sets up the decoding of a bank of a compressed bitmap, like _draw_bitmap() does for a bank.
+    @param    h        The screen handle
+    @param    b        The bank to set up
+    @param    x0       Leftmost x-coordinate
+    @param    page     The bank's first page
+    @param    y        Upper drawable y-coordinate
+    @param    y_end    Lower drawable y-coordinate (excluded)
+*/
+static void _rle_bank(ssd_1306_t *h, _rle_bank_t *b, uint8_t x0, uint8_t page, uint8_t y, uint8_t y_end)
+{
+    b->mask_lo = _page_rows_mask(page, y, y_end) & (0xff << b->shift);
+    b->mask_hi = b->shift ? (_page_rows_mask(page + 1, y, y_end) & LSB2MSB_MASK(b->shift)) : 0;
+    b->copy = (b->mask_lo == 0xff) && (h->rop == SSD1306_ROP_COPY);
+
+    /* Only pages that are drawn are in the buffer (in strip mode) */
+    if(b->mask_lo) b->lo = h->buffer + COORDS2BUFF_POS(h, x0, page << 3);
+    if(b->mask_hi) b->hi = h->buffer + COORDS2BUFF_POS(h, x0, (page + 1) << 3);
+}
+
+/*!
+    @brief    Merges a run of the same byte into columns of a page, with the raster operation.
+    Runs that change nothing (blank ones in ROP_OR or XOR) are skipped.
+    @param    h       The screen handle
+    @param    dst     The first column
+    @param    len     Number of columns
+    @param    mask    The drawable rows
+    @param    src     The byte, at its place in the page
+*/
+static void _rle_fill(ssd_1306_t *h, uint8_t *dst, uint8_t len, uint8_t mask, uint8_t src)
+{
+    const uint8_t toggle = _rop_merge(ROP_SEL(h), 0, mask, src);
+    const uint8_t keep = _rop_merge(ROP_SEL(h), 0xff, mask, src) ^ toggle;
+
+    if(keep == 0xff && !toggle) return;
+
+    if(!keep)
+    {
+        memset(dst, toggle, len);
+        return;
+    }
+
+    for(uint8_t i = 0; i < len; i++) dst[i] = (dst[i] & keep) ^ toggle;
+}
+
+/*!
+    @brief    Draws decoded bytes of a compressed bitmap - A run of the same byte, or literal bytes.
+    @param    h         The screen handle
+    @param    b         The bank of the bytes
+    @param    col       Their first column in the bitmap
+    @param    len       Number of bytes, all in the bank
+    @param    draw_x    Columns of the bitmap on the screen
+    @param    src       The literal bytes, NULL for a run
+    @param    value     The byte of the run
+*/
+static void _rle_span(ssd_1306_t *h, const _rle_bank_t *b, uint8_t col, uint8_t len, uint8_t draw_x, const uint8_t *src, uint8_t value)
+{
+    /* Columns past the right edge of the screen */
+    if(col >= draw_x) return;
+    if(len > draw_x - col) len = draw_x - col;
+
+    if(b->copy)
+    {
+        if(src)
+            memcpy(b->lo + col, src, len);
+        else
+            memset(b->lo + col, value, len);
+        return;
+    }
+
+    const uint8_t *sel = ROP_SEL(h);
+
+    if(!src)
+    {
+        if(b->mask_lo) _rle_fill(h, b->lo + col, len, b->mask_lo, value << b->shift);
+        if(b->mask_hi) _rle_fill(h, b->hi + col, len, b->mask_hi, value >> (8 - b->shift));
+        return;
+    }
+
+    if(b->mask_lo)
+    {
+        uint8_t *dst = b->lo + col;
+        for(uint8_t i = 0; i < len; i++) dst[i] = _rop_merge(sel, dst[i], b->mask_lo, src[i] << b->shift);
+    }
+
+    if(b->mask_hi)
+    {
+        uint8_t *dst = b->hi + col;
+        for(uint8_t i = 0; i < len; i++) dst[i] = _rop_merge(sel, dst[i], b->mask_hi, src[i] >> (8 - b->shift));
+    }
+}
+
+/*!
+    @brief    Decodes a compressed bitmap into consecutive bytes of the buffer.
+    @param    dst     The first byte
+    @param    rle     The compressed bitmap
+    @param    skip    Decoded bytes left out first
+    @param    len     Decoded bytes written
+*/
+static void _rle_decode(uint8_t *dst, const uint8_t *rle, uint16_t skip, uint16_t len)
+{
+    while(len)
+    {
+        const uint8_t c = *rle++;
+        const bool run = c & RLE_REPEAT;
+        const uint8_t *src = rle;
+        uint16_t n = run ? (c - RLE_REPEAT + RLE_REPEAT_MIN) : (c + 1);
+        rle += run ? 1 : n;
+
+        /* Bytes before the drawn ones */
+        if(skip)
+        {
+            if(n <= skip)
+            {
+                skip -= n;
+                continue;
+            }
+
+            n -= skip;
+            if(!run) src += skip;
+            skip = 0;
+        }
+
+        if(n > len) n = len;
+
+        if(run)
+            memset(dst, *src, n);
+        else
+            memcpy(dst, src, n);
+
+        dst += n;
+        len -= n;
+    }
+}
+
+/*!
+    @brief    Draws a compressed bitmap on the screen, decoded straight into the buffer.
+    The bitmap is the one of SSD1306_draw_bitmap(), its bytes bank by bank compressed in packets that start with a
+    control byte c - Below 0x80, c + 1 literal bytes follow (1 to 128). Otherwise the next byte is repeated
+    c - 0x80 + 2 times (2 to 129). Runs go on across the banks. tools/ssd1306_assets.py --rle makes such bitmaps.
+    On a y-coordinate that is a multiple of 8 and with SSD1306_ROP_COPY, runs are set and literals copied as they are,
+    so blank areas cost about 2 bytes of flash and a memset() per 129 columns. The banks past the drawable rows
+    are not decoded.
+
+    @param    h         The screen handle
+    @param    rle       The compressed bitmap
+    @param    x0        Leftmost x-coordinate
+    @param    y0        Upper y-coordinate
+    @param    len_x     The width of the bitmap
+    @param    len_y     The height of the bitmap
+*/
+void SSD1306_draw_bitmap_rle_h(ssd_1306_t *h, const uint8_t *rle, uint8_t x0, uint8_t y0, uint8_t len_x, uint8_t len_y)
+{
+    /* Illegal format of the bitmap or initial position */
+    if(x0 >= LCDWIDTH || y0 >= LCDHEIGHT || !len_x || !len_y) return;
+
+    uint8_t draw_x = len_x, draw_y = len_y;
+    if(((uint16_t)x0 + len_x) > LCDWIDTH) draw_x = LCDWIDTH - x0;
+    if(((uint16_t)y0 + len_y) > LCDHEIGHT) draw_y = LCDHEIGHT - y0;
+
+    /* Only the rows of the page being rendered in strip mode */
+    uint8_t y = y0, len = draw_y;
+    if(!_clip_rows(h, &y, &len)) return;
+    MARK_DIRTY(h, x0, x0 + draw_x - 1, y, y + len - 1);
+
+    const uint8_t y_end = y + len;
+    const uint8_t page0 = y0 >> 3;
+
+    /* Whole pages of the screen copied as they are (splash screens) - They follow each other in the buffer,
+       so the bitmap is decoded in one go */
+    if(len_x == LCDWIDTH && !x0 && !((y0 | y_end) & 0x07) && h->rop == SSD1306_ROP_COPY)
+    {
+        ASSERT_DEBUG(COORDS2BUFF_POS(h, 0, y_end - 1) >= LCDBUFFER_SZ, "Error at SSD1306_draw_bitmap_rle_h\n");
+
+        _rle_decode(h->buffer + COORDS2BUFF_POS(h, 0, y), rle, ((y - y0) >> 3) * LCDWIDTH, (len >> 3) * LCDWIDTH);
+        return;
+    }
+
+    uint8_t last = ((y_end - 1) >> 3) - page0;
+    if(last >= ((draw_y + 7) >> 3)) last = ((draw_y + 7) >> 3) - 1;
+
+    _rle_bank_t b = {.shift = y0 & 0x07};
+    uint8_t bank = 0, col = 0;
+    _rle_bank(h, &b, x0, page0, y, y_end);
+
+    for(;;)
+    {
+        /* The next packet */
+        const uint8_t c = *rle++;
+        const bool run = c & RLE_REPEAT;
+        const uint8_t *src = run ? NULL : rle;
+        const uint8_t value = *rle;
+        uint8_t n = run ? (c - RLE_REPEAT + RLE_REPEAT_MIN) : (c + 1);
+        rle += run ? 1 : n;
+
+        /* Split at the ends of the banks */
+        while(n)
+        {
+            uint8_t span = len_x - col;
+            if(span > n) span = n;
+
+            if(b.copy && ((uint16_t)col + span) <= draw_x)
+            {
+                /* Whole bytes on the screen - Set or copied as they are */
+                if(src)
+                    memcpy(b.lo + col, src, span);
+                else
+                    memset(b.lo + col, value, span);
+            }
+            else if(b.mask_lo | b.mask_hi)
+            {
+                _rle_span(h, &b, col, span, draw_x, src, value);
+            }
+
+            n -= span;
+            col += span;
+            if(src) src += span;
+
+            if(col == len_x)
+            {
+                if(++bank > last) return;
+
+                col = 0;
+                _rle_bank(h, &b, x0, page0 + bank, y, y_end);
+            }
+        }
+    }
+}
+
+/**********************************************************/
+/************************ SPRITES *************************/
+/**********************************************************/
+
+/*!
+    @brief    Copies the pages under a sprite between the buffer and its save-under buffer.
+    @param    h          The screen handle
+    @param    sprite     The sprite
+    @param    restore    Back to the buffer(True) or from it(False)
+*/
+static void _sprite_save(ssd_1306_t *h, ssd_1306_sprite_t *sprite, bool restore)
+{
+    uint8_t *save = sprite->save;
+    uint16_t pos = COORDS2BUFF_POS(h, sprite->save_x, sprite->save_p0 << 3);
+
+    for(uint8_t p = sprite->save_p0; p <= sprite->save_p1; p++)
+    {
+        ASSERT_DEBUG((pos + sprite->save_w) > LCDBUFFER_SZ, "Error at _sprite_save %d\n", pos);
+
+        if(restore)
+            memcpy(h->buffer + pos, save, sprite->save_w);
+        else
+            memcpy(save, h->buffer + pos, sprite->save_w);
+
+        pos += LCDWIDTH;
+        save += sprite->save_w;
+    }
+
+    if(restore) MARK_DIRTY(h, sprite->save_x, sprite->save_x + sprite->save_w - 1, sprite->save_p0 << 3, (sprite->save_p1 << 3) + 7);
+}
+
+/*!
+    @brief    Saves the pages under a sprite and draws it on top of the stack of drawn sprites.
+    @param    h          The screen handle
+    @param    sprite     The sprite
+*/
+static void _sprite_draw(ssd_1306_t *h, ssd_1306_sprite_t *sprite)
+{
+    const uint8_t x = sprite->x, y = sprite->y, rop = h->rop;
+    uint8_t draw_x = sprite->len_x, draw_y = sprite->len_y;
+
+    /* Only the part inside the screen */
+    if(x >= LCDWIDTH || y >= LCDHEIGHT || !draw_x || !draw_y) return;
+    if(((uint16_t)x + draw_x) > LCDWIDTH) draw_x = LCDWIDTH - x;
+    if(((uint16_t)y + draw_y) > LCDHEIGHT) draw_y = LCDHEIGHT - y;
+
+    sprite->save_x = x;
+    sprite->save_w = draw_x;
+    sprite->save_p0 = y >> 3;
+    sprite->save_p1 = (y + draw_y - 1) >> 3;
+    _sprite_save(h, sprite, false);
+
+    /* Clear the opaque pixels, then set the black ones */
+    if(sprite->mask)
+    {
+        h->rop = SSD1306_ROP_AND_NOT;
+        _draw_bitmap(h, sprite->mask, x, y, draw_x, draw_y, sprite->len_x);
+        h->rop = SSD1306_ROP_OR;
+    }
+    else
+    {
+        h->rop = SSD1306_ROP_COPY;
+    }
+
+    _draw_bitmap(h, sprite->image, x, y, draw_x, draw_y, sprite->len_x);
+    h->rop = rop;
+
+    sprite->drawn = true;
+    sprite->under = h->sprite_top;
+    h->sprite_top = sprite;
+}
+
+/*!
+    @brief    Adds a sprite to the screen, in its z-order (after the sprites with the same z).
+    It is drawn by the next call of SSD1306_sprites_draw(), if visible.
+    @param    h          The screen handle
+    @param    sprite     The sprite, with the image, size and save-under buffer set
+    @return              Success(True) or Failure(False) if the sprite is incomplete or already added.
+*/
+bool SSD1306_sprite_add_h(ssd_1306_t *h, ssd_1306_sprite_t *sprite)
+{
+    if(!sprite || !sprite->image || !sprite->save) return false;
+
+    ssd_1306_sprite_t **link = &h->sprites;
+
+    for(ssd_1306_sprite_t *it = h->sprites; it; it = it->next)
+    {
+        if(it == sprite) return false;
+        if(it->z <= sprite->z) link = &it->next;
+    }
+
+    sprite->drawn = false;
+    sprite->next = *link;
+    *link = sprite;
+
+    return true;
+}
+
+/*!
+    @brief    Removes a sprite from the screen. If it is on the buffer, all the sprites are erased,
+    the rest are drawn back by the next SSD1306_sprites_draw().
+    @param    h          The screen handle
+    @param    sprite     The sprite
+*/
+void SSD1306_sprite_remove_h(ssd_1306_t *h, ssd_1306_sprite_t *sprite)
+{
+    if(!sprite) return;
+    if(sprite->drawn) SSD1306_sprites_erase_h(h);
+
+    for(ssd_1306_sprite_t **link = &h->sprites; *link; link = &(*link)->next)
+    {
+        if(*link == sprite)
+        {
+            *link = sprite->next;
+            sprite->next = NULL;
+            break;
+        }
+    }
+}
+
+/*!
+    @brief    Erases the sprites from the buffer, restoring the pixels saved under them.
+    Draw changes of the background between this and SSD1306_sprites_draw(), otherwise they are lost
+    where sprites cover them.
+    @param    h     The screen handle
+*/
+void SSD1306_sprites_erase_h(ssd_1306_t *h)
+{
+    /* Reverse order of drawing - Sprites drawn over others saved them too */
+    for(ssd_1306_sprite_t *it = h->sprite_top; it; it = it->under)
+    {
+        _sprite_save(h, it, true);
+        it->drawn = false;
+    }
+
+    h->sprite_top = NULL;
+}
+
+/*!
+    @brief    Draws the visible sprites at their current position, in z-order. The ones still on the buffer
+    are erased first, so moving sprites only touches the pages they cover (marked dirty for partial refreshes).
+    Not available while rendering strips, the sprites need the whole buffer.
+    @param    h     The screen handle
+*/
+void SSD1306_sprites_draw_h(ssd_1306_t *h)
+{
+    if(h->sprite_top) SSD1306_sprites_erase_h(h);
+
+    for(ssd_1306_sprite_t *it = h->sprites; it; it = it->next)
+    {
+        if(it->visible) _sprite_draw(h, it);
+    }
+}
+
+/**********************************************************/
+/************************* TEXT ***************************/
+/**********************************************************/
+
+/*!
+    @brief    Unpacks a glyph of the small font, 3 bytes to a 6-bit byte per column.
+    @param    packed    The 3 bytes of the glyph
+    @param    glyph     The 4 columns of the glyph
+*/
+static inline void _small_glyph_unpack(const uint8_t *packed, uint8_t *glyph)
+{
+    uint8_t b0 = packed[0], b1 = packed[1], b2 = packed[2];
+
+    glyph[0] = b0 >> 2;
+    glyph[1] = ((b0 & 0x03) << 4) | (b1 >> 4);
+    glyph[2] = ((b1 & 0x0f) << 2) | (b2 >> 6);
+    glyph[3] = b2 & 0x3f;
+}
+
+#ifdef SSD1306_GLYPH_CACHE
+/*!
+    @brief    Gets a glyph of the small font from the cache, already shifted and inverted.
+    The glyphs of a variant are all decoded the first time it is used.
+    @param    index     The glyph (character - 0x20), less than SMALL_FONT_GLYPHS
+    @param    shift     The alignment shift, 0 to 2
+    @param    invert    Inverted (true) or not (false)
+    @return             The 4 columns of the glyph
+*/
+static const uint8_t *_small_glyph_cached(uint8_t index, uint8_t shift, bool invert)
+{
+    uint8_t (*glyphs)[4] = _glyph_cache[shift][invert];
+    uint8_t variant = 1 << (shift * 2 + invert);
+
+    if(!(_glyph_cache_built & variant))
+    {
+        uint8_t flip = invert ? 0xff : 0x00;
+
+        for(uint8_t i = 0; i < SMALL_FONT_GLYPHS; i++)
+        {
+            _small_glyph_unpack(small_font + i * 3, glyphs[i]);
+            for(uint8_t j = 0; j < 4; j++) glyphs[i][j] = (uint8_t)(glyphs[i][j] << shift) ^ flip;
+        }
+
+        _glyph_cache_built |= variant;
+    }
+
+    return glyphs[index];
+}
+#endif
+
+/* Characters of a line gathered before they are drawn together */
+#define TEXT_RUN_SZ         32
+
+/* A font as drawn by the text routines - A proportional font, or one of the fixed-width ones */
+typedef struct
+{
+    const ssd_1306_font_t *prop;    /* The proportional font, NULL for a fixed-width one */
+    const uint8_t *data;            /* The glyphs of the fixed-width font, and their size */
+    uint8_t option;
+    uint8_t width;
+    uint8_t byte_num;
+    uint8_t last;                   /* Last character of the fixed-width font */
+    uint8_t height;                 /* Height of the glyphs in pixels */
+}_text_font_t;
+
+/* A character as drawn by the text routines */
+typedef struct
+{
+    uint16_t glyph;     /* Index of the glyph in the font */
+    uint8_t width;      /* Columns of its glyph */
+    uint8_t advance;    /* Columns to the next glyph, spacing and kerning included */
+}_text_glyph_t;
+
+/*!
+    @brief    Gets the layout of a fixed-width font.
+    @param    option    The options (font and potential centering)
+    @param    f         The font to set up
+    @return             True if the option holds a font, false otherwise.
+*/
+static bool _fixed_font(uint8_t option, _text_font_t *f)
+{
+    f->prop = NULL;
+    f->option = option & FONT_MASK;
+
+    switch(f->option)
+    {
+        case LARGE_FONT:    f->data = large_font;  f->width = 6; f->height = 8; f->byte_num = 6; f->last = 0x7f; return true;
+        case MEDIUM_FONT:   f->data = medium_font; f->width = 5; f->height = 7; f->byte_num = 5; f->last = 0x7f; return true;
+        case SMALL_FONT:    f->data = small_font;  f->width = 4; f->height = 6; f->byte_num = 3; f->last = 0x7e; return true;
+        default:            return false; /* Illegal option */
+    }
+}
+
+/*!
+    @brief    Decodes a multi-byte character of a UTF-8 string, kept apart so that the ASCII path stays small.
+    Characters beyond the 16-bit code points, and malformed bytes (taken one at a time), are decoded as U+FFFD.
+    @param    s       The string, at a byte of 0x80 or more
+    @param    code    The code point of the character
+    @return           The number of bytes of the character
+*/
+static uint8_t _utf8_decode_multi(const uint8_t *s, uint16_t *code)
+{
+    /* Continuation bytes are checked in order, so a sequence cut by the end of the string is malformed */
+    if((s[0] & 0xe0) == 0xc0 && s[0] >= 0xc2 && (s[1] & 0xc0) == 0x80)
+    {
+        *code = ((uint16_t)(s[0] & 0x1f) << 6) | (s[1] & 0x3f);
+        return 2;
+    }
+
+    if((s[0] & 0xf0) == 0xe0 && (s[1] & 0xc0) == 0x80 && (s[2] & 0xc0) == 0x80)
+    {
+        *code = ((uint16_t)(s[0] & 0x0f) << 12) | ((uint16_t)(s[1] & 0x3f) << 6) | (s[2] & 0x3f);
+        if(*code >= 0x0800) return 3;
+    }
+
+    *code = 0xfffd;
+
+    if((s[0] & 0xf8) == 0xf0 && (s[1] & 0xc0) == 0x80 && (s[2] & 0xc0) == 0x80 && (s[3] & 0xc0) == 0x80) return 4;
+
+    return 1;
+}
+
+/*!
+    @brief    Decodes the character at the start of a UTF-8 string.
+    @param    str     The string, not at its end
+    @param    code    The code point of the character
+    @return           The number of bytes of the character
+*/
+static inline uint8_t _utf8_decode(const char *str, uint16_t *code)
+{
+    const uint8_t *s = (const uint8_t *)str;
+
+    if(s[0] < 0x80)
+    {
+        *code = s[0];
+        return 1;
+    }
+
+    return _utf8_decode_multi(s, code);
+}
+
+/*!
+    @brief    Looks up the glyph of a character in the extra ranges of a proportional font, with a binary search.
+    @param    font      The proportional font
+    @param    code      The code point of the character, outside the main range
+    @param    glyph     Index of the glyph in the font
+    @return             True if the font has the character, false otherwise.
+*/
+static bool _font_range_glyph(const ssd_1306_font_t *font, uint16_t code, uint16_t *glyph)
+{
+    uint8_t low = 0, high = font->nb_ranges;
+
+    while(low < high)
+    {
+        uint8_t mid = (low + high) >> 1;
+        const ssd_1306_range_t *range = &font->ranges[mid];
+
+        if(code < range->first) high = mid;
+        else if(code > range->last) low = mid + 1;
+        else
+        {
+            *glyph = range->glyph + (code - range->first);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*!
+    @brief    Looks up the glyph of a character in a proportional font. The main range of the font is indexed
+    straight, the extra ranges are searched.
+    @param    font      The proportional font
+    @param    code      The code point of the character
+    @param    glyph     Index of the glyph in the font
+    @return             True if the font has the character, false otherwise.
+*/
+static inline bool _font_glyph(const ssd_1306_font_t *font, uint16_t code, uint16_t *glyph)
+{
+    if(code >= font->first && code <= font->last)
+    {
+        *glyph = code - font->first;
+        return true;
+    }
+
+    return font->nb_ranges && _font_range_glyph(font, code, glyph);
+}
+
+/*!
+    @brief    Looks up the kerning of a pair of characters, with a binary search of the font's pairs.
+    @param    font      The proportional font
+    @param    first     The left character
+    @param    second    The right character
+    @return             Columns added to the spacing of the font, 0 if the pair has no kerning.
+*/
+static int8_t _kerning(const ssd_1306_font_t *font, uint8_t first, uint8_t second)
+{
+    const uint16_t key = ((uint16_t)first << 8) | second;
+    uint16_t low = 0, high = font->nb_kerning;
+
+    while(low < high)
+    {
+        uint16_t mid = (low + high) >> 1;
+        uint16_t pair = ((uint16_t)font->kerning[mid].first << 8) | font->kerning[mid].second;
+
+        if(pair == key) return font->kerning[mid].adjust;
+
+        if(pair < key) low = mid + 1;
+        else high = mid;
+    }
+
+    return 0;
+}
+
+/*!
+    @brief    Gets the glyph of a character in a proportional font and the columns that it takes.
+    @param    font      The proportional font
+    @param    c         The character, followed by the next one for the kerning
+    @param    code      The code point of the character
+    @param    len       The number of bytes of the character
+    @param    g         The character's glyph
+    @return             True if the character is drawn, false otherwise.
+*/
+static bool _prop_glyph(const ssd_1306_font_t *font, const char *c, uint16_t code, uint8_t len, _text_glyph_t *g)
+{
+    g->width = g->advance = 0;
+    if(!code || !_font_glyph(font, code, &g->glyph)) return false;
+
+    g->width = font->glyphs[g->glyph].width;
+    if(!g->width) return false;
+
+    /* The glyphs may get closer, but never overlap - Pairs are kerned within the 8-bit characters */
+    int16_t gap = font->spacing;
+
+    if(font->nb_kerning && code <= 0xff && c[len])
+    {
+        uint16_t next;
+        _utf8_decode(c + len, &next);
+
+        if(next <= 0xff) gap += _kerning(font, code, next);
+    }
+
+    g->advance = g->width + (gap > 0 ? gap : 0);
+
+    return true;
+}
+
+/*!
+    @brief    Gets the glyph of a UTF-8 character and the columns that it takes.
+    The characters that are not drawn take no columns in a proportional font, and a whole glyph in a fixed-width one.
+    @param    f         The font
+    @param    c         The character, followed by the next one for the kerning
+    @param    g         The character's glyph
+    @param    len       The number of bytes of the character
+    @return             True if the character is drawn, false otherwise.
+*/
+static inline bool _text_glyph(const _text_font_t *f, const char *c, _text_glyph_t *g, uint8_t *len)
+{
+    uint16_t code;
+
+    /* Fixed-width fonts - An ASCII character is the index of its glyph */
+    if(!f->prop && (uint8_t)*c < 0x80)
+    {
+        *len = 1;
+        g->glyph = (uint8_t)*c - 0x20;
+        g->width = g->advance = f->width;
+
+        return (uint8_t)*c >= 0x20 && (uint8_t)*c <= f->last;
+    }
+
+    *len = _utf8_decode(c, &code);
+
+    if(f->prop) return _prop_glyph(f->prop, c, code, *len, g);
+
+    g->glyph = code - 0x20;
+    g->width = g->advance = f->width;
+
+    return code >= 0x20 && code <= f->last;
+}
+
+/*!
+    @brief    Gets the columns of a glyph, bank by bank.
+    @param    f         The font
+    @param    glyph     Index of the glyph, of a character that is drawn
+    @param    buffer    Space for a glyph that has to be decoded
+    @return             The columns of the glyph
+*/
+static inline const uint8_t *_text_glyph_cols(const _text_font_t *f, uint16_t glyph, uint8_t *buffer)
+{
+    if(f->prop) return f->prop->bitmap + f->prop->glyphs[glyph].offset;
+
+    if(f->option != SMALL_FONT) return f->data + glyph * f->byte_num;
+
+#ifdef SSD1306_GLYPH_CACHE
+    (void)buffer;
+    return _small_glyph_cached(glyph, 0, false);
+#else
+    /* Small font has to be decoded since the bytes are packed */
+    _small_glyph_unpack(f->data + glyph * f->byte_num, buffer);
+
+    return buffer;
+#endif
+}
+
+/*!
+    @brief    Draws a run of characters on one line.
+    The run is drawn a page at a time. The rows of the page that the glyph rows map to are the same for every
+    character, so they are worked out once per page: a shift into place, or the nibble tables of
+    _draw_bitmap_scaled() when scaled. Every glyph column is then merged straight into the page, followed by
+    the blank columns up to the next glyph.
+    @param    h         The screen handle
+    @param    f         The font
+    @param    run       The glyphs of the run
+    @param    nb        The number of glyphs
+    @param    x0        Leftmost x-coordinate of the run
+    @param    y0        Upper y-coordinate of the run
+    @param    scale     The scale factor in Q8.8, 1.0 or more
+    @param    invert    Flag to invert the text
+*/
+static void _print_run(ssd_1306_t *h, const _text_font_t *f, const _text_glyph_t *run, uint8_t nb, uint8_t x0, uint8_t y0,
+                       uint16_t scale, bool invert)
+{
+    const _text_font_t font = *f; /* A local copy, so that writes to the buffer cannot alias the font */
+    uint8_t buffer[4];
+
+    /* Glyph height on the screen */
+    uint16_t real_height = ((uint32_t)font.height * scale) >> 8;
+    if(real_height > (uint16_t)(LCDHEIGHT - y0)) real_height = LCDHEIGHT - y0;
+
+    /* Only the rows of the page being rendered in strip mode */
+    uint8_t y = y0, len = real_height;
+    if(!_clip_rows(h, &y, &len)) return;
+
+    /* The columns of the run, cut to the screen */
+    uint16_t x_end = x0;
+    for(uint8_t n = 0; n < nb; n++) x_end += ((uint32_t)run[n].advance * scale) >> 8;
+
+    if(x_end > LCDWIDTH) x_end = LCDWIDTH;
+    if(x_end <= x0) return;
+    MARK_DIRTY(h, x0, x_end - 1, y, y + len - 1);
+
+    const uint8_t *sel = ROP_SEL(h);
+    const uint8_t y_end = y + len;
+    const uint8_t banks = (font.height + 7) >> 3;
+    const uint16_t flip = invert ? 0xffff : 0x0000;
+
+    for(uint8_t page = y >> 3; page <= ((y_end - 1) >> 3); page++)
+    {
+        uint8_t mask = _page_rows_mask(page, y, y_end);
+        uint8_t row = (page << 3) > y ? (page << 3) : y;
+        uint8_t *dst = h->buffer + COORDS2BUFF_POS(h, 0, page << 3);
+        const bool copy = (mask == 0xff) && (h->rop == SSD1306_ROP_COPY);
+
+        /* Glyph row of the first row of the page - Read from a window of two banks */
+        const uint8_t sy0 = ((uint16_t)(row - y0) << 8) / scale;
+        const uint8_t bank = sy0 >> 3, shift = sy0 & 0x07, row_shift = row & 0x07;
+        const bool next_bank = (bank + 1) < banks;
+        uint8_t lo[16], hi[16], blank;
+
+        if(scale == 0x0100)
+        {
+            blank = (uint8_t)((flip >> shift) << row_shift);
+        }
+        else
+        {
+            uint8_t rows_of[8] = {0};
+
+            for(; row < y_end && (row >> 3) == page; row++)
+            {
+                uint8_t sy = ((uint16_t)(row - y0) << 8) / scale;
+                rows_of[sy - sy0] |= 1 << (row & 0x07);
+            }
+
+            lo[0] = hi[0] = 0;
+
+            for(uint8_t v = 1; v < 16; v++)
+            {
+                uint8_t low = __builtin_ctz(v);
+                lo[v] = lo[v & (v - 1)] | rows_of[low];
+                hi[v] = hi[v & (v - 1)] | rows_of[low + 4];
+            }
+
+            blank = invert ? (lo[0x0f] | hi[0x0f]) : 0x00;
+        }
+
+        /* Unscaled fixed-width glyphs - A bank high and as wide as their cell, merged straight from the font */
+        if(!font.prop && scale == 0x0100)
+        {
+            const uint8_t width = font.width;
+            uint8_t x = x0;
+
+            for(uint8_t n = 0; n < nb && x < LCDWIDTH; n++, x += width)
+            {
+                const uint8_t *src = _text_glyph_cols(&font, run[n].glyph, buffer);
+                const uint8_t out_x = (width > (LCDWIDTH - x)) ? (LCDWIDTH - x) : width;
+                uint8_t *col = dst + x;
+
+                for(uint8_t i = 0; i < out_x; i++)
+                {
+                    uint8_t out = (uint8_t)((uint8_t)(src[i] ^ flip) >> shift) << row_shift;
+
+                    col[i] = copy ? out : _rop_merge(sel, col[i], mask, out);
+                }
+            }
+            continue;
+        }
+
+        uint16_t x = x0;
+
+        uint16_t real_width = ((uint32_t)font.width * scale) >> 8, real_advance = real_width;
+
+        for(uint8_t n = 0; n < nb && x < LCDWIDTH; n++)
+        {
+            const uint8_t width = run[n].width;
+            const uint8_t *src = _text_glyph_cols(&font, run[n].glyph, buffer) + (uint16_t)bank * width;
+
+            if(font.prop)
+            {
+                real_width = ((uint32_t)width * scale) >> 8;
+                real_advance = ((uint32_t)run[n].advance * scale) >> 8;
+            }
+            uint8_t out_x = (real_width > (LCDWIDTH - x)) ? (LCDWIDTH - x) : real_width;
+            uint8_t out_advance = (real_advance > (LCDWIDTH - x)) ? (LCDWIDTH - x) : real_advance;
+            uint8_t *col = dst + x;
+
+            if(scale == 0x0100)
+            {
+                /* The glyph rows, shifted into place on this page */
+                if(next_bank)
+                {
+                    for(uint8_t i = 0; i < out_x; i++)
+                    {
+                        uint16_t window = src[i] | (src[i + width] << 8);
+                        uint8_t out = (uint8_t)(((window ^ flip) >> shift) << row_shift);
+
+                        col[i] = copy ? out : _rop_merge(sel, col[i], mask, out);
+                    }
+                }
+                else
+                {
+                    for(uint8_t i = 0; i < out_x; i++)
+                    {
+                        uint8_t out = (uint8_t)((uint8_t)(src[i] ^ flip) >> shift) << row_shift;
+
+                        col[i] = copy ? out : _rop_merge(sel, col[i], mask, out);
+                    }
+                }
+            }
+            else
+            {
+                uint32_t frac = 0;
+                uint8_t sx = 0, out = 0;
+                bool fresh = false;
+
+                for(uint8_t i = 0; i < out_x; i++)
+                {
+                    if(!fresh)
+                    {
+                        uint16_t window = src[sx] | (next_bank ? (src[sx + width] << 8) : 0);
+                        uint8_t v = (window ^ flip) >> shift;
+
+                        out = lo[v & 0x0f] | hi[v >> 4];
+                        fresh = true;
+                    }
+
+                    col[i] = copy ? out : _rop_merge(sel, col[i], mask, out);
+
+                    /* Next glyph column - At most one step, since the factor is 1 or more */
+                    frac += 0x0100;
+                    if(frac >= scale)
+                    {
+                        frac -= scale;
+                        sx++;
+                        fresh = false;
+                    }
+                }
+            }
+
+            /* Blank columns up to the next glyph */
+            for(uint8_t i = out_x; i < out_advance; i++) col[i] = copy ? blank : _rop_merge(sel, col[i], mask, blank);
+
+            x += real_advance;
+        }
+    }
+}
+
+/*!
+    @brief    Draws a string from a position, wrapping to the next line at the screen bounds and at newlines.
+    The characters of a line are gathered, up to TEXT_RUN_SZ, and drawn together as a run.
+    @param    h         The screen handle
+    @param    f         The font
+    @param    str       The string to print
+    @param    x_pos     The x-coordinate, moved past the text
+    @param    y_pos     The y-coordinate, moved to the line of the end of the text
+    @param    line_h    The height of a line
+    @param    scale     The scale factor in Q8.8, 1.0 or more
+    @param    invert    Flag to invert the text
+*/
+static void _print_text(ssd_1306_t *h, const _text_font_t *f, const char *str, uint8_t *x_pos, uint8_t *y_pos,
+                        uint8_t line_h, uint16_t scale, bool invert)
+{
+    /* Each glyph is read in place, into the slot after the run */
+    _text_glyph_t run[TEXT_RUN_SZ + 1];
+    uint8_t x = *x_pos, y = *y_pos, run_x = x, nb = 0, len;
+
+    for(; *str; str += len)
+    {
+        bool drawn = _text_glyph(f, str, &run[nb], &len);
+
+        /* Screen bounds exceeded or newline found */
+        if((x + (((uint32_t)run[nb].width * scale) >> 8)) >= LCDWIDTH || *str == '\n')
+        {
+            if(nb) _print_run(h, f, run, nb, run_x, y, scale, invert);
+            run[0] = run[nb];
+            nb = 0;
+
+            x = 0;
+            y += line_h;
+        }
+
+        /* Screen bounds exceeded, reset back to start */
+        if(y >= LCDHEIGHT) y = 0;
+
+        if(!drawn) continue;
+
+        if(nb == TEXT_RUN_SZ)
+        {
+            _print_run(h, f, run, nb, run_x, y, scale, invert);
+            run[0] = run[nb];
+            nb = 0;
+        }
+
+        if(!nb) run_x = x;
+        x += ((uint32_t)run[nb++].advance * scale) >> 8;
+    }
+
+    if(nb) _print_run(h, f, run, nb, run_x, y, scale, invert);
+
+    *x_pos = x;
+    *y_pos = y;
+}
+
+/*!
+    @brief    Set the cursor position for the default printer.
+    @param    h  The screen handle
+    @param    x  x-coordinate
+    @param    y  y-coordinate
+*/
+void SSD1306_coord_h(ssd_1306_t *h, uint8_t x, uint8_t y)
+{
+    if(x < LCDWIDTH) h->x_pos = x;
+    if(y < LCDHEIGHT) h->y_pos = y >> 3;
+}
+
+/* The font of the default printer, set up once per string */
+typedef struct
+{
+    const uint8_t *font;
+    uint8_t option;
+    uint8_t width;
+    uint8_t shift;      /* Alignment of the glyphs in their bank */
+    uint8_t byte_num;
+    uint8_t last;       /* Last character of the font */
+    bool invert;
+#ifdef SSD1306_GLYPH_CACHE
+    bool cached;        /* Small font glyphs are taken from the cache */
+#endif
+}_printer_t;
+
+/*!
+    @brief    Sets up the default printer for a font and its alignment.
+    @param    p         The printer
+    @param    option    The options (font and potential centering)
+    @param    invert    Flag to invert the text
+    @return             True if the option holds a font, false otherwise.
+*/
+static bool _printer_init(_printer_t *p, uint8_t option, bool invert)
+{
+    p->option = option & FONT_MASK;
+    p->invert = invert;
+
+    /* Get the parameters of the text */
+    switch(p->option)
+    {
+        case LARGE_FONT:
+        {
+            p->shift = 0;
+            p->width = 6;
+            p->byte_num = 6;
+            p->last = 0x7f;
+            p->font = large_font;
+            break;
+        }
+        case MEDIUM_FONT:
+        {
+            p->shift = (option & ALIGMENT_MASK) >> 1; /* Only up or bottom alignment for medium */
+            p->width = 5;
+            p->byte_num = 5;
+            p->last = 0x7f;
+            p->font = medium_font;
+            break;
+        }
+        case SMALL_FONT:
+        {
+            p->shift = option & ALIGMENT_MASK;
+            p->width = 4;
+            p->byte_num = 3;
+            p->last = 0x7e;
+            p->font = small_font;
+            break;
+        }
+        default: return false; /* Illegal option */
+    }
+
+#ifdef SSD1306_GLYPH_CACHE
+    p->cached = p->option == SMALL_FONT && p->shift <= ALIGN_BOTTOM;
+#endif
+
+    return true;
+}
+
+/*!
+    @brief    Draws a character at the cursor of the default printer, and moves the cursor past it.
+    @param    h     The screen handle
+    @param    p     The printer
+    @param    c     The code point of the character
+*/
+static inline void _printer_putc(ssd_1306_t *h, const _printer_t *p, uint16_t c)
+{
+    const uint16_t offset = 0x20; /* For now this is constant */
+    const uint8_t width = p->width;
+
+    /* Screen bounds exceeded or newline found */
+    if((h->x_pos + width) >= LCDWIDTH || c == '\n')
+    {
+        h->x_pos = 0;
+        h->y_pos++;
+    }
+
+    /* Screen bounds exceeded, reset back to start */
+    if(h->y_pos >= LCDHEIGHT/8) h->y_pos = 0;
+
+    /* Characters that the font lacks are not drawn */
+    if(c < offset || c > p->last) return;
+
+    /* Only the cursor moves outside the page being rendered (strip mode) */
+    if(ROW_CLIPPED(h, h->y_pos << 3))
+    {
+        h->x_pos += width;
+        return;
+    }
+
+    /* Print buffer in case we need to edit a character */
+    uint8_t buffer[6];
+    uint16_t dest_pos = COORDS2BUFF_POS(h, h->x_pos, h->y_pos << 3);
+    uint16_t src_pos = (c - offset) * p->byte_num;
+    const uint8_t *glyph = buffer;
+
+#ifdef SSD1306_GLYPH_CACHE
+    /* Small font glyphs are ready to copy */
+    if(p->cached)
+    {
+        glyph = _small_glyph_cached(c - offset, p->shift, p->invert);
+    }
+    else
+#endif
+    {
+        /* Small font has to be decoded since the bytes are packed */
+        if(p->option == SMALL_FONT) _small_glyph_unpack(p->font + src_pos, buffer);
+        else memcpy(buffer, p->font + src_pos, p->byte_num * sizeof(uint8_t));
+
+        /* Shifting */
+        if(p->shift)
+        {
+            for(uint8_t i = 0; i < width; i++) buffer[i] = buffer[i] << p->shift;
+        }
+
+        /* Invert option */
+        if(p->invert)
+        {
+            for(uint8_t i = 0; i < width; i++) buffer[i] = ~buffer[i];
+        }
+    }
+
+    /* The glyph covers whole bytes of the page */
+    if(h->rop == SSD1306_ROP_COPY)
+    {
+        memcpy(h->buffer + dest_pos, glyph, width * sizeof(uint8_t));
+    }
+    else
+    {
+        uint8_t *dst = h->buffer + dest_pos;
+        for(uint8_t i = 0; i < width; i++) dst[i] = _rop_merge(ROP_SEL(h), dst[i], 0xff, glyph[i]);
+    }
+
+    MARK_DIRTY(h, h->x_pos, h->x_pos + width - 1, h->y_pos << 3, h->y_pos << 3);
+
+    h->x_pos += width;
+}
+
+/*!
+    @brief    Draws a string on the screen.
+    This is the default printer that draws on the preassigned coordinates with the
+    preassigned font (small, medium, large).
+    The printing is done on the bank borders, so text can be aligned UP, CENTER and LOW.
+
+    CENTER:    Text aligned exactly at the center
+    BOTTOM:    Text aligned exactly at the lowest part
+    TOP:       Text aligned exactly at the highest possible spot
+
+    In the case of LARGE text, no option is available.
+    In the case of MEDIUM text, only TOP and BOTTOM options available.
+    In the case of SMALL text, all options are available.
+
+    @param    h         The screen handle
+    @param    str       The string to print
+    @param    option    The options (font and potential centering)
+    @param    invert    Flag to invert the text, if true inverts (black bg with white character)
+    otherwise left as is
+*/
+void SSD1306_print_str_h(ssd_1306_t *h, const char *str, uint8_t option, bool invert)
+{
+    _printer_t p;
+
+    /* Sanity check */
+    if(!str || !_printer_init(&p, option, invert)) return;
+
+    while(*str)
+    {
+        uint16_t code;
+
+        str += _utf8_decode(str, &code);
+        _printer_putc(h, &p, code);
+    }
+}
+
+/*!
+    @brief    Draws a string on the screen.
+    This variant prints a string on any xy coordinate in the screen (starting positions) freely, hence
+    the 'f' in method name. The starting position is the uppermost left point of where a character should be.
+    This variant can also scale the letters upwards if need be.
+    @param    h         The screen handle
+    @param    str       The string to print
+    @param    option    Font type (Alignment is not needed here)
+    @param    x         Starting x-coordinate
+    @param    y         Starting y-coordinate
+    @param    scale     How much to scale the existing font, 1 or more
+    @param    invert    Flag to invert the text, if true inverts (black bg with white character)
+    otherwise left as is.
+*/
+void SSD1306_print_fstr_h(ssd_1306_t *h, const char *str, uint8_t option, uint8_t x, uint8_t y, uint8_t scale, bool invert)
+{
+    SSD1306_print_fstr_q8_h(h, str, option, x, y, (uint16_t)scale << 8, invert);
+}
+
+/*!
+    @brief    Draws a string on the screen, like SSD1306_print_fstr() but scaled by a fractional factor
+    (such as x1.5 or x2.5).
+    @param    h         The screen handle
+    @param    str       The string to print
+    @param    option    Font type (Alignment is not needed here)
+    @param    x         Starting x-coordinate
+    @param    y         Starting y-coordinate
+    @param    scale     The scale factor in Q8.8, 1.0 or more - See SSD1306_SCALE_Q8()
+    @param    invert    Flag to invert the text, if true inverts (black bg with white character)
+    otherwise left as is.
+*/
+void SSD1306_print_fstr_q8_h(ssd_1306_t *h, const char *str, uint8_t option, uint8_t x, uint8_t y, uint16_t scale, bool invert)
+{
+    /* Sanity check */
+    if(!str || scale < 0x0100) return;
+
+    /* Get the parameters of the text */
+    _text_font_t f;
+    if(!_fixed_font(option, &f)) return;
+
+    _print_text(h, &f, str, &x, &y, ((uint32_t)f.height * scale) >> 8, scale, invert);
+}
+
+/*!
+    @brief    Draws a string on the screen with a proportional font, like SSD1306_print_str().
+    The printing starts from the preassigned coordinates, on the bank borders, and moves them past the text.
+    Every line of text takes the banks that cover the height of the font.
+    @param    h         The screen handle
+    @param    str       The string to print
+    @param    font      The proportional font
+    @param    invert    Flag to invert the text, if true inverts (black bg with white character)
+    otherwise left as is
+*/
+void SSD1306_print_str_font_h(ssd_1306_t *h, const char *str, const ssd_1306_font_t *font, bool invert)
+{
+    /* Sanity check */
+    if(!str || !font) return;
+
+    _text_font_t f = {.prop = font, .height = font->height};
+    uint8_t y = h->y_pos << 3;
+
+    _print_text(h, &f, str, &h->x_pos, &y, (font->height + 7) & ~0x07, 0x0100, invert);
+
+    h->y_pos = y >> 3;
+}
+
+/*!
+    @brief    Draws a string on the screen with a proportional font, like SSD1306_print_fstr().
+    @param    h         The screen handle
+    @param    str       The string to print
+    @param    font      The proportional font
+    @param    x         Starting x-coordinate
+    @param    y         Starting y-coordinate
+    @param    scale     How much to scale the font, 1 or more
+    @param    invert    Flag to invert the text, if true inverts (black bg with white character)
+    otherwise left as is.
+*/
+void SSD1306_print_fstr_font_h(ssd_1306_t *h, const char *str, const ssd_1306_font_t *font, uint8_t x, uint8_t y,
+                               uint8_t scale, bool invert)
+{
+    /* Sanity check */
+    if(!str || !font || !scale) return;
+
+    _text_font_t f = {.prop = font, .height = font->height};
+
+    _print_text(h, &f, str, &x, &y, font->height * scale, (uint16_t)scale << 8, invert);
+}
+
+/**********************************************************/
+/********************** TEXT LAYOUT ***********************/
+/**********************************************************/
+
+/*!
+    @brief    Gets the font of a text, a proportional one or else one of the fixed-width ones.
+    @param    font      The proportional font, NULL for a fixed-width one
+    @param    option    The fixed-width font type
+    @param    f         The font to set up
+    @return             True if there is a font, false otherwise.
+*/
+static bool _layout_font(const ssd_1306_font_t *font, uint8_t option, _text_font_t *f)
+{
+    if(!font) return _fixed_font(option, f);
+
+    f->prop = font;
+    f->height = font->height;
+
+    return true;
+}
+
+/*!
+    @brief    Measures the characters of a line, up to a newline, the end of the string or the available columns.
+    @param    f         The font
+    @param    str       The characters
+    @param    len       Most characters to measure
+    @param    scale     How much the font is scaled
+    @param    max_x     Columns available - The glyph that crosses them is not measured
+    @param    x         Columns up to the glyph after the measured characters
+    @param    width     Columns up to the end of the last glyph, without the trailing spaces
+    @return             The number of characters measured
+*/
+static uint16_t _text_fit(const _text_font_t *f, const char *str, uint16_t len, uint8_t scale, uint16_t max_x,
+                          uint16_t *x, uint16_t *width)
+{
+    uint16_t n = 0;
+    uint8_t bytes;
+    *x = *width = 0;
+
+    for(; n < len && str[n] && str[n] != '\n'; n += bytes)
+    {
+        _text_glyph_t g;
+        if(!_text_glyph(f, str + n, &g, &bytes)) continue;
+
+        uint16_t end = *x + (uint16_t)g.width * scale;
+        if(end > max_x) break;
+
+        if(str[n] != ' ') *width = end;
+        *x += (uint16_t)g.advance * scale;
+    }
+
+    return n;
+}
+
+/*!
+    @brief    Finds the end of the last glyph that is drawn and is not a space.
+    @param    f         The font
+    @param    str       The characters
+    @param    len       The number of bytes
+    @return             The number of bytes up to the end of that glyph, 0 if there is none.
+*/
+static uint16_t _text_ink(const _text_font_t *f, const char *str, uint16_t len)
+{
+    uint16_t end = 0;
+    uint8_t bytes;
+
+    for(uint16_t n = 0; n < len; n += bytes)
+    {
+        _text_glyph_t g;
+        if(_text_glyph(f, str + n, &g, &bytes) && str[n] != ' ') end = n + bytes;
+    }
+
+    return end;
+}
+
+/*!
+    @brief    Shortens a line of a text box to end it with "...", within the width of the box.
+    @param    f         The font
+    @param    box       The text box
+    @param    line      The line
+*/
+static void _layout_ellipsis(const _text_font_t *f, const ssd_1306_text_box_t *box, ssd_1306_text_line_t *line)
+{
+    const char *str = box->str + line->start;
+    uint16_t dots_x, dots_w, x, width;
+
+    _text_fit(f, "...", 3, box->scale, 0xffff, &dots_x, &dots_w);
+    if(dots_w > box->len_x) return;
+
+    /* The characters that leave room for the dots, without the spaces before them */
+    uint16_t len = _text_fit(f, str, line->len, box->scale, box->len_x - dots_w, &x, &width);
+
+    for(;;)
+    {
+        while(len && str[len - 1] == ' ') len--;
+
+        _text_fit(f, str, len, box->scale, 0xffff, &x, &width);
+        if(!len || (x + dots_w) <= box->len_x) break;
+
+        /* Back a whole UTF-8 character */
+        do
+        {
+            len--;
+        }while(len && (str[len] & 0xc0) == 0x80);
+    }
+
+    line->len = len;
+    line->width = x + dots_w;
+    line->ellipsis = true;
+}
+
+/*!
+    @brief    Draws the characters of a line of a text box, without wrapping.
+    The last glyph ends the line, without the spacing after it.
+    @param    h         The screen handle
+    @param    f         The font
+    @param    str       The characters
+    @param    len       The number of characters
+    @param    dots      Flag to end the line with "..."
+    @param    x         Leftmost x-coordinate
+    @param    y         Upper y-coordinate
+    @param    scale     The scale factor in Q8.8, 1.0 or more
+    @param    invert    Flag to invert the text
+*/
+static void _print_line(ssd_1306_t *h, const _text_font_t *f, const char *str, uint16_t len, bool dots, uint16_t x, uint8_t y,
+                        uint16_t scale, bool invert)
+{
+    _text_glyph_t run[TEXT_RUN_SZ + 1]; /* The glyphs are read in place, as in _print_text() */
+    uint16_t run_x = x;
+    uint8_t nb = 0, bytes;
+
+    for(uint8_t part = 0; part < 2; part++)
+    {
+        const char *c = part ? "..." : str;
+        uint16_t n = part ? (dots ? 3 : 0) : len;
+
+        for(uint16_t i = 0; i < n; i += bytes)
+        {
+            if(!_text_glyph(f, c + i, &run[nb], &bytes)) continue;
+
+            if(nb == TEXT_RUN_SZ)
+            {
+                if(run_x < LCDWIDTH) _print_run(h, f, run, nb, run_x, y, scale, invert);
+                run[0] = run[nb];
+                nb = 0;
+            }
+
+            if(!nb) run_x = x;
+            x += ((uint32_t)run[nb++].advance * scale) >> 8;
+        }
+    }
+
+    if(!nb || run_x >= LCDWIDTH) return;
+
+    run[nb - 1].advance = run[nb - 1].width;
+    _print_run(h, f, run, nb, run_x, y, scale, invert);
+}
+
+/*!
+    @brief    Measures a string, without wrapping.
+    @param    str       The string
+    @param    option    The fixed-width font type, when there is no proportional font
+    @param    font      The proportional font, or NULL
+    @param    scale     How much the font is scaled, 1 or more
+    @param    len_x     Width of the longest line, can be NULL
+    @param    len_y     Height of the lines, can be NULL
+*/
+void SSD1306_text_measure(const char *str, uint8_t option, const ssd_1306_font_t *font, uint8_t scale, uint16_t *len_x, uint16_t *len_y)
+{
+    _text_font_t f;
+    uint16_t width = 0, lines = 0;
+
+    if(str && scale && _layout_font(font, option, &f))
+    {
+        while(*str)
+        {
+            uint16_t x, line_w;
+
+            str += _text_fit(&f, str, 0xffff, scale, 0xffff, &x, &line_w);
+            if(*str == '\n') str++;
+
+            if(line_w > width) width = line_w;
+            lines++;
+        }
+
+        lines *= (uint16_t)f.height * scale;
+    }
+
+    if(len_x) *len_x = width;
+    if(len_y) *len_y = lines;
+}
+
+/*!
+    @brief    Lays out the text of a box, once for every time that it is drawn.
+    The lines break at the newlines and, when wrapping, at the last space that fits in the box (a word longer than the
+    box is cut, and the text stops where not even a glyph fits). Without wrapping, the rest of a line that does not fit is left out. The text ends at the last line
+    that fits, and with the ellipsis option a cut line or the last one (when text is left out) ends with "...".
+    Every line is then justified in the box.
+    @param    box       The text box - The lines and the extent of the text are set
+    @return             True if the whole text fits in the box, false otherwise.
+*/
+bool SSD1306_text_layout(ssd_1306_text_box_t *box)
+{
+    _text_font_t f;
+
+    box->nb_lines = box->width = box->height = 0;
+    if(!box->str || !box->scale || !_layout_font(box->font, box->option, &f)) return false;
+
+    const uint16_t line_h = (uint16_t)f.height * box->scale;
+    uint16_t max_lines = box->len_y / line_h;
+    if(max_lines > SSD1306_TEXT_LINES) max_lines = SSD1306_TEXT_LINES;
+
+    const char *c = box->str;
+    bool fits = true;
+
+    while(*c)
+    {
+        if(box->nb_lines == max_lines)
+        {
+            /* Text left out - The last line shows it */
+            if(box->ellipsis && box->nb_lines) _layout_ellipsis(&f, box, &box->lines[box->nb_lines - 1]);
+
+            fits = false;
+            break;
+        }
+
+        ssd_1306_text_line_t *line = &box->lines[box->nb_lines++];
+        uint16_t x, width;
+        uint16_t len = _text_fit(&f, c, 0xffff, box->scale, box->len_x, &x, &width);
+        const char *next = c + len;
+        bool cut = false;
+
+        line->start = c - box->str;
+        line->ellipsis = false;
+
+        if(*next && *next != '\n')
+        {
+            /* The line is wider than the box */
+            if(box->wrap)
+            {
+                /* Back to the last space, or cut the word when it is longer than the line */
+                uint16_t brk = len;
+                while(brk && c[brk] != ' ') brk--;
+
+                if(brk) len = brk;
+
+                /* Not even a glyph fits in the box, the rest of the text is left out */
+                if(!len)
+                {
+                    box->nb_lines--;
+                    fits = false;
+                    break;
+                }
+
+                _text_fit(&f, c, len, box->scale, 0xffff, &x, &width);
+
+                /* The spaces between the lines are not drawn */
+                for(next = c + len; *next == ' '; next++);
+            }
+            else
+            {
+                fits = false;
+                cut = true;
+                while(*next && *next != '\n') next++;
+            }
+        }
+
+        /* The spaces that end a line are not drawn, they are not part of its width (nor the characters after them
+         * that the font lacks) */
+        len = _text_ink(&f, c, len);
+
+        line->len = len;
+        line->width = (width > 0xff) ? 0xff : width;
+
+        if(cut && box->ellipsis) _layout_ellipsis(&f, box, line);
+
+        c = (*next == '\n') ? next + 1 : next;
+    }
+
+    /* Justification and extent of the text */
+    for(uint8_t i = 0; i < box->nb_lines; i++)
+    {
+        ssd_1306_text_line_t *line = &box->lines[i];
+        uint8_t room = (line->width < box->len_x) ? (box->len_x - line->width) : 0;
+
+        if(box->justify == SSD1306_JUSTIFY_CENTER) line->x = room >> 1;
+        else if(box->justify == SSD1306_JUSTIFY_RIGHT) line->x = room;
+        else line->x = 0;
+
+        if(line->width > box->width) box->width = line->width;
+    }
+
+    box->height = box->nb_lines * line_h;
+
+    return fits;
+}
+
+/*!
+    @brief    Draws a text box, as laid out by SSD1306_text_layout().
+    @param    h         The screen handle
+    @param    box       The text box
+    @param    invert    Flag to invert the text, if true inverts (black bg with white character)
+    otherwise left as is.
+*/
+void SSD1306_text_draw_h(ssd_1306_t *h, const ssd_1306_text_box_t *box, bool invert)
+{
+    _text_font_t f;
+
+    /* Sanity check */
+    if(!box || !box->str || !box->scale || !_layout_font(box->font, box->option, &f)) return;
+
+    const uint16_t scale = (uint16_t)box->scale << 8;
+    uint16_t y = box->y;
+
+    for(uint8_t i = 0; i < box->nb_lines && y < LCDHEIGHT; i++, y += (uint16_t)f.height * box->scale)
+    {
+        const ssd_1306_text_line_t *line = &box->lines[i];
+        _print_line(h, &f, box->str + line->start, line->len, line->ellipsis, box->x + line->x, y, scale, invert);
+    }
+}
+
+/**********************************************************/
+/************************ NUMBERS *************************/
+/**********************************************************/
+
+/* Header of the number fonts - Width, height, first character and number of characters */
+#define NUM_FONT_HDR        4
+
+/* Largest glyph of a number font that can be inverted or blanked (BigNumbers take 42 bytes) */
+#define NUM_CELL_MAX        48
+
+/*!
+    @brief    Checks that a number font can be drawn.
+    @param    font    The number font
+    @return           True if its glyphs fit the cell buffer, false otherwise.
+*/
+static bool _num_font_ok(const uint8_t *font)
+{
+    return font && font[0] && font[1] && ((uint16_t)font[0] * ((font[1] + 7) >> 3)) <= NUM_CELL_MAX;
+}
+
+/*!
+    @brief    Formats a value in decimal, with its sign and decimal point. There is always a digit before the point.
+    @param    value       The value, in units of the last decimal (e.g. 2150 with 2 decimals is 21.50)
+    @param    decimals    Digits after the decimal point, up to 9
+    @param    str         SSD1306_NUMBER_SZ characters, filled from the end (not terminated)
+    @return               The number of characters, the last ones of str.
+*/
+static uint8_t _num_format(int32_t value, uint8_t decimals, char *str)
+{
+    uint32_t magnitude = (value < 0) ? -(uint32_t)value : (uint32_t)value;
+    char *c = str + SSD1306_NUMBER_SZ;
+    uint8_t digits = 0;
+
+    do
+    {
+        *--c = '0' + (magnitude % 10);
+        magnitude /= 10;
+
+        if(++digits == decimals) *--c = '.';
+    }while(magnitude || digits <= decimals);
+
+    if(value < 0) *--c = '-';
+
+    return (str + SSD1306_NUMBER_SZ) - c;
+}
+
+/*!
+    @brief    Draws a character of a number font, in a cell of the font's width.
+    The glyphs are drawn bank by bank with _draw_bitmap(), so on a page-aligned y-coordinate every bank is copied
+    straight into its page (SSD1306_ROP_COPY). Characters that the font lacks (such as a space) leave the cell blank.
+    @param    h         The screen handle
+    @param    font      The number font
+    @param    c         The character
+    @param    x         Leftmost x-coordinate
+    @param    y         Upper y-coordinate
+    @param    invert    Flag to invert the cell
+*/
+static void _num_cell(ssd_1306_t *h, const uint8_t *font, char c, uint8_t x, uint8_t y, bool invert)
+{
+    const uint8_t width = font[0], height = font[1];
+    const uint16_t size = (uint16_t)width * ((height + 7) >> 3);
+    uint8_t cell[NUM_CELL_MAX];
+    const uint8_t *src = cell;
+
+    if(x >= LCDWIDTH || y >= LCDHEIGHT) return;
+
+    if((uint8_t)c >= font[2] && ((uint8_t)c - font[2]) < font[3])
+        src = font + NUM_FONT_HDR + ((uint8_t)c - font[2]) * size;
+    else
+        memset(cell, 0x00, size);
+
+    if(invert)
+    {
+        for(uint16_t i = 0; i < size; i++) cell[i] = ~src[i];
+        src = cell;
+    }
+
+    uint8_t draw_x = width, draw_y = height;
+    if(((uint16_t)x + width) > LCDWIDTH) draw_x = LCDWIDTH - x;
+    if(((uint16_t)y + height) > LCDHEIGHT) draw_y = LCDHEIGHT - y;
+
+    _draw_bitmap(h, src, x, y, draw_x, draw_y, width);
+}
+
+/*!
+    @brief    Draws a number with one of the number fonts (MediumNumbers, BigNumbers).
+    @param    h           The screen handle
+    @param    value       The value, in units of the last decimal (e.g. -2150 with 2 decimals is -21.50)
+    @param    decimals    Digits after the decimal point (up to 9), 0 for an integer
+    @param    font        The number font
+    @param    x           Leftmost x-coordinate
+    @param    y           Upper y-coordinate - A multiple of 8 is the fastest
+    @param    invert      Flag to invert the number
+*/
+void SSD1306_print_num_h(ssd_1306_t *h, int32_t value, uint8_t decimals, const uint8_t *font, uint8_t x, uint8_t y, bool invert)
+{
+    char str[SSD1306_NUMBER_SZ];
+
+    /* Illegal font or format */
+    if(!_num_font_ok(font) || decimals > 9) return;
+
+    uint8_t len = _num_format(value, decimals, str);
+    uint16_t cell_x = x;
+
+    for(const char *c = str + SSD1306_NUMBER_SZ - len; (c < str + SSD1306_NUMBER_SZ) && (cell_x < LCDWIDTH); c++)
+    {
+        _num_cell(h, font, *c, cell_x, y, invert);
+        cell_x += font[0];
+    }
+}
+
+/*!
+    @brief    Shows a value on a numeric readout, redrawing only the characters that differ from the ones on the buffer.
+    With partial refreshes, only those cells are sent to the display. The cells are opaque, they are drawn with
+    SSD1306_ROP_COPY whatever the draw mode. A value that does not fit in the cells is shown as dashes.
+    While rendering strips, the whole readout is drawn on every page.
+    @param    h       The screen handle
+    @param    num     The readout
+    @param    value   The value, in units of the last decimal (e.g. 2150 with 2 decimals is 21.50)
+    @return           The number of cells redrawn, 0 if the readout did not change.
+*/
+uint8_t SSD1306_number_update_h(ssd_1306_t *h, ssd_1306_number_t *num, int32_t value)
+{
+    char str[SSD1306_NUMBER_SZ];
+
+    /* Illegal readout */
+    if(!num || !_num_font_ok(num->font) || num->decimals > 9) return 0;
+    if(!num->cells || num->cells > SSD1306_NUMBER_SZ) return 0;
+
+    const uint8_t len = _num_format(value, num->decimals, str);
+    const uint8_t pad = num->cells - len;
+    const char *digits = str + SSD1306_NUMBER_SZ - len;
+
+    /* Every page of a strip starts blank */
+    const bool strips = (h->clip_y0 != 0) || (h->clip_y1 != (LCDHEIGHT - 1));
+    const uint8_t rop = h->rop;
+    uint8_t redrawn = 0;
+    uint16_t cell_x = num->x;
+
+    h->rop = SSD1306_ROP_COPY;
+
+    for(uint8_t i = 0; i < num->cells; i++, cell_x += num->font[0])
+    {
+        char c = (len > num->cells) ? '-' : ((i < pad) ? ' ' : digits[i - pad]);
+
+        if(num->drawn && !strips && (num->shown[i] == c)) continue;
+
+        /* The cells past the right edge are not drawn, but remembered like the others */
+        if(cell_x < LCDWIDTH)
+        {
+            _num_cell(h, num->font, c, cell_x, num->y, num->invert);
+            redrawn++;
+        }
+        num->shown[i] = c;
+    }
+
+    h->rop = rop;
+    num->drawn = !strips;
+
+    return redrawn;
+}
+
+/**********************************************************/
+/******************** FORMATTED TEXT **********************/
+/**********************************************************/
+
+/*!
+    @brief    Draws characters at the cursor of the default printer, padded to a field width.
+    @param    h         The screen handle
+    @param    p         The printer
+    @param    text      The characters, in UTF-8
+    @param    len       The number of bytes
+    @param    chars     The number of characters
+    @param    width     The field width
+    @param    flags     '-' to align left, '0' to pad a number with zeros (after its sign), 0 otherwise
+*/
+static void _printer_field(ssd_1306_t *h, const _printer_t *p, const char *text, uint16_t len, uint16_t chars,
+                           uint16_t width, char flags)
+{
+    uint16_t pad = (width > chars) ? (width - chars) : 0;
+
+    if(flags == '0' && len && (*text == '-'))
+    {
+        _printer_putc(h, p, '-');
+        text++;
+        len--;
+    }
+
+    for(; pad && flags != '-'; pad--) _printer_putc(h, p, (flags == '0') ? '0' : ' ');
+
+    for(uint16_t i = 0; i < len;)
+    {
+        uint16_t code;
+
+        i += _utf8_decode(text + i, &code);
+        _printer_putc(h, p, code);
+    }
+
+    for(; pad; pad--) _printer_putc(h, p, ' ');
+}
+
+/*!
+    @brief    Draws formatted text at the cursor of the default printer, like SSD1306_print_str().
+    Every character is drawn as soon as it is formatted, there is no string in between, no heap and no
+    floating point. The conversions are a subset of printf():
+
+    %d %i      A signed integer (%ld for a long)
+    %u         An unsigned integer
+    %x %X      An unsigned integer in hexadecimal
+    %.Nq       A signed integer in units of N decimals, printed with a decimal point (e.g. 2150 with %.2q is 21.50)
+    %c %s      A character, and a string (%.Ns prints up to N characters)
+    %%         The percent sign
+
+    A field width pads the conversion with spaces on the left, with '-' on the right and with '0' with zeros
+    after the sign. The width and the precision can also be given as int arguments with *.
+
+    @param    h         The screen handle
+    @param    option    The options (font and potential centering)
+    @param    invert    Flag to invert the text
+    @param    fmt       The format string
+    @param    args      The arguments of the conversions
+*/
+void SSD1306_vprintf_h(ssd_1306_t *h, uint8_t option, bool invert, const char *fmt, va_list args)
+{
+    _printer_t p;
+
+    /* Sanity check */
+    if(!fmt || !_printer_init(&p, option, invert)) return;
+
+    for(; *fmt; fmt++)
+    {
+        if(*fmt != '%')
+        {
+            uint16_t code;
+
+            fmt += _utf8_decode(fmt, &code) - 1;
+            _printer_putc(h, &p, code);
+            continue;
+        }
+
+        char flags = 0, digits[SSD1306_NUMBER_SZ];
+        const char *text = digits;
+        uint16_t len = 0, chars = 0;
+        uint16_t width = 0;
+        int16_t precision = -1;
+        bool wide = false;
+
+        /* Flags, field width, precision and length */
+        for(fmt++; (*fmt == '-') || (*fmt == '0'); fmt++)
+        {
+            if(flags != '-') flags = *fmt;
+        }
+
+        if(*fmt == '*')
+        {
+            int arg = va_arg(args, int);
+            width = (arg < 0) ? 0 : ((arg > 1000) ? 1000 : arg);
+            fmt++;
+        }
+
+        for(; (*fmt >= '0') && (*fmt <= '9'); fmt++)
+        {
+            if(width < 1000) width = width * 10 + (*fmt - '0');
+        }
+
+        if(*fmt == '.' && *(fmt + 1) == '*')
+        {
+            int arg = va_arg(args, int);
+            precision = (arg < 0) ? -1 : ((arg > 1000) ? 1000 : arg);
+            fmt += 2;
+        }
+        else if(*fmt == '.')
+        {
+            for(precision = 0, fmt++; (*fmt >= '0') && (*fmt <= '9'); fmt++)
+            {
+                if(precision < 1000) precision = precision * 10 + (*fmt - '0');
+            }
+        }
+
+        if(*fmt == 'l')
+        {
+            wide = true;
+            fmt++;
+        }
+
+        switch(*fmt)
+        {
+            case 'd':
+            case 'i':
+            case 'q':
+            {
+                int32_t value = wide ? (int32_t)va_arg(args, long) : va_arg(args, int);
+                uint8_t decimals = (*fmt == 'q' && precision > 0) ? ((precision > 9) ? 9 : precision) : 0;
+
+                len = _num_format(value, decimals, digits);
+                text = digits + SSD1306_NUMBER_SZ - len;
+                break;
+            }
+            case 'u':
+            case 'x':
+            case 'X':
+            {
+                uint32_t value = wide ? (uint32_t)va_arg(args, unsigned long) : va_arg(args, unsigned int);
+                const uint8_t base = (*fmt == 'u') ? 10 : 16;
+                const char *hex = (*fmt == 'X') ? "0123456789ABCDEF" : "0123456789abcdef";
+
+                do
+                {
+                    digits[SSD1306_NUMBER_SZ - ++len] = hex[value % base];
+                    value /= base;
+                }while(value);
+
+                text = digits + SSD1306_NUMBER_SZ - len;
+                break;
+            }
+            case 'c':
+            {
+                digits[0] = (char)va_arg(args, int);
+                len = 1;
+                if(flags == '0') flags = 0;
+                break;
+            }
+            case 's':
+            {
+                text = va_arg(args, const char *);
+                if(!text) text = "(null)";
+
+                for(uint16_t code; text[len] && (precision < 0 || chars < precision); chars++)
+                {
+                    len += _utf8_decode(text + len, &code);
+                }
+
+                if(flags == '0') flags = 0;
+                break;
+            }
+            case '%':
+            {
+                digits[0] = '%';
+                len = 1;
+                width = 0;
+                break;
+            }
+            default:
+            {
+                /* Unknown conversion or end of the format - Nothing is drawn */
+                if(!*fmt) fmt--;
+                continue;
+            }
+        }
+
+        _printer_field(h, &p, text, len, (*fmt == 's') ? chars : len, width, flags);
+    }
+}
+
+/*!
+    @brief    SSD1306_vprintf_h() with the arguments of the conversions following the format.
+    @param    h         The screen handle
+    @param    option    The options (font and potential centering)
+    @param    invert    Flag to invert the text
+    @param    fmt       The format string
+*/
+void SSD1306_printf_h(ssd_1306_t *h, uint8_t option, bool invert, const char *fmt, ...)
+{
+    va_list args;
+
+    va_start(args, fmt);
+    SSD1306_vprintf_h(h, option, invert, fmt, args);
+    va_end(args);
+}
+
+/**********************************************************/
+/******************** CURRENT SCREEN **********************/
+/**********************************************************/
+
+/*!
+    @brief    SSD1306_fill_h() on the current screen handle.
+*/
+void SSD1306_fill(bool black)
+{
+    SSD1306_fill_h(_screen_h, black);
+}
+
+/*!
+    @brief    SSD1306_sleep_mode_h() on the current screen handle.
+*/
+bool SSD1306_sleep_mode(bool sleep)
+{
+    return SSD1306_sleep_mode_h(_screen_h, sleep);
+}
+
+/*!
+    @brief    SSD1306_refresh_h() on the current screen handle.
+*/
+bool SSD1306_refresh(void)
+{
+    return SSD1306_refresh_h(_screen_h);
+}
+
+#ifdef SSD1306_PARTIAL_REFRESH
+/*!
+    @brief    SSD1306_refresh_partial_h() on the current screen handle.
+*/
+bool SSD1306_refresh_partial(void)
+{
+    return SSD1306_refresh_partial_h(_screen_h);
+}
+
+/*!
+    @brief    SSD1306_reset_stats_h() on the current screen handle.
+*/
+void SSD1306_reset_stats(void)
+{
+    SSD1306_reset_stats_h(_screen_h);
+}
+
+/*!
+    @brief    SSD1306_mark_dirty_h() on the current screen handle.
+*/
+void SSD1306_mark_dirty(uint8_t x0, uint8_t x1, uint8_t y0, uint8_t y1)
+{
+    SSD1306_mark_dirty_h(_screen_h, x0, x1, y0, y1);
+}
+#endif
+
+/*!
+    @brief    SSD1306_render_strips_h() on the current screen handle.
+*/
+bool SSD1306_render_strips(ssd_1306_draw_t draw, void *arg)
+{
+    return SSD1306_render_strips_h(_screen_h, draw, arg);
+}
+
+/*!
+    @brief    SSD1306_invert_h() on the current screen handle.
+*/
+bool SSD1306_invert(bool invert)
+{
+    return SSD1306_invert_h(_screen_h, invert);
+}
+
+/*!
+    @brief    SSD1306_contrast_h() on the current screen handle.
+*/
+bool SSD1306_contrast(uint8_t contrast)
+{
+    return SSD1306_contrast_h(_screen_h, contrast);
+}
+
+/*!
+    @brief    SSD1306_vcomh_h() on the current screen handle.
+*/
+bool SSD1306_vcomh(uint8_t vcomh)
+{
+    return SSD1306_vcomh_h(_screen_h, vcomh);
+}
+
+/*!
+    @brief    SSD1306_timings_h() on the current screen handle.
+*/
+bool SSD1306_timings(uint8_t freq, uint8_t div_ratio)
+{
+    return SSD1306_timings_h(_screen_h, freq, div_ratio);
+}
+
+/*!
+    @brief    SSD1306_precharge_h() on the current screen handle.
+*/
+bool SSD1306_precharge(uint8_t period)
+{
+    return SSD1306_precharge_h(_screen_h, period);
+}
+
+/*!
+    @brief    SSD1306_draw_mode_h() on the current screen handle.
+*/
+void SSD1306_draw_mode(uint8_t rop)
+{
+    SSD1306_draw_mode_h(_screen_h, rop);
+}
+
+/*!
+    @brief    SSD1306_hscroll_h() on the current screen handle.
+*/
+bool SSD1306_hscroll(uint8_t timing, bool dir)
+{
+    return SSD1306_hscroll_h(_screen_h, timing, dir);
+}
+
+/*!
+    @brief    SSD1306_hvscroll_h() on the current screen handle.
+*/
+bool SSD1306_hvscroll(uint8_t hspeed, uint8_t vspeed, bool dir)
+{
+    return SSD1306_hvscroll_h(_screen_h, hspeed, vspeed, dir);
+}
+
+/*!
+    @brief    SSD1306_scroll_disable_h() on the current screen handle.
+*/
+bool SSD1306_scroll_disable(void)
+{
+    return SSD1306_scroll_disable_h(_screen_h);
+}
+
+/*!
+    @brief    SSD1306_set_pixel_h() on the current screen handle.
+*/
+void SSD1306_set_pixel(uint8_t x, uint8_t y, bool color)
+{
+    SSD1306_set_pixel_h(_screen_h, x, y, color);
+}
+
+/*!
+    @brief    SSD1306_get_pixel_h() on the current screen handle.
+*/
+uint8_t SSD1306_get_pixel(uint8_t x, uint8_t y)
+{
+    return SSD1306_get_pixel_h(_screen_h, x, y);
+}
+
+/*!
+    @brief    SSD1306_draw_line_h() on the current screen handle.
+*/
+void SSD1306_draw_line(uint8_t x0, uint8_t x1, uint8_t y0, uint8_t y1, bool color)
+{
+    SSD1306_draw_line_h(_screen_h, x0, x1, y0, y1, color);
+}
+
+/*!
+    @brief    SSD1306_draw_hline_h() on the current screen handle.
+*/
+void SSD1306_draw_hline(uint8_t x, uint8_t y, uint8_t len, bool color)
+{
+    SSD1306_draw_hline_h(_screen_h, x, y, len, color);
+}
+
+/*!
+    @brief    SSD1306_draw_vline_h() on the current screen handle.
+*/
+void SSD1306_draw_vline(uint8_t x, uint8_t y, uint8_t len, bool color)
+{
+    SSD1306_draw_vline_h(_screen_h, x, y, len, color);
+}
+
+/*!
+    @brief    SSD1306_draw_rectangle_h() on the current screen handle.
+*/
+void SSD1306_draw_rectangle(uint8_t x0, uint8_t x1, uint8_t y0, uint8_t y1, bool color, bool fill)
+{
+    SSD1306_draw_rectangle_h(_screen_h, x0, x1, y0, y1, color, fill);
+}
+
+/*!
+    @brief    SSD1306_draw_triangle_h() on the current screen handle.
+*/
+void SSD1306_draw_triangle(uint8_t x0, uint8_t x1, uint8_t x2, uint8_t y0, uint8_t y1, uint8_t y2, bool color)
+{
+    SSD1306_draw_triangle_h(_screen_h, x0, x1, x2, y0, y1, y2, color);
+}
+
+/*!
+    @brief    SSD1306_draw_fill_triangle_h() on the current screen handle.
+*/
+void SSD1306_draw_fill_triangle(uint8_t x0, uint8_t x1, uint8_t x2, uint8_t y0, uint8_t y1, uint8_t y2, bool color)
+{
+    SSD1306_draw_fill_triangle_h(_screen_h, x0, x1, x2, y0, y1, y2, color);
+}
+
+/*!
+    @brief    SSD1306_draw_circle_h() on the current screen handle.
+*/
+void SSD1306_draw_circle(uint8_t x, uint8_t y, uint8_t r, bool color)
+{
+    SSD1306_draw_circle_h(_screen_h, x, y, r, color);
+}
+
+/*!
+    @brief    SSD1306_draw_fill_circle_h() on the current screen handle.
+*/
+void SSD1306_draw_fill_circle(uint8_t x0, uint8_t y0, uint8_t r, bool color)
+{
+    SSD1306_draw_fill_circle_h(_screen_h, x0, y0, r, color);
+}
+
+/*!
+    @brief    SSD1306_draw_round_rect_h() on the current screen handle.
+*/
+void SSD1306_draw_round_rect(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, bool color, bool fill)
+{
+    SSD1306_draw_round_rect_h(_screen_h, x1, y1, x2, y2, color, fill);
+}
+
+/*!
+    @brief    SSD1306_draw_bitmap_h() on the current screen handle.
+*/
+void SSD1306_draw_bitmap(const uint8_t *bitmap, uint8_t x0, uint8_t y0, uint8_t len_x, uint8_t len_y, uint8_t scale)
+{
+    SSD1306_draw_bitmap_h(_screen_h, bitmap, x0, y0, len_x, len_y, scale);
+}
+
+/*!
+    @brief    SSD1306_draw_bitmap_q8_h() on the current screen handle.
+*/
+void SSD1306_draw_bitmap_q8(const uint8_t *bitmap, uint8_t x0, uint8_t y0, uint8_t len_x, uint8_t len_y, uint16_t scale)
+{
+    SSD1306_draw_bitmap_q8_h(_screen_h, bitmap, x0, y0, len_x, len_y, scale);
+}
+
+/*!
+    @brief    SSD1306_draw_bitmap_opt8_h() on the current screen handle.
+*/
+void SSD1306_draw_bitmap_opt8(const uint8_t *bitmap, uint8_t x0, uint8_t y0, uint8_t len_x, uint8_t len_y)
+{
+    SSD1306_draw_bitmap_opt8_h(_screen_h, bitmap, x0, y0, len_x, len_y);
+}
+
+/*!
+    @brief    SSD1306_draw_bitmap_rle_h() on the current screen handle.
+*/
+void SSD1306_draw_bitmap_rle(const uint8_t *rle, uint8_t x0, uint8_t y0, uint8_t len_x, uint8_t len_y)
+{
+    SSD1306_draw_bitmap_rle_h(_screen_h, rle, x0, y0, len_x, len_y);
+}
+
+/*!
+    @brief    SSD1306_sprite_add_h() on the current screen handle.
+*/
+bool SSD1306_sprite_add(ssd_1306_sprite_t *sprite)
+{
+    return SSD1306_sprite_add_h(_screen_h, sprite);
+}
+
+/*!
+    @brief    SSD1306_sprite_remove_h() on the current screen handle.
+*/
+void SSD1306_sprite_remove(ssd_1306_sprite_t *sprite)
+{
+    SSD1306_sprite_remove_h(_screen_h, sprite);
+}
+
+/*!
+    @brief    SSD1306_sprites_erase_h() on the current screen handle.
+*/
+void SSD1306_sprites_erase(void)
+{
+    SSD1306_sprites_erase_h(_screen_h);
+}
+
+/*!
+    @brief    SSD1306_sprites_draw_h() on the current screen handle.
+*/
+void SSD1306_sprites_draw(void)
+{
+    SSD1306_sprites_draw_h(_screen_h);
+}
+
+/*!
+    @brief    SSD1306_coord_h() on the current screen handle.
+*/
+void SSD1306_coord(uint8_t x, uint8_t y)
+{
+    SSD1306_coord_h(_screen_h, x, y);
+}
+
+/*!
+    @brief    SSD1306_print_str_h() on the current screen handle.
+*/
+void SSD1306_print_str(const char *str, uint8_t option, bool invert)
+{
+    SSD1306_print_str_h(_screen_h, str, option, invert);
+}
+
+/*!
+    @brief    SSD1306_print_fstr_h() on the current screen handle.
+*/
+void SSD1306_print_fstr(const char *str, uint8_t option, uint8_t x, uint8_t y, uint8_t scale, bool invert)
+{
+    SSD1306_print_fstr_h(_screen_h, str, option, x, y, scale, invert);
+}
+
+/*!
+    @brief    SSD1306_print_fstr_q8_h() on the current screen handle.
+*/
+void SSD1306_print_fstr_q8(const char *str, uint8_t option, uint8_t x, uint8_t y, uint16_t scale, bool invert)
+{
+    SSD1306_print_fstr_q8_h(_screen_h, str, option, x, y, scale, invert);
+}
+
+/*!
+    @brief    SSD1306_print_str_font_h() on the current screen handle.
+*/
+void SSD1306_print_str_font(const char *str, const ssd_1306_font_t *font, bool invert)
+{
+    SSD1306_print_str_font_h(_screen_h, str, font, invert);
+}
+
+/*!
+    @brief    SSD1306_print_fstr_font_h() on the current screen handle.
+*/
+void SSD1306_print_fstr_font(const char *str, const ssd_1306_font_t *font, uint8_t x, uint8_t y, uint8_t scale, bool invert)
+{
+    SSD1306_print_fstr_font_h(_screen_h, str, font, x, y, scale, invert);
+}
+
+/*!
+    @brief    SSD1306_text_draw_h() on the current screen handle.
+*/
+void SSD1306_text_draw(const ssd_1306_text_box_t *box, bool invert)
+{
+    SSD1306_text_draw_h(_screen_h, box, invert);
+}
+
+/*!
+    @brief    SSD1306_print_num_h() on the current screen handle.
+*/
+void SSD1306_print_num(int32_t value, uint8_t decimals, const uint8_t *font, uint8_t x, uint8_t y, bool invert)
+{
+    SSD1306_print_num_h(_screen_h, value, decimals, font, x, y, invert);
+}
+
+/*!
+    @brief    SSD1306_number_update_h() on the current screen handle.
+*/
+uint8_t SSD1306_number_update(ssd_1306_number_t *num, int32_t value)
+{
+    return SSD1306_number_update_h(_screen_h, num, value);
+}
+
+/*!
+    @brief    SSD1306_vprintf_h() on the current screen handle.
+*/
+void SSD1306_vprintf(uint8_t option, bool invert, const char *fmt, va_list args)
+{
+    SSD1306_vprintf_h(_screen_h, option, invert, fmt, args);
+}
+
+/*!
+    @brief    SSD1306_printf_h() on the current screen handle.
+*/
+void SSD1306_printf(uint8_t option, bool invert, const char *fmt, ...)
+{
+    va_list args;
+
+    va_start(args, fmt);
+    SSD1306_vprintf_h(_screen_h, option, invert, fmt, args);
+    va_end(args);
+}
@@ -320,6 +320,322 @@ const uint8_t large_font[] =
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00    // del character in our case is a space
 };
 
+/* Proportional variant of the medium font - The glyphs without their blank columns */
+static const uint8_t medium_prop_bitmap[] =
+{
+    0x00, 0x00,                    // 20
+    0x5f,                          // 21 !
+    0x07, 0x00, 0x07,              // 22 "
+    0x14, 0x7f, 0x14, 0x7f, 0x14,  // 23 #
+    0x24, 0x2a, 0x7f, 0x2a, 0x12,  // 24 $
+    0x23, 0x13, 0x08, 0x64, 0x62,  // 25 %
+    0x36, 0x49, 0x55, 0x22, 0x50,  // 26 &
+    0x05, 0x03,                    // 27 '
+    0x1c, 0x22, 0x41,              // 28 (
+    0x41, 0x22, 0x1c,              // 29 )
+    0x14, 0x08, 0x3e, 0x08, 0x14,  // 2a *
+    0x08, 0x08, 0x3e, 0x08, 0x08,  // 2b +
+    0x50, 0x30,                    // 2c ,
+    0x08, 0x08, 0x08, 0x08, 0x08,  // 2d -
+    0x60, 0x60,                    // 2e .
+    0x20, 0x10, 0x08, 0x04, 0x02,  // 2f /
+    0x3e, 0x51, 0x49, 0x45, 0x3e,  // 30 0
+    0x42, 0x7f, 0x40,              // 31 1
+    0x42, 0x61, 0x51, 0x49, 0x46,  // 32 2
+    0x21, 0x41, 0x45, 0x4b, 0x31,  // 33 3
+    0x18, 0x14, 0x12, 0x7f, 0x10,  // 34 4
+    0x27, 0x45, 0x45, 0x45, 0x39,  // 35 5
+    0x3c, 0x4a, 0x49, 0x49, 0x30,  // 36 6
+    0x01, 0x71, 0x09, 0x05, 0x03,  // 37 7
+    0x36, 0x49, 0x49, 0x49, 0x36,  // 38 8
+    0x06, 0x49, 0x49, 0x29, 0x1e,  // 39 9
+    0x36, 0x36,                    // 3a :
+    0x56, 0x36,                    // 3b ;
+    0x08, 0x14, 0x22, 0x41,        // 3c <
+    0x14, 0x14, 0x14, 0x14, 0x14,  // 3d =
+    0x41, 0x22, 0x14, 0x08,        // 3e >
+    0x02, 0x01, 0x51, 0x09, 0x06,  // 3f ?
+    0x32, 0x49, 0x79, 0x41, 0x3e,  // 40 @
+    0x7e, 0x11, 0x11, 0x11, 0x7e,  // 41 A
+    0x7f, 0x49, 0x49, 0x49, 0x36,  // 42 B
+    0x3e, 0x41, 0x41, 0x41, 0x22,  // 43 C
+    0x7f, 0x41, 0x41, 0x22, 0x1c,  // 44 D
+    0x7f, 0x49, 0x49, 0x49, 0x41,  // 45 E
+    0x7f, 0x09, 0x09, 0x09, 0x01,  // 46 F
+    0x3e, 0x41, 0x49, 0x49, 0x7a,  // 47 G
+    0x7f, 0x08, 0x08, 0x08, 0x7f,  // 48 H
+    0x41, 0x7f, 0x41,              // 49 I
+    0x20, 0x40, 0x41, 0x3f, 0x01,  // 4a J
+    0x7f, 0x08, 0x14, 0x22, 0x41,  // 4b K
+    0x7f, 0x40, 0x40, 0x40, 0x40,  // 4c L
+    0x7f, 0x02, 0x0c, 0x02, 0x7f,  // 4d M
+    0x7f, 0x04, 0x08, 0x10, 0x7f,  // 4e N
+    0x3e, 0x41, 0x41, 0x41, 0x3e,  // 4f O
+    0x7f, 0x09, 0x09, 0x09, 0x06,  // 50 P
+    0x3e, 0x41, 0x51, 0x21, 0x5e,  // 51 Q
+    0x7f, 0x09, 0x19, 0x29, 0x46,  // 52 R
+    0x46, 0x49, 0x49, 0x49, 0x31,  // 53 S
+    0x01, 0x01, 0x7f, 0x01, 0x01,  // 54 T
+    0x3f, 0x40, 0x40, 0x40, 0x3f,  // 55 U
+    0x1f, 0x20, 0x40, 0x20, 0x1f,  // 56 V
+    0x3f, 0x40, 0x38, 0x40, 0x3f,  // 57 W
+    0x63, 0x14, 0x08, 0x14, 0x63,  // 58 X
+    0x07, 0x08, 0x70, 0x08, 0x07,  // 59 Y
+    0x61, 0x51, 0x49, 0x45, 0x43,  // 5a Z
+    0x7f, 0x41, 0x41,              // 5b [
+    0x02, 0x04, 0x08, 0x10, 0x20,  // 5c Backslash
+    0x41, 0x41, 0x7f,              // 5d ]
+    0x04, 0x02, 0x01, 0x02, 0x04,  // 5e ^
+    0x40, 0x40, 0x40, 0x40, 0x40,  // 5f _
+    0x01, 0x02, 0x04,              // 60 `
+    0x20, 0x54, 0x54, 0x54, 0x78,  // 61 a
+    0x7f, 0x48, 0x44, 0x44, 0x38,  // 62 b
+    0x38, 0x44, 0x44, 0x44, 0x20,  // 63 c
+    0x38, 0x44, 0x44, 0x48, 0x7f,  // 64 d
+    0x38, 0x54, 0x54, 0x54, 0x18,  // 65 e
+    0x08, 0x7e, 0x09, 0x01, 0x02,  // 66 f
+    0x0c, 0x52, 0x52, 0x52, 0x3e,  // 67 g
+    0x7f, 0x08, 0x04, 0x04, 0x78,  // 68 h
+    0x44, 0x7d, 0x40,              // 69 i
+    0x20, 0x40, 0x44, 0x3d,        // 6a j
+    0x7f, 0x10, 0x28, 0x44,        // 6b k
+    0x41, 0x7f, 0x40,              // 6c l
+    0x7c, 0x04, 0x18, 0x04, 0x78,  // 6d m
+    0x7c, 0x08, 0x04, 0x04, 0x78,  // 6e n
+    0x38, 0x44, 0x44, 0x44, 0x38,  // 6f o
+    0x7c, 0x14, 0x14, 0x14, 0x08,  // 70 p
+    0x08, 0x14, 0x14, 0x18, 0x7c,  // 71 q
+    0x7c, 0x08, 0x04, 0x04, 0x08,  // 72 r
+    0x48, 0x54, 0x54, 0x54, 0x20,  // 73 s
+    0x04, 0x3f, 0x44, 0x40, 0x20,  // 74 t
+    0x3c, 0x40, 0x40, 0x20, 0x7c,  // 75 u
+    0x1c, 0x20, 0x40, 0x20, 0x1c,  // 76 v
+    0x3c, 0x40, 0x30, 0x40, 0x3c,  // 77 w
+    0x44, 0x28, 0x10, 0x28, 0x44,  // 78 x
+    0x0c, 0x50, 0x50, 0x50, 0x3c,  // 79 y
+    0x44, 0x64, 0x54, 0x4c, 0x44,  // 7a z
+    0x08, 0x36, 0x41,              // 7b {
+    0x7f,                          // 7c |
+    0x41, 0x36, 0x08,              // 7d }
+    0x06, 0x09, 0x09, 0x06,        // 7e degree sign
+    0x44, 0x44, 0x5f, 0x44, 0x44,  // b1 plus-minus
+    0x09, 0x0d, 0x0a,              // b2 superscript two
+    0x7e, 0x10, 0x20, 0x30, 0x1e,  // b5 micro sign
+    0x22, 0x14, 0x08, 0x14, 0x22,  // d7 multiplication sign
+    0x08, 0x08, 0x2a, 0x08, 0x08,  // f7 division sign
+    0x70, 0x4c, 0x43, 0x4c, 0x70,  // 394 Greek capital delta
+    0x4e, 0x71, 0x01, 0x71, 0x4e,  // 3a9 Greek capital omega
+    0x04, 0x7c, 0x04, 0x3c, 0x44,  // 3c0 Greek small pi
+    0x08, 0x1c, 0x2a, 0x08, 0x08,  // 2190 leftwards arrow
+    0x04, 0x02, 0x7f, 0x02, 0x04,  // 2191 upwards arrow
+    0x08, 0x08, 0x2a, 0x1c, 0x08,  // 2192 rightwards arrow
+    0x10, 0x20, 0x7f, 0x20, 0x10,  // 2193 downwards arrow
+};
+
+static const ssd_1306_glyph_t medium_prop_glyphs[] =
+{
+    {0, 2}, {2, 1}, {3, 3}, {6, 5}, {11, 5}, {16, 5}, {21, 5}, {26, 2},
+    {28, 3}, {31, 3}, {34, 5}, {39, 5}, {44, 2}, {46, 5}, {51, 2}, {53, 5},
+    {58, 5}, {63, 3}, {66, 5}, {71, 5}, {76, 5}, {81, 5}, {86, 5}, {91, 5},
+    {96, 5}, {101, 5}, {106, 2}, {108, 2}, {110, 4}, {114, 5}, {119, 4}, {123, 5},
+    {128, 5}, {133, 5}, {138, 5}, {143, 5}, {148, 5}, {153, 5}, {158, 5}, {163, 5},
+    {168, 5}, {173, 3}, {176, 5}, {181, 5}, {186, 5}, {191, 5}, {196, 5}, {201, 5},
+    {206, 5}, {211, 5}, {216, 5}, {221, 5}, {226, 5}, {231, 5}, {236, 5}, {241, 5},
+    {246, 5}, {251, 5}, {256, 5}, {261, 3}, {264, 5}, {269, 3}, {272, 5}, {277, 5},
+    {282, 3}, {285, 5}, {290, 5}, {295, 5}, {300, 5}, {305, 5}, {310, 5}, {315, 5},
+    {320, 5}, {325, 3}, {328, 4}, {332, 4}, {336, 3}, {339, 5}, {344, 5}, {349, 5},
+    {354, 5}, {359, 5}, {364, 5}, {369, 5}, {374, 5}, {379, 5}, {384, 5}, {389, 5},
+    {394, 5}, {399, 5}, {404, 5}, {409, 3}, {412, 1}, {413, 3}, {416, 4},
+    /* Ranges - The degree sign and the Greek mu share the bitmaps of '~' and of the micro sign */
+    {416, 4}, {420, 5}, {425, 3}, {428, 5}, {433, 5}, {438, 5}, {443, 5}, {448, 5},
+    {428, 5}, {453, 5}, {458, 5}, {463, 5}, {468, 5}, {473, 5}
+};
+
+/* Pairs whose facing sides leave room - Sorted by first then second character */
+static const ssd_1306_kern_t medium_prop_kerning[] =
+{
+    {'A', 'T', -1}, {'A', 'V', -1}, {'A', 'Y', -1}, {'F', ',', -1}, {'F', '.', -1}, {'L', ',', -1},
+    {'L', '.', -1}, {'L', 'T', -1}, {'L', 'V', -1}, {'L', 'Y', -1}, {'P', ',', -1}, {'P', '.', -1},
+    {'T', ',', -1}, {'T', '.', -1}, {'T', 'A', -1}, {'V', ',', -1}, {'V', '.', -1}, {'V', 'A', -1},
+    {'Y', ',', -1}, {'Y', '.', -1}, {'Y', 'A', -1}, {'r', ',', -1}, {'r', '.', -1}
+};
+
+/* Latin-1 signs, Greek letters and arrows - Sorted by code point */
+static const ssd_1306_range_t medium_prop_ranges[] =
+{
+    {0x00b0, 0x00b2, 95}, {0x00b5, 0x00b5, 98}, {0x00d7, 0x00d7, 99}, {0x00f7, 0x00f7, 100},
+    {0x0394, 0x0394, 101}, {0x03a9, 0x03a9, 102}, {0x03bc, 0x03bc, 103}, {0x03c0, 0x03c0, 104},
+    {0x2190, 0x2193, 105}
+};
+
+const ssd_1306_font_t medium_prop_font =
+{
+    .bitmap = medium_prop_bitmap,
+    .glyphs = medium_prop_glyphs,
+    .kerning = medium_prop_kerning,
+    .ranges = medium_prop_ranges,
+    .nb_kerning = sizeof(medium_prop_kerning) / sizeof(medium_prop_kerning[0]),
+    .nb_ranges = sizeof(medium_prop_ranges) / sizeof(medium_prop_ranges[0]),
+    .first = 0x20,
+    .last = 0x7e,
+    .height = 7,
+    .spacing = 1
+};
+
+/* Narrow proportional font - Glyphs mostly 3 columns wide, to fit more text on a line than the medium fonts */
+static const uint8_t narrow_prop_bitmap[] =
+{
+    0x00,                          // 20
+    0x5f,                          // 21 !
+    0x03, 0x00, 0x03,              // 22 "
+    0x14, 0x7f, 0x14, 0x7f, 0x14,  // 23 #
+    0x24, 0x6b, 0x12,              // 24 $
+    0x61, 0x1c, 0x43,              // 25 %
+    0x36, 0x49, 0x36, 0x50,        // 26 &
+    0x03,                          // 27 '
+    0x3e, 0x41,                    // 28 (
+    0x41, 0x3e,                    // 29 )
+    0x2a, 0x1c, 0x2a,              // 2a *
+    0x08, 0x1c, 0x08,              // 2b +
+    0x40, 0x20,                    // 2c ,
+    0x08, 0x08, 0x08,              // 2d -
+    0x40,                          // 2e .
+    0x60, 0x1c, 0x03,              // 2f /
+    0x7f, 0x41, 0x7f,              // 30 0
+    0x42, 0x7f, 0x40,              // 31 1
+    0x71, 0x49, 0x46,              // 32 2
+    0x41, 0x49, 0x36,              // 33 3
+    0x0f, 0x08, 0x7f,              // 34 4
+    0x4f, 0x49, 0x31,              // 35 5
+    0x3e, 0x49, 0x31,              // 36 6
+    0x01, 0x79, 0x07,              // 37 7
+    0x36, 0x49, 0x36,              // 38 8
+    0x46, 0x49, 0x3e,              // 39 9
+    0x24,                          // 3a :
+    0x40, 0x24,                    // 3b ;
+    0x08, 0x14, 0x22,              // 3c <
+    0x14, 0x14, 0x14,              // 3d =
+    0x22, 0x14, 0x08,              // 3e >
+    0x01, 0x59, 0x06,              // 3f ?
+    0x3e, 0x41, 0x5d, 0x55, 0x1e,  // 40 @
+    0x7e, 0x09, 0x7e,              // 41 A
+    0x7f, 0x49, 0x36,              // 42 B
+    0x3e, 0x41, 0x41,              // 43 C
+    0x7f, 0x41, 0x3e,              // 44 D
+    0x7f, 0x49, 0x41,              // 45 E
+    0x7f, 0x09, 0x01,              // 46 F
+    0x3e, 0x41, 0x79,              // 47 G
+    0x7f, 0x08, 0x7f,              // 48 H
+    0x41, 0x7f, 0x41,              // 49 I
+    0x20, 0x40, 0x3f,              // 4a J
+    0x7f, 0x14, 0x63,              // 4b K
+    0x7f, 0x40, 0x40,              // 4c L
+    0x7f, 0x02, 0x0c, 0x02, 0x7f,  // 4d M
+    0x7f, 0x06, 0x18, 0x7f,        // 4e N
+    0x3e, 0x41, 0x3e,              // 4f O
+    0x7f, 0x09, 0x06,              // 50 P
+    0x3e, 0x61, 0x5e,              // 51 Q
+    0x7f, 0x19, 0x66,              // 52 R
+    0x46, 0x49, 0x31,              // 53 S
+    0x01, 0x7f, 0x01,              // 54 T
+    0x3f, 0x40, 0x3f,              // 55 U
+    0x1f, 0x60, 0x1f,              // 56 V
+    0x7f, 0x20, 0x18, 0x20, 0x7f,  // 57 W
+    0x63, 0x1c, 0x63,              // 58 X
+    0x07, 0x78, 0x07,              // 59 Y
+    0x71, 0x49, 0x47,              // 5a Z
+    0x7f, 0x41,                    // 5b [
+    0x03, 0x1c, 0x60,              // 5c Backslash
+    0x41, 0x7f,                    // 5d ]
+    0x02, 0x01, 0x02,              // 5e ^
+    0x40, 0x40, 0x40,              // 5f _
+    0x01, 0x02,                    // 60 `
+    0x24, 0x54, 0x78,              // 61 a
+    0x7f, 0x44, 0x38,              // 62 b
+    0x38, 0x44, 0x44,              // 63 c
+    0x38, 0x44, 0x7f,              // 64 d
+    0x38, 0x54, 0x58,              // 65 e
+    0x04, 0x7f, 0x05,              // 66 f
+    0x48, 0x54, 0x3c,              // 67 g
+    0x7f, 0x04, 0x78,              // 68 h
+    0x7d,                          // 69 i
+    0x40, 0x3d,                    // 6a j
+    0x7f, 0x10, 0x6c,              // 6b k
+    0x7f,                          // 6c l
+    0x7c, 0x04, 0x78, 0x04, 0x78,  // 6d m
+    0x7c, 0x04, 0x78,              // 6e n
+    0x38, 0x44, 0x38,              // 6f o
+    0x7c, 0x14, 0x08,              // 70 p
+    0x08, 0x14, 0x7c,              // 71 q
+    0x7c, 0x08, 0x04,              // 72 r
+    0x48, 0x54, 0x24,              // 73 s
+    0x04, 0x3f, 0x44,              // 74 t
+    0x3c, 0x40, 0x7c,              // 75 u
+    0x1c, 0x60, 0x1c,              // 76 v
+    0x3c, 0x40, 0x30, 0x40, 0x3c,  // 77 w
+    0x6c, 0x10, 0x6c,              // 78 x
+    0x4c, 0x50, 0x3c,              // 79 y
+    0x64, 0x54, 0x4c,              // 7a z
+    0x08, 0x36, 0x41,              // 7b {
+    0x7f,                          // 7c |
+    0x41, 0x36, 0x08,              // 7d }
+    0x02, 0x05, 0x02,              // 7e degree sign
+    0x24, 0x2e, 0x24,              // b1 plus-minus
+    0x09, 0x0d, 0x0a,              // b2 superscript two
+    0x7c, 0x20, 0x3c,              // b5 micro sign
+    0x14, 0x08, 0x14,              // d7 multiplication sign
+    0x08, 0x2a, 0x08,              // f7 division sign
+    0x70, 0x4c, 0x43, 0x4c, 0x70,  // 394 Greek capital delta
+    0x4e, 0x71, 0x01, 0x71, 0x4e,  // 3a9 Greek capital omega
+    0x04, 0x7c, 0x04, 0x7c,        // 3c0 Greek small pi
+    0x08, 0x1c, 0x2a, 0x08, 0x08,  // 2190 leftwards arrow
+    0x02, 0x3f, 0x02,              // 2191 upwards arrow
+    0x08, 0x08, 0x2a, 0x1c, 0x08,  // 2192 rightwards arrow
+    0x20, 0x7e, 0x20,              // 2193 downwards arrow
+};
+
+static const ssd_1306_glyph_t narrow_prop_glyphs[] =
+{
+    {0, 1}, {1, 1}, {2, 3}, {5, 5}, {10, 3}, {13, 3}, {16, 4}, {20, 1},
+    {21, 2}, {23, 2}, {25, 3}, {28, 3}, {31, 2}, {33, 3}, {36, 1}, {37, 3},
+    {40, 3}, {43, 3}, {46, 3}, {49, 3}, {52, 3}, {55, 3}, {58, 3}, {61, 3},
+    {64, 3}, {67, 3}, {70, 1}, {71, 2}, {73, 3}, {76, 3}, {79, 3}, {82, 3},
+    {85, 5}, {90, 3}, {93, 3}, {96, 3}, {99, 3}, {102, 3}, {105, 3}, {108, 3},
+    {111, 3}, {114, 3}, {117, 3}, {120, 3}, {123, 3}, {126, 5}, {131, 4}, {135, 3},
+    {138, 3}, {141, 3}, {144, 3}, {147, 3}, {150, 3}, {153, 3}, {156, 3}, {159, 5},
+    {164, 3}, {167, 3}, {170, 3}, {173, 2}, {175, 3}, {178, 2}, {180, 3}, {183, 3},
+    {186, 2}, {188, 3}, {191, 3}, {194, 3}, {197, 3}, {200, 3}, {203, 3}, {206, 3},
+    {209, 3}, {212, 1}, {213, 2}, {215, 3}, {218, 1}, {219, 5}, {224, 3}, {227, 3},
+    {230, 3}, {233, 3}, {236, 3}, {239, 3}, {242, 3}, {245, 3}, {248, 3}, {251, 5},
+    {256, 3}, {259, 3}, {262, 3}, {265, 3}, {268, 1}, {269, 3}, {272, 3},
+    /* Ranges - The degree sign and the Greek mu share the bitmaps of '~' and of the micro sign */
+    {272, 3}, {275, 3}, {278, 3}, {281, 3}, {284, 3}, {287, 3}, {290, 5}, {295, 5},
+    {281, 3}, {300, 4}, {304, 5}, {309, 3}, {312, 5}, {317, 3}
+};
+
+/* Pairs whose facing sides leave room - Sorted by first then second character */
+static const ssd_1306_kern_t narrow_prop_kerning[] =
+{
+    {'A', 'T', -1}, {'F', ',', -1}, {'F', '.', -1}, {'L', 'T', -1}, {'L', 'V', -1}, {'L', 'Y', -1},
+    {'P', ',', -1}, {'P', '.', -1}, {'T', ',', -1}, {'T', '.', -1}, {'T', 'A', -1}, {'T', 'a', -1},
+    {'T', 'c', -1}, {'T', 'e', -1}, {'T', 'o', -1}, {'T', 's', -1}, {'T', 'u', -1}, {'V', ',', -1},
+    {'V', '.', -1}, {'Y', ',', -1}, {'Y', '.', -1}, {'r', ',', -1}, {'r', '.', -1}
+};
+
+const ssd_1306_font_t narrow_prop_font =
+{
+    .bitmap = narrow_prop_bitmap,
+    .glyphs = narrow_prop_glyphs,
+    .kerning = narrow_prop_kerning,
+    .ranges = medium_prop_ranges, /* Same characters, at the same glyph indices */
+    .nb_kerning = sizeof(narrow_prop_kerning) / sizeof(narrow_prop_kerning[0]),
+    .nb_ranges = sizeof(medium_prop_ranges) / sizeof(medium_prop_ranges[0]),
+    .first = 0x20,
+    .last = 0x7e,
+    .height = 7,
+    .spacing = 1
+};
+
 const uint8_t MediumNumbers[] =
 {
     /* Width, Height, Offset, Number */
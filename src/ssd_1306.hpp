@@ -0,0 +1,427 @@
+/* Define to prevent recursive inclusion */
+#ifndef __SSD_1306_HPP
+#define __SSD_1306_HPP
+
+/* Includes */
+#include <stdint.h>
+#include <string.h>
+#include "ssd_1306.h"
+
+/* Header-only C++ front end of the library (C++11) - The page math is constexpr and the pixel
+ * primitives are inline, so that they fold into the caller's loops. Everything else goes to the C routines. */
+namespace ssd1306
+{
+
+/*!
+    @brief    Pen of the raster operations - Masks applied to every byte that a primitive draws,
+    the same merge as the library routines.
+*/
+struct Pen
+{
+    uint8_t clear;      /* Bits cleared */
+    uint8_t flip;       /* Bits inverted after that */
+
+    /*!
+        @brief    Sets up the pen for a row mask.
+        @param    rop       The raster operation, one of SSD1306_ROP_xxx
+        @param    mask      The bits to draw
+        @param    color     Black(True) or White(False).
+    */
+    inline Pen(uint8_t rop, uint8_t mask, bool color)
+    {
+        const uint8_t src = color ? mask : 0x00;
+
+        clear = ((rop == SSD1306_ROP_COPY) ? mask : 0x00) |
+                (((rop == SSD1306_ROP_OR) || (rop == SSD1306_ROP_AND_NOT)) ? src : 0x00);
+        flip = (rop == SSD1306_ROP_AND_NOT) ? 0x00 : src;
+    }
+
+    inline uint8_t operator()(uint8_t dst) const
+    {
+        return (dst & ~clear) ^ flip;
+    }
+};
+
+/*!
+    @brief    Bits of a page between two rows.
+    @param    page      The page
+    @param    y0        First row
+    @param    y1        Last row, in the same page or past it
+    @return             The mask of the rows.
+*/
+inline uint8_t page_mask(uint8_t page, uint8_t y0, uint8_t y1)
+{
+    uint8_t mask = 0xff;
+
+    if((y0 >> 3) == page) mask &= 0xff << (y0 & 0x07);
+    if((y1 >> 3) == page) mask &= 0xff >> (0x07 - (y1 & 0x07));
+
+    return mask;
+}
+
+/*!
+    @brief    A buffer of W x H pixels, page by page like the screen and SSD1306_draw_bitmap().
+    It can be drawn offscreen and then blitted with Display::blit(), or used as a bitmap by the C routines.
+*/
+template<uint8_t W, uint8_t H>
+class Framebuffer
+{
+public:
+    static constexpr uint8_t width = W;
+    static constexpr uint8_t height = H;
+    static constexpr uint8_t pages = (H + 7) / 8;
+    static constexpr uint16_t stride = W;   /* Bytes from a page to the next */
+    static constexpr uint16_t size = (uint16_t)W * pages;
+
+    static_assert(W > 0 && H > 0, "Framebuffer - Empty geometry");
+
+    /*!
+        @brief    Position of a pixel's byte in the buffer.
+    */
+    static constexpr uint16_t index(uint8_t x, uint8_t y)
+    {
+        return (uint16_t)(y >> 3) * stride + x;
+    }
+
+    /*!
+        @brief    Bit of a pixel in its byte.
+    */
+    static constexpr uint8_t bit(uint8_t y)
+    {
+        return (uint8_t)(1 << (y & 0x07));
+    }
+
+    uint8_t *data() { return buffer; }
+    const uint8_t *data() const { return buffer; }
+
+    /*!
+        @brief    Fills the buffer with a color.
+        @param    black     Fill with black(true) or with white(false).
+    */
+    void fill(bool black)
+    {
+        memset(buffer, black ? 0xff : 0x00, size);
+    }
+
+    /*!
+        @brief    Set a pixel's value, out of the buffer is skipped.
+        @param    x         x-coordinate
+        @param    y         y-coordinate
+        @param    color     Black(True) or White(False).
+    */
+    inline void set_pixel(uint8_t x, uint8_t y, bool color)
+    {
+        if(x >= W || y >= H) return;
+
+        if(color) buffer[index(x, y)] |= bit(y);
+        else buffer[index(x, y)] &= ~bit(y);
+    }
+
+    /*!
+        @brief    Returns a pixel's value.
+        @return   False out of the buffer, otherwise the pixel.
+    */
+    inline bool get_pixel(uint8_t x, uint8_t y) const
+    {
+        return (x < W && y < H) && (buffer[index(x, y)] & bit(y));
+    }
+
+    /*!
+        @brief    Draw a horizontal line, cut to the buffer.
+        @param    x         x-coordinate
+        @param    y         y-coordinate
+        @param    len       Length of the line
+        @param    color     Black(True) or White(False).
+    */
+    inline void draw_hline(uint8_t x, uint8_t y, uint8_t len, bool color)
+    {
+        if(x >= W || y >= H) return;
+        if(len > W - x) len = W - x;
+
+        const Pen pen(SSD1306_ROP_COPY, bit(y), color);
+        uint8_t *dst = buffer + index(x, y);
+
+        for(uint8_t i = 0; i < len; i++) dst[i] = pen(dst[i]);
+    }
+
+    /*!
+        @brief    Draw a vertical line, cut to the buffer.
+        @param    x         x-coordinate
+        @param    y         y-coordinate
+        @param    len       Length of the line
+        @param    color     Black(True) or White(False).
+    */
+    inline void draw_vline(uint8_t x, uint8_t y, uint8_t len, bool color)
+    {
+        if(x >= W || y >= H || !len) return;
+        if(len > H - y) len = H - y;
+
+        const uint8_t y1 = y + len - 1;
+
+        for(uint8_t page = y >> 3; page <= (y1 >> 3); page++)
+        {
+            const Pen pen(SSD1306_ROP_COPY, page_mask(page, y, y1), color);
+            buffer[(uint16_t)page * stride + x] = pen(buffer[(uint16_t)page * stride + x]);
+        }
+    }
+
+private:
+    uint8_t buffer[size];
+};
+
+/* Transports - How a display is reached, as a type. A transport derives from Polling or Dma, which must
+ * match SSD1306_DMA_ACTIVE, and wires the handle:
+ *
+ *     struct Board : ssd1306::Polling
+ *     {
+ *         static void wire(ssd_1306_t &h) { h.h_spi = &hspi2; h.ce_port = GPIOB; ... }
+ *     };
+ *
+ * A host build wires the handle to its own HAL mock the same way. */
+struct Polling
+{
+    static constexpr bool dma = false;
+};
+
+struct Dma
+{
+    static constexpr bool dma = true;
+};
+
+/*!
+    @brief    A screen - Owns the handle and its buffer. The pixel primitives are inline and follow the draw
+    mode and the strip clipping, like the C routines. The rest of the library takes handle().
+*/
+template<typename Transport>
+class Display
+{
+public:
+    typedef Framebuffer<SSD1306_WIDTH, SSD1306_HEIGHT> Frame;
+
+#ifdef SSD1306_DMA_ACTIVE
+    static_assert(Transport::dma, "Display - The library is built for DMA (SSD1306_DMA_ACTIVE)");
+#else
+    static_assert(!Transport::dma, "Display - The library is built for polling (no SSD1306_DMA_ACTIVE)");
+#endif
+
+    Display() = default;
+    Display(const Display &) = delete;
+    Display &operator=(const Display &) = delete;
+
+    /*!
+        @brief    Wires the handle with the transport and initializes the screen.
+        @return   Success(True) or Failure(False) in sending the commands.
+    */
+    bool init()
+    {
+        Transport::wire(h);
+        h.buffer = frame.data();
+
+        return SSD1306_init_h(&h);
+    }
+
+    ssd_1306_t *handle() { return &h; }
+    uint8_t *buffer() { return h.buffer; }
+
+    /*!
+        @brief    Makes this screen the one of the C routines without a handle.
+        @return   The previous screen.
+    */
+    ssd_1306_t *make_current() { return SSD1306_handle_swap(&h); }
+
+    void fill(bool black) { SSD1306_fill_h(&h, black); }
+    void draw_mode(uint8_t rop) { SSD1306_draw_mode_h(&h, rop); }
+
+    /*!
+        @brief    Set a pixel's value.
+        @param    x         x-coordinate
+        @param    y         y-coordinate
+        @param    color     Black(True) or White(False).
+    */
+    inline void set_pixel(uint8_t x, uint8_t y, bool color)
+    {
+        if(x >= SSD1306_WIDTH || clipped(y)) return;
+
+        const Pen pen(h.rop, Frame::bit(y), color);
+        uint8_t *dst = h.buffer + index(x, y);
+
+        *dst = pen(*dst);
+        touch(x, x, y, y);
+    }
+
+    /*!
+        @brief    Returns a pixel's value.
+        @return   In case of error, 0xFF is returned, otherwise true or false.
+    */
+    inline uint8_t get_pixel(uint8_t x, uint8_t y) const
+    {
+        if(x >= SSD1306_WIDTH || clipped(y)) return 0xff;
+
+        return (h.buffer[index(x, y)] & Frame::bit(y)) ? 1 : 0;
+    }
+
+    /*!
+        @brief    Draw a horizontal line.
+        @param    x         x-coordinate
+        @param    y         y-coordinate
+        @param    len       Length of the line
+        @param    color     Black(True) or White(False).
+    */
+    inline void draw_hline(uint8_t x, uint8_t y, uint8_t len, bool color)
+    {
+        if(x >= SSD1306_WIDTH || clipped(y) || !len) return;
+        if(len > SSD1306_WIDTH - x) len = SSD1306_WIDTH - x;
+
+        const Pen pen(h.rop, Frame::bit(y), color);
+        uint8_t *dst = h.buffer + index(x, y);
+
+        for(uint8_t i = 0; i < len; i++) dst[i] = pen(dst[i]);
+        touch(x, x + len - 1, y, y);
+    }
+
+    /*!
+        @brief    Draw a vertical line.
+        @param    x         x-coordinate
+        @param    y         y-coordinate
+        @param    len       Length of the line
+        @param    color     Black(True) or White(False).
+    */
+    inline void draw_vline(uint8_t x, uint8_t y, uint8_t len, bool color)
+    {
+        fill_rect(x, y, 1, len, color);
+    }
+
+    /*!
+        @brief    Draw a filled rectangle.
+        @param    x         Leftmost x-coordinate
+        @param    y         Upper y-coordinate
+        @param    len_x     Width of the rectangle
+        @param    len_y     Height of the rectangle
+        @param    color     Black(True) or White(False).
+    */
+    inline void fill_rect(uint8_t x, uint8_t y, uint8_t len_x, uint8_t len_y, bool color)
+    {
+        /* Cut to the screen, then to the rows of the page being rendered in strip mode */
+        if(x >= SSD1306_WIDTH || y >= SSD1306_HEIGHT || !len_x || !len_y) return;
+        if(len_x > SSD1306_WIDTH - x) len_x = SSD1306_WIDTH - x;
+        if(len_y > SSD1306_HEIGHT - y) len_y = SSD1306_HEIGHT - y;
+
+        uint8_t y0 = (y > h.clip_y0) ? y : h.clip_y0;
+        uint8_t y1 = ((y + len_y - 1) < h.clip_y1) ? (y + len_y - 1) : h.clip_y1;
+        if(y0 > y1) return;
+
+        for(uint8_t page = y0 >> 3; page <= (y1 >> 3); page++)
+        {
+            const Pen pen(h.rop, page_mask(page, y0, y1), color);
+            uint8_t *dst = h.buffer + index(x, page << 3);
+
+            for(uint8_t i = 0; i < len_x; i++) dst[i] = pen(dst[i]);
+        }
+
+        touch(x, x + len_x - 1, y0, y1);
+    }
+
+    /*!
+        @brief    Draws a framebuffer, with the draw mode, like SSD1306_draw_bitmap().
+        @param    image     The framebuffer
+        @param    x0        Leftmost x-coordinate
+        @param    y0        Upper y-coordinate
+    */
+    template<uint8_t W, uint8_t H>
+    void blit(const Framebuffer<W, H> &image, uint8_t x0, uint8_t y0)
+    {
+        SSD1306_draw_bitmap_h(&h, image.data(), x0, y0, W, H, 1);
+    }
+
+    /*!
+        @brief    Renders a frame one page at a time with SSD1306_render_strips(), the draw function
+        (e.g. a lambda) is called once per page.
+        @param    draw      The function drawing the frame
+        @return   Success(True) or Failure(False) in sending the data.
+    */
+    template<typename F>
+    bool render_strips(F draw)
+    {
+        bool ret = SSD1306_render_strips_h(&h, [](void *arg) { (*static_cast<F *>(arg))(); }, &draw);
+
+        /* The buffer held strips, nothing is left to send */
+        untouch();
+        return ret;
+    }
+
+    /*!
+        @brief    Draws the contents of the buffer on the display, see SSD1306_refresh().
+        The area drawn by the inline primitives is passed on first, for the copy to the back buffer.
+        @return   Success(True) or Failure(False) in sending the data.
+    */
+    bool refresh()
+    {
+#ifdef SSD1306_PARTIAL_REFRESH
+        if(dirty_x0 <= dirty_x1) SSD1306_mark_dirty_h(&h, dirty_x0, dirty_x1, dirty_y0, dirty_y1);
+#endif
+        if(!SSD1306_refresh_h(&h)) return false;
+
+        untouch();
+        return true;
+    }
+
+#ifdef SSD1306_PARTIAL_REFRESH
+    /*!
+        @brief    Draws only the modified part of the buffer on the display, see SSD1306_refresh_partial().
+        The area drawn by the inline primitives is passed on first.
+        @return   Success(True) or Failure(False) in sending the data.
+    */
+    bool refresh_partial()
+    {
+        if(dirty_x0 <= dirty_x1) SSD1306_mark_dirty_h(&h, dirty_x0, dirty_x1, dirty_y0, dirty_y1);
+        if(!SSD1306_refresh_partial_h(&h)) return false;
+
+        untouch();
+        return true;
+    }
+#endif
+
+private:
+    ssd_1306_t h = {};
+    Frame frame;
+
+#ifdef SSD1306_PARTIAL_REFRESH
+    /* Area drawn by the inline primitives since the last refresh, empty when x0 > x1 */
+    uint8_t dirty_x0 = 0xff, dirty_x1 = 0, dirty_y0 = 0xff, dirty_y1 = 0;
+#endif
+
+    /* The buffer only holds the page being rendered in strip mode */
+    inline bool clipped(uint8_t y) const
+    {
+        return (y < h.clip_y0) || (y > h.clip_y1);
+    }
+
+    inline uint16_t index(uint8_t x, uint8_t y) const
+    {
+        return Frame::index(x, y) - (uint16_t)h.strip_page * Frame::stride;
+    }
+
+    inline void touch(uint8_t x0, uint8_t x1, uint8_t y0, uint8_t y1)
+    {
+#ifdef SSD1306_PARTIAL_REFRESH
+        if(x0 < dirty_x0) dirty_x0 = x0;
+        if(x1 > dirty_x1) dirty_x1 = x1;
+        if(y0 < dirty_y0) dirty_y0 = y0;
+        if(y1 > dirty_y1) dirty_y1 = y1;
+#else
+        (void)x0; (void)x1; (void)y0; (void)y1;
+#endif
+    }
+
+    inline void untouch()
+    {
+#ifdef SSD1306_PARTIAL_REFRESH
+        dirty_x0 = dirty_y0 = 0xff;
+        dirty_x1 = dirty_y1 = 0;
+#endif
+    }
+};
+
+} /* namespace ssd1306 */
+
+#endif /* __SSD_1306_HPP */
@@ -21,12 +21,56 @@
 #define ALIGN_BOTTOM        0x02
 #define ALIGMENT_MASK       0x03
 
+/* A glyph of a proportional font */
+typedef struct ssd_1306_glyph_struct
+{
+    uint16_t offset;    /* First byte of the glyph in the font's bitmap */
+    uint8_t width;      /* Columns of the glyph, 0 if the font has none for this character */
+}ssd_1306_glyph_t;
+
+/* A kerning pair of a proportional font - Changes the space between two characters */
+typedef struct ssd_1306_kern_struct
+{
+    uint8_t first;      /* The left character */
+    uint8_t second;     /* The right character */
+    int8_t adjust;      /* Columns added to the font's spacing, the glyphs never overlap */
+}ssd_1306_kern_t;
+
+/* A range of characters of a proportional font beyond its main one, such as Greek or arrows */
+typedef struct ssd_1306_range_struct
+{
+    uint16_t first;     /* Code points of the range */
+    uint16_t last;
+    uint16_t glyph;     /* Glyph of the first character */
+}ssd_1306_range_t;
+
+/* A proportional font - Every glyph is a bitmap of its own width, stored bank by bank like SSD1306_draw_bitmap().
+ * The text is in UTF-8, with the characters of the main range and of the extra ranges */
+typedef struct ssd_1306_font_struct
+{
+    const uint8_t *bitmap;              /* The glyph columns */
+    const ssd_1306_glyph_t *glyphs;     /* A glyph per character, from first to last, then those of the ranges */
+    const ssd_1306_kern_t *kerning;     /* Kerning pairs sorted by first then second character, or NULL */
+    const ssd_1306_range_t *ranges;     /* Extra ranges sorted by code point, or NULL */
+    uint16_t nb_kerning;
+    uint8_t nb_ranges;
+    uint8_t first;                      /* Main range of characters in the font */
+    uint8_t last;
+    uint8_t height;                     /* Height of the glyphs in pixels */
+    uint8_t spacing;                    /* Columns between two glyphs */
+}ssd_1306_font_t;
+
 /* PCD8544 Different fonts */
 extern const uint8_t small_font[];
 extern const uint8_t medium_font[];
 extern const uint8_t large_font[];
 
-/* TODO - Still not used */
+/* Proportional fonts */
+extern const ssd_1306_font_t medium_prop_font;
+extern const ssd_1306_font_t narrow_prop_font;
+
+/* Number fonts (-./0123456789) - A header of width, height, first character and number of characters,
+ * followed by the glyphs bank by bank. Drawn by SSD1306_print_num() and the readouts */
 extern const uint8_t MediumNumbers[];
 extern const uint8_t BigNumbers[];
 
@@ -0,0 +1,66 @@
+/*
+ * Writes medium_prop_font as a BDF font on stdout, for tools/ssd1306_assets.py to convert back - test_assets
+ * then checks that the round trip gives the same font.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <ssd_1306.h>
+
+static void glyph_bdf(const ssd_1306_font_t *font, uint32_t code, const ssd_1306_glyph_t *g)
+{
+    printf("STARTCHAR U+%04X\nENCODING %u\nSWIDTH 500 0\nDWIDTH %u 0\nBBX %u %u 0 0\nBITMAP\n",
+           (unsigned)code, (unsigned)code, g->width + font->spacing, g->width, font->height);
+
+    /* A row at a time, the leftmost pixel in the highest bit */
+    for(int row = 0; row < font->height; row++)
+    {
+        for(int byte = 0; byte < (g->width + 7) / 8; byte++)
+        {
+            uint8_t bits = 0;
+
+            for(int bit = 0; bit < 8 && byte * 8 + bit < g->width; bit++)
+            {
+                const uint8_t *col = font->bitmap + g->offset + byte * 8 + bit;
+                if((col[(row / 8) * g->width] >> (row % 8)) & 0x01) bits |= 0x80 >> bit;
+            }
+            printf("%02X", bits);
+        }
+        printf("\n");
+    }
+    printf("ENDCHAR\n");
+}
+
+int main(void)
+{
+    const ssd_1306_font_t *font = &medium_prop_font;
+    int nb = 0, widest = 0;
+
+    for(int i = 0; i <= font->last - font->first; i++)
+    {
+        nb += font->glyphs[i].width != 0;
+        widest = (font->glyphs[i].width > widest) ? font->glyphs[i].width : widest;
+    }
+    for(int r = 0; r < font->nb_ranges; r++) nb += font->ranges[r].last - font->ranges[r].first + 1;
+
+    printf("STARTFONT 2.1\nFONT medium_prop_font\nSIZE %u 75 75\nFONTBOUNDINGBOX %d %u 0 0\n",
+           font->height, widest, font->height);
+    printf("STARTPROPERTIES 2\nFONT_ASCENT %u\nFONT_DESCENT 0\nENDPROPERTIES\nCHARS %d\n", font->height, nb);
+
+    for(int i = 0; i <= font->last - font->first; i++)
+    {
+        if(font->glyphs[i].width) glyph_bdf(font, font->first + i, &font->glyphs[i]);
+    }
+    for(int r = 0; r < font->nb_ranges; r++)
+    {
+        const ssd_1306_range_t *range = &font->ranges[r];
+
+        for(uint32_t code = range->first; code <= range->last; code++)
+        {
+            glyph_bdf(font, code, &font->glyphs[range->glyph + code - range->first]);
+        }
+    }
+
+    printf("ENDFONT\n");
+    return EXIT_SUCCESS;
+}
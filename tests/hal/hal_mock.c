@@ -0,0 +1,269 @@
+/*
+ * Host implementation of the HAL calls used by the library, see mock.h.
+ */
+
+#include <string.h>
+#include "mock.h"
+
+#define MOCK_BUSES      4
+
+/* A DMA transfer in flight on one SPI */
+typedef struct
+{
+    SPI_HandleTypeDef *hspi;
+    uint8_t *data;
+    uint16_t nb_data;
+    int panel;
+    bool dc;
+}mock_dma_t;
+
+mock_panel_t mock_panels[MOCK_PANELS];
+GPIO_TypeDef mock_gpio[MOCK_PANELS];
+SPI_HandleTypeDef *mock_panel_spi[MOCK_PANELS];
+uint32_t mock_spi_bytes, mock_errors, mock_tick;
+bool mock_dma_sync, mock_dma_stall;
+
+static mock_dma_t _dma[MOCK_BUSES];
+static bool _in_isr;
+
+/* Number of argument bytes that follow a command */
+static uint8_t _cmd_args(uint8_t cmd)
+{
+    switch(cmd)
+    {
+        case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3:
+        case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+            return 1;
+        case 0x21: case 0x22: case 0xA3:
+            return 2;
+        case 0x29: case 0x2A:
+            return 5;
+        case 0x26: case 0x27:
+            return 6;
+        default:
+            return 0;
+    }
+}
+
+static void _panel_cmd(mock_panel_t *p, uint8_t byte)
+{
+    p->cmd_bytes++;
+    p->cmd[p->cmd_len++] = byte;
+
+    if(p->cmd_len == 1) p->cmd_need = 1 + _cmd_args(byte);
+    if(p->cmd_len < p->cmd_need) return;
+
+    if(p->cmd[0] == 0x21)
+    {
+        p->col = p->col0 = p->cmd[1] % MOCK_RAM_W;
+        p->col1 = p->cmd[2] % MOCK_RAM_W;
+    }
+    else if(p->cmd[0] == 0x22)
+    {
+        p->page = p->page0 = p->cmd[1] % MOCK_RAM_PAGES;
+        p->page1 = p->cmd[2] % MOCK_RAM_PAGES;
+    }
+    else if(p->cmd[0] == 0x81)
+    {
+        p->contrast = p->cmd[1];
+    }
+    else if(p->cmd[0] == 0xA8)
+    {
+        p->mux = p->cmd[1];
+    }
+    else if(p->cmd[0] == 0xDA)
+    {
+        p->com_pins = p->cmd[1];
+    }
+    else if((p->cmd[0] == 0x26) || (p->cmd[0] == 0x27) || (p->cmd[0] == 0x29) || (p->cmd[0] == 0x2A))
+    {
+        p->scroll_end = p->cmd[4];
+    }
+    p->cmd_len = 0;
+}
+
+static void _panel_data(mock_panel_t *p, uint8_t byte)
+{
+    p->data_bytes++;
+    p->ram[p->page][p->col] = byte;
+
+    /* Horizontal addressing: next column, then wrap to the next page of the window */
+    if(p->col != p->col1)
+    {
+        p->col = (p->col + 1) % MOCK_RAM_W;
+        return;
+    }
+    p->col = p->col0;
+    p->page = (p->page == p->page1) ? p->page0 : (p->page + 1) % MOCK_RAM_PAGES;
+}
+
+static void _panel_reset(mock_panel_t *p)
+{
+    p->col = p->col0 = p->page = p->page0 = 0;
+    p->col1 = MOCK_RAM_W - 1;
+    p->page1 = MOCK_RAM_PAGES - 1;
+    p->cmd_len = 0;
+}
+
+static void _panel_feed(int panel, bool dc, const uint8_t *data, uint16_t nb_data)
+{
+    mock_panel_t *p = &mock_panels[panel];
+
+    for(uint16_t i = 0; i < nb_data; i++)
+    {
+        dc ? _panel_data(p, data[i]) : _panel_cmd(p, data[i]);
+    }
+}
+
+static bool _pin(int panel, uint16_t pin)
+{
+    return mock_gpio[panel].ODR & pin;
+}
+
+/* The panel of the SPI whose chip enable is low, -1 if none or several */
+static int _selected(SPI_HandleTypeDef *hspi)
+{
+    int panel = -1;
+
+    for(int i = 0; i < MOCK_PANELS; i++)
+    {
+        if(_pin(i, MOCK_CE_PIN)) continue;
+        if(mock_panel_spi[i] && mock_panel_spi[i]->Instance != hspi->Instance) continue;
+        if(panel >= 0) return -1;
+        panel = i;
+    }
+    return panel;
+}
+
+static mock_dma_t *_dma_of(SPI_HandleTypeDef *hspi)
+{
+    for(int i = 0; i < MOCK_BUSES; i++)
+    {
+        if(_dma[i].hspi && _dma[i].hspi->Instance == hspi->Instance) return &_dma[i];
+    }
+    return NULL;
+}
+
+void mock_reset(void)
+{
+    memset(mock_panels, 0, sizeof(mock_panels));
+    memset(mock_panel_spi, 0, sizeof(mock_panel_spi));
+    memset(_dma, 0, sizeof(_dma));
+
+    for(int i = 0; i < MOCK_PANELS; i++)
+    {
+        /* Nothing selected */
+        _panel_reset(&mock_panels[i]);
+        mock_gpio[i].ODR = MOCK_CE_PIN;
+    }
+    mock_spi_bytes = mock_errors = mock_tick = 0;
+    mock_dma_sync = mock_dma_stall = false;
+    _in_isr = false;
+}
+
+bool mock_dma_busy(void)
+{
+    for(int i = 0; i < MOCK_BUSES; i++)
+    {
+        if(_dma[i].hspi) return true;
+    }
+    return false;
+}
+
+bool mock_dma_complete(void)
+{
+    for(int i = 0; i < MOCK_BUSES; i++)
+    {
+        mock_dma_t t = _dma[i];
+        bool in_isr = _in_isr;
+
+        if(!t.hspi) continue;
+
+        /* The panel must stay selected, in the same mode, for the whole transfer */
+        if(_pin(t.panel, MOCK_CE_PIN) || (_pin(t.panel, MOCK_DC_PIN) != t.dc)) mock_errors++;
+
+        _panel_feed(t.panel, t.dc, t.data, t.nb_data);
+        _dma[i].hspi = NULL;
+
+        _in_isr = true;
+        HAL_SPI_TxCpltCallback(t.hspi);
+        _in_isr = in_isr;
+        return true;
+    }
+    return false;
+}
+
+void mock_dma_drain(void)
+{
+    while(mock_dma_complete());
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+    if(PinState == GPIO_PIN_SET) GPIOx->ODR |= GPIO_Pin;
+    else GPIOx->ODR &= ~(uint32_t)GPIO_Pin;
+
+    /* A reset pulse restores the address window, the RAM is left as it is */
+    if((GPIO_Pin & MOCK_RST_PIN) && (PinState == GPIO_PIN_RESET))
+    {
+        _panel_reset(&mock_panels[GPIOx - mock_gpio]);
+    }
+}
+
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+    int panel = _selected(hspi);
+
+    (void)Timeout;
+    if(panel < 0 || _dma_of(hspi))
+    {
+        mock_errors++;
+        return HAL_ERROR;
+    }
+
+    mock_spi_bytes += Size;
+    _panel_feed(panel, _pin(panel, MOCK_DC_PIN), pData, Size);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_Transmit_DMA(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size)
+{
+    int panel = _selected(hspi);
+    mock_dma_t *t = _dma_of(hspi);
+
+    if(panel < 0 || t)
+    {
+        mock_errors++;
+        return t ? HAL_BUSY : HAL_ERROR;
+    }
+
+    /* Take a free channel */
+    for(t = _dma; t->hspi; t++)
+    {
+        if(t == &_dma[MOCK_BUSES - 1]) return HAL_ERROR;
+    }
+    *t = (mock_dma_t){hspi, pData, Size, panel, _pin(panel, MOCK_DC_PIN)};
+    mock_spi_bytes += Size;
+
+    if(mock_dma_sync) mock_dma_complete();
+    return HAL_OK;
+}
+
+/* Overridden by the library when DMA is used, as in the HAL */
+__attribute__((weak)) void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi)
+{
+    (void)hspi;
+}
+
+void HAL_Delay(uint32_t Delay)
+{
+    mock_tick += Delay;
+}
+
+uint32_t HAL_GetTick(void)
+{
+    /* Time passes, so does the transfer in flight */
+    if(!mock_dma_stall && !_in_isr) mock_dma_complete();
+
+    return mock_tick++;
+}
@@ -0,0 +1,83 @@
+/*
+ * Panel and bus models behind the mock HAL.
+ *
+ * Each panel is selected by its chip enable pin (low) and reads its D/C pin to tell
+ * data from commands. It interprets the address window commands and stores the data
+ * in its display RAM the way the SSD1306 does in horizontal addressing mode, so a test
+ * can check that what the library sent is what it holds in the buffer.
+ *
+ * DMA transfers only read their bytes when they complete: mock_dma_complete() or,
+ * as time passes, HAL_GetTick(). Writing to a buffer that is still in flight
+ * therefore shows up on the panel, as it would on the hardware.
+ */
+
+/* Define to prevent recursive inclusion */
+#ifndef __MOCK_H
+#define __MOCK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "stm32f4xx_hal.h"
+
+#define MOCK_PANELS     4
+#define MOCK_RAM_W      128
+#define MOCK_RAM_PAGES  8
+
+/* Pins of every panel, each panel has its own GPIO port */
+#define MOCK_RST_PIN    0x0001
+#define MOCK_CE_PIN     0x0002
+#define MOCK_DC_PIN     0x0004
+
+typedef struct
+{
+    uint8_t ram[MOCK_RAM_PAGES][MOCK_RAM_W];
+
+    /* Address window and pointer */
+    uint8_t col0, col1, page0, page1, col, page;
+
+    /* Last contrast, multiplex ratio, COM pins configuration and scroll end page set */
+    uint8_t contrast, mux, com_pins, scroll_end;
+
+    /* Command being received */
+    uint8_t cmd[8];
+    uint8_t cmd_len, cmd_need;
+
+    /* Traffic */
+    uint32_t data_bytes, cmd_bytes;
+}mock_panel_t;
+
+extern mock_panel_t mock_panels[MOCK_PANELS];
+extern GPIO_TypeDef mock_gpio[MOCK_PANELS];
+
+/* SPI of each panel, NULL to listen on all of them */
+extern SPI_HandleTypeDef *mock_panel_spi[MOCK_PANELS];
+
+/* Bytes through HAL_SPI_Transmit(_DMA), all panels together */
+extern uint32_t mock_spi_bytes;
+
+/* Protocol violations: nothing or several panels selected, overlapping DMA... */
+extern uint32_t mock_errors;
+
+/* Milliseconds, HAL_GetTick() moves it by one */
+extern uint32_t mock_tick;
+
+/* DMA transfers complete within HAL_SPI_Transmit_DMA() */
+extern bool mock_dma_sync;
+
+/* DMA transfers never complete - A stuck bus or a masked interrupt */
+extern bool mock_dma_stall;
+
+void mock_reset(void);
+bool mock_dma_busy(void);
+bool mock_dma_complete(void);
+void mock_dma_drain(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MOCK_H */
@@ -0,0 +1,55 @@
+/*
+ * Host stand-in for the parts of the STM32 HAL used by the library.
+ * The SPI and GPIO calls drive the panel models of mock.h.
+ */
+
+/* Define to prevent recursive inclusion */
+#ifndef __STM32F4xx_HAL_H
+#define __STM32F4xx_HAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef enum
+{
+    HAL_OK = 0x00,
+    HAL_ERROR = 0x01,
+    HAL_BUSY = 0x02,
+    HAL_TIMEOUT = 0x03
+}HAL_StatusTypeDef;
+
+typedef enum
+{
+    GPIO_PIN_RESET = 0,
+    GPIO_PIN_SET
+}GPIO_PinState;
+
+typedef struct
+{
+    volatile uint32_t ODR;
+}GPIO_TypeDef;
+
+typedef struct
+{
+    uint32_t id;
+}SPI_TypeDef;
+
+typedef struct
+{
+    SPI_TypeDef *Instance;
+}SPI_HandleTypeDef;
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_SPI_Transmit_DMA(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size);
+void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi);
+void HAL_Delay(uint32_t Delay);
+uint32_t HAL_GetTick(void);
+
+/* Interrupts are not simulated, the DMA completes from the mock's own calls */
+static inline uint32_t __get_PRIMASK(void) { return 0; }
+static inline void __set_PRIMASK(uint32_t primask) { (void)primask; }
+static inline void __disable_irq(void) { }
+static inline void __enable_irq(void) { }
+
+#endif /* __STM32F4xx_HAL_H */
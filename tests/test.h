@@ -0,0 +1,191 @@
+/*
+ * Shared helpers of the host tests - Screens wired to the mock panels and checks.
+ */
+
+/* Define to prevent recursive inclusion */
+#ifndef __TEST_H
+#define __TEST_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ssd_1306.h>
+#include "mock.h"
+
+/* Counts the failure and carries on, so that one run reports all of them */
+#define CHECK(cond)                                                             \
+    do                                                                          \
+    {                                                                           \
+        if(!(cond))                                                             \
+        {                                                                       \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            test_failures++;                                                    \
+        }                                                                       \
+    }while(0)
+
+static unsigned test_failures;
+static SPI_HandleTypeDef test_spi[MOCK_PANELS];
+static SPI_TypeDef test_spi_inst[MOCK_PANELS];
+
+/* Column of the display RAM where the panel starts */
+#if (SSD1306_WIDTH == 64) && (SSD1306_HEIGHT == 48)
+#define TEST_COLUMN_OFFSET  32
+#else
+#define TEST_COLUMN_OFFSET  0
+#endif
+
+/*!
+    @brief    Fills the fields of a handle that the user sets, for mock panel n (own SPI and GPIO port).
+    @param    h       The screen handle
+    @param    buffer  The buffer (SSD1306_BUFFER_SZ)
+    @param    n       The mock panel
+*/
+static inline void test_wire(ssd_1306_t *h, uint8_t *buffer, int n)
+{
+    test_spi[n].Instance = &test_spi_inst[n];
+    h->h_spi = mock_panel_spi[n] = &test_spi[n];
+    h->buffer = buffer;
+    h->front_buffer = NULL;
+#ifdef SSD1306_PARTIAL_REFRESH
+    h->shadow = NULL;
+#endif
+    h->rst_port = h->ce_port = h->dc_port = &mock_gpio[n];
+    h->rst_pin = MOCK_RST_PIN;
+    h->ce_pin = MOCK_CE_PIN;
+    h->dc_pin = MOCK_DC_PIN;
+    h->contast = SSD1306_CONTRAST_DEFAULT_NOVCC;
+    h->vcs = SSD1306_SWITCHCAPVCC;
+}
+
+/*!
+    @brief    Initializes a zeroed handle for mock panel n.
+    @param    h       The screen handle
+    @param    buffer  The buffer (SSD1306_BUFFER_SZ)
+    @param    n       The mock panel
+    @return   The result of SSD1306_init_h(), with all the commands sent.
+*/
+static inline bool test_init(ssd_1306_t *h, uint8_t *buffer, int n)
+{
+    bool ret;
+
+    memset(h, 0, sizeof(*h));
+    test_wire(h, buffer, n);
+
+    ret = SSD1306_init_h(h);
+    mock_dma_drain();
+    return ret;
+}
+
+/*!
+    @brief    Waits for the DMA queue to drain, as the ISR would do on the hardware.
+*/
+static inline void test_flush(void)
+{
+    mock_dma_drain();
+}
+
+/*!
+    @brief    Compares the display RAM of mock panel n with a buffer.
+    @param    n       The mock panel
+    @param    buffer  The buffer (SSD1306_BUFFER_SZ)
+    @return   True if the panel shows the buffer.
+*/
+static inline bool test_panel_is(int n, const uint8_t *buffer)
+{
+    for(int p = 0; p < SSD1306_PAGES; p++)
+    {
+        for(int x = 0; x < SSD1306_WIDTH; x++)
+        {
+            uint8_t shown = mock_panels[n].ram[p][TEST_COLUMN_OFFSET + x];
+
+            if(shown == buffer[p * SSD1306_WIDTH + x]) continue;
+
+            fprintf(stderr, "panel %d: page %d column %d is 0x%02x instead of 0x%02x\n",
+                    n, p, x, shown, buffer[p * SSD1306_WIDTH + x]);
+            return false;
+        }
+    }
+    return true;
+}
+
+/*!
+    @brief    Sets a pixel of a reference buffer, the slow way. Pixels off the screen are ignored.
+    @param    ref     The reference buffer (SSD1306_BUFFER_SZ)
+    @param    x       x-coordinate
+    @param    y       y-coordinate
+    @param    color   Black(true) or white(false)
+*/
+static inline void test_ref_set(uint8_t *ref, int x, int y, bool color)
+{
+    if(x < 0 || y < 0 || x >= SSD1306_WIDTH || y >= SSD1306_HEIGHT) return;
+
+    if(color) ref[(y / 8) * SSD1306_WIDTH + x] |= 1 << (y % 8);
+    else ref[(y / 8) * SSD1306_WIDTH + x] &= ~(1 << (y % 8));
+}
+
+/*!
+    @brief    Returns a pixel of a reference buffer.
+    @param    ref     The reference buffer (SSD1306_BUFFER_SZ)
+    @param    x       x-coordinate
+    @param    y       y-coordinate
+    @return   The pixel, false off the screen.
+*/
+static inline bool test_ref_get(const uint8_t *ref, int x, int y)
+{
+    if(x < 0 || y < 0 || x >= SSD1306_WIDTH || y >= SSD1306_HEIGHT) return false;
+
+    return (ref[(y / 8) * SSD1306_WIDTH + x] >> (y % 8)) & 0x01;
+}
+
+/*!
+    @brief    Compares a buffer with its reference.
+    @param    buffer  The buffer (SSD1306_BUFFER_SZ)
+    @param    ref     The reference buffer (SSD1306_BUFFER_SZ)
+    @param    what    What was drawn, printed on the first mismatch
+    @return   True if they are the same.
+*/
+static inline bool test_buffer_is(const uint8_t *buffer, const uint8_t *ref, const char *what)
+{
+    for(int i = 0; i < SSD1306_BUFFER_SZ; i++)
+    {
+        if(buffer[i] == ref[i]) continue;
+
+        fprintf(stderr, "%s: page %d column %d is 0x%02x instead of 0x%02x\n",
+                what, i / SSD1306_WIDTH, i % SSD1306_WIDTH, buffer[i], ref[i]);
+        return false;
+    }
+    return true;
+}
+
+/*!
+    @brief    Random number generator (xorshift), for repeatable scenes.
+*/
+static inline uint32_t test_rand(void)
+{
+    static uint32_t state = 0x12345678;
+
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+/*!
+    @brief    Prints the result of the test program.
+    @param    name   The name of the test program
+    @return   The exit code.
+*/
+static inline int test_report(const char *name)
+{
+    if(mock_errors) fprintf(stderr, "%s: %u protocol errors on the mock bus\n", name, (unsigned)mock_errors);
+
+    if(test_failures || mock_errors)
+    {
+        fprintf(stderr, "%s: FAILED (%u checks)\n", name, test_failures);
+        return EXIT_FAILURE;
+    }
+    printf("%s: OK\n", name);
+    return EXIT_SUCCESS;
+}
+
+#endif /* __TEST_H */
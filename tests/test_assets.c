@@ -0,0 +1,168 @@
+/*
+ * Assets - What tools/ssd1306_assets.py makes of the images of assets/ must draw like the source images, in every
+ * variant, its RLE must decode to the bitmap, and medium_prop_font must survive a round trip through BDF.
+ */
+
+#include "test.h"
+#include "test_assets.h"
+#include "pad8_assets.h"
+#include "assets/icon.xbm"
+
+static uint8_t buffer[SSD1306_BUFFER_SZ], ref[SSD1306_BUFFER_SZ], back[SSD1306_BUFFER_SZ];
+static ssd_1306_t screen;
+
+/* A variant of a bitmap, with the source pixel it shows at x, y */
+typedef struct
+{
+    const uint8_t *bitmap;
+    const uint8_t *rle;
+    uint8_t len_x, len_y;
+    uint8_t scale;
+    bool inverted;
+}variant_t;
+
+/* The icon, converted from XBM, P1 and P4 */
+static const variant_t icons[] =
+{
+    {icon, icon_rle, ICON_WIDTH, ICON_HEIGHT, 1, false},
+    {icon_inv, icon_inv_rle, ICON_INV_WIDTH, ICON_INV_HEIGHT, 1, true},
+    {icon_x2, icon_x2_rle, ICON_X2_WIDTH, ICON_X2_HEIGHT, 2, false},
+    {icon_p1, icon_p1_rle, ICON_P1_WIDTH, ICON_P1_HEIGHT, 1, false},
+    {icon_p1_inv, icon_p1_inv_rle, ICON_P1_INV_WIDTH, ICON_P1_INV_HEIGHT, 1, true},
+    {icon_p1_x2, icon_p1_x2_rle, ICON_P1_X2_WIDTH, ICON_P1_X2_HEIGHT, 2, false},
+    {icon_p4, icon_p4_rle, ICON_P4_WIDTH, ICON_P4_HEIGHT, 1, false},
+    {icon_p4_inv, icon_p4_inv_rle, ICON_P4_INV_WIDTH, ICON_P4_INV_HEIGHT, 1, true},
+    {icon_p4_x2, icon_p4_x2_rle, ICON_P4_X2_WIDTH, ICON_P4_X2_HEIGHT, 2, false},
+};
+
+/* Runs and literals around the packet limits, its source is the plain bitmap */
+static const variant_t runs_variants[] =
+{
+    {runs, runs_rle, RUNS_WIDTH, RUNS_HEIGHT, 1, false},
+    {runs_inv, runs_inv_rle, RUNS_INV_WIDTH, RUNS_INV_HEIGHT, 1, true},
+    {runs_x2, runs_x2_rle, RUNS_X2_WIDTH, RUNS_X2_HEIGHT, 2, false},
+};
+
+/* XBM rows are padded to whole bytes, the leftmost pixel in the lowest bit */
+static bool icon_pixel(int x, int y)
+{
+    return (icon_bits[y * ((icon_width + 7) / 8) + x / 8] >> (x % 8)) & 0x01;
+}
+
+static bool runs_pixel(int x, int y)
+{
+    return (runs[(y / 8) * RUNS_WIDTH + x] >> (y % 8)) & 0x01;
+}
+
+/* Draws the variants at random places over random contents, plain and RLE, against the source */
+static void check_variants(const variant_t *v, int nb, bool (*source)(int x, int y), const char *name)
+{
+    char what[64];
+
+    for(int i = 0; i < nb * 20; i++)
+    {
+        const variant_t *var = &v[i % nb];
+        uint8_t x0 = test_rand() % SSD1306_WIDTH, y0 = test_rand() % SSD1306_HEIGHT;
+
+        for(int n = 0; n < SSD1306_BUFFER_SZ; n++) back[n] = ref[n] = test_rand();
+        for(int y = 0; y < var->len_y; y++)
+        {
+            for(int x = 0; x < var->len_x; x++)
+            {
+                test_ref_set(ref, x0 + x, y0 + y, source(x / var->scale, y / var->scale) != var->inverted);
+            }
+        }
+
+        memcpy(buffer, back, SSD1306_BUFFER_SZ);
+        SSD1306_draw_bitmap_h(&screen, var->bitmap, x0, y0, var->len_x, var->len_y, 1);
+        snprintf(what, sizeof(what), "%s variant %d at %u, %u", name, i % nb, x0, y0);
+        if(!test_buffer_is(buffer, ref, what)) break;
+
+        memcpy(buffer, back, SSD1306_BUFFER_SZ);
+        SSD1306_draw_bitmap_rle_h(&screen, var->rle, x0, y0, var->len_x, var->len_y);
+        snprintf(what, sizeof(what), "%s variant %d at %u, %u, RLE", name, i % nb, x0, y0);
+        if(!test_buffer_is(buffer, ref, what)) break;
+    }
+
+    if(memcmp(buffer, ref, SSD1306_BUFFER_SZ)) test_failures++;
+}
+
+static void test_pad8(void)
+{
+    CHECK(ICON8_WIDTH == icon_width && ICON8_HEIGHT == 16);
+
+    /* The padding rows are blank, drawn like the rest */
+    for(int i = 0; i < 20; i++)
+    {
+        uint8_t x0 = test_rand() % SSD1306_WIDTH, y0 = (test_rand() % (SSD1306_PAGES - 1)) * 8;
+
+        for(int n = 0; n < SSD1306_BUFFER_SZ; n++) back[n] = ref[n] = buffer[n] = test_rand();
+        for(int y = 0; y < ICON8_HEIGHT; y++)
+        {
+            for(int x = 0; x < ICON8_WIDTH; x++) test_ref_set(ref, x0 + x, y0 + y, y < icon_height && icon_pixel(x, y));
+        }
+
+        SSD1306_draw_bitmap_opt8_h(&screen, icon8, x0, y0, ICON8_WIDTH, ICON8_HEIGHT);
+        CHECK(test_buffer_is(buffer, ref, "icon8"));
+
+        memcpy(buffer, back, SSD1306_BUFFER_SZ);
+        SSD1306_draw_bitmap_rle_h(&screen, icon8_rle, x0, y0, ICON8_WIDTH, ICON8_HEIGHT);
+        CHECK(test_buffer_is(buffer, ref, "icon8, RLE"));
+    }
+}
+
+/* The glyph of a code point, NULL if the font has none */
+static const ssd_1306_glyph_t *glyph(const ssd_1306_font_t *font, uint32_t code)
+{
+    if(code >= font->first && code <= font->last) return &font->glyphs[code - font->first];
+
+    for(int i = 0; i < font->nb_ranges; i++)
+    {
+        const ssd_1306_range_t *r = &font->ranges[i];
+        if(code >= r->first && code <= r->last) return &font->glyphs[r->glyph + code - r->first];
+    }
+    return NULL;
+}
+
+static void test_font(void)
+{
+    const ssd_1306_font_t *font = &medium_prop_font, *back = &bdf_font;
+
+    CHECK(back->first == font->first && back->last == font->last);
+    CHECK(back->height == font->height && back->spacing == font->spacing);
+    CHECK(back->nb_ranges == font->nb_ranges);
+
+    for(int i = 0; i < font->nb_ranges && i < back->nb_ranges; i++)
+    {
+        CHECK(back->ranges[i].first == font->ranges[i].first && back->ranges[i].last == font->ranges[i].last);
+    }
+
+    /* Every 16-bit code point, with the same columns */
+    for(uint32_t code = 0; code < 0x10000; code++)
+    {
+        const ssd_1306_glyph_t *g = glyph(font, code), *b = glyph(back, code);
+        uint8_t width = g ? g->width : 0;
+
+        if((b ? b->width : 0) == width && (!width || !memcmp(font->bitmap + g->offset, back->bitmap + b->offset, width)))
+        {
+            continue;
+        }
+
+        fprintf(stderr, "U+%04x is not the same after the round trip\n", (unsigned)code);
+        test_failures++;
+        return;
+    }
+}
+
+int main(void)
+{
+    mock_reset();
+    CHECK(test_init(&screen, buffer, 0));
+
+    check_variants(icons, sizeof(icons) / sizeof(icons[0]), icon_pixel, "icon");
+    check_variants(runs_variants, sizeof(runs_variants) / sizeof(runs_variants[0]), runs_pixel, "runs");
+    test_pad8();
+    test_font();
+
+    return test_report("test_assets");
+}
@@ -0,0 +1,191 @@
+/*
+ * Bitmaps - Page-major bitmaps drawn at any position must match a per-pixel reference,
+ * cut at the edges of the screen, scaled by any factor, and the same through strip rendering.
+ */
+
+#include "test.h"
+
+#define BMP_MAX_X   40
+#define BMP_MAX_Y   40
+
+static uint8_t buffer[SSD1306_BUFFER_SZ], ref[SSD1306_BUFFER_SZ];
+static uint8_t strip[SSD1306_STRIP_SZ];
+static uint8_t bitmap[BMP_MAX_X * ((BMP_MAX_Y + 7) / 8)];
+static ssd_1306_t screen, strip_screen;
+
+/* Starts from random contents, so that both colors show */
+static void scramble(void)
+{
+    for(int i = 0; i < SSD1306_BUFFER_SZ; i++) buffer[i] = test_rand();
+    memcpy(ref, buffer, SSD1306_BUFFER_SZ);
+}
+
+/* A random bitmap, with rows of len_x bytes per bank */
+static void random_bitmap(uint8_t len_x, uint8_t len_y)
+{
+    for(int i = 0; i < len_x * ((len_y + 7) / 8); i++) bitmap[i] = test_rand();
+}
+
+/* Pixel (x, y) of the bitmap */
+static bool bitmap_pixel(uint8_t len_x, int x, int y)
+{
+    return (bitmap[(y / 8) * len_x + x] >> (y % 8)) & 0x01;
+}
+
+/* Unscaled bitmap, the slow way */
+static void ref_bitmap(uint8_t x0, uint8_t y0, uint8_t len_x, uint8_t len_y)
+{
+    for(int y = 0; y < len_y; y++)
+    {
+        for(int x = 0; x < len_x; x++) test_ref_set(ref, x0 + x, y0 + y, bitmap_pixel(len_x, x, y));
+    }
+}
+
+static void test_blit(void)
+{
+    char what[64];
+
+    scramble();
+    for(int i = 0; i < 20000; i++)
+    {
+        uint8_t len_x = 1 + test_rand() % BMP_MAX_X, len_y = 1 + test_rand() % BMP_MAX_Y;
+        uint8_t x0 = test_rand() % SSD1306_WIDTH, y0 = test_rand() % SSD1306_HEIGHT;
+
+        random_bitmap(len_x, len_y);
+        if(i & 0x01)
+        {
+            SSD1306_draw_bitmap_h(&screen, bitmap, x0, y0, len_x, len_y, 1);
+            snprintf(what, sizeof(what), "bitmap(%u, %u, %u, %u)", x0, y0, len_x, len_y);
+        }
+        else
+        {
+            /* Aligned, often cut at the right edge, where the stride of the source matters */
+            y0 &= ~0x07;
+            len_y = (len_y + 7) & ~0x07;
+            if(i & 0x02) x0 = SSD1306_WIDTH - 1 - test_rand() % (len_x > 1 ? len_x - 1 : 1);
+
+            SSD1306_draw_bitmap_opt8_h(&screen, bitmap, x0, y0, len_x, len_y);
+            snprintf(what, sizeof(what), "bitmap_opt8(%u, %u, %u, %u)", x0, y0, len_x, len_y);
+        }
+        ref_bitmap(x0, y0, len_x, len_y);
+
+        if(!test_buffer_is(buffer, ref, what))
+        {
+            test_failures++;
+            return;
+        }
+    }
+
+    /* opt8 keeps its alignment contract */
+    memcpy(ref, buffer, SSD1306_BUFFER_SZ);
+    SSD1306_draw_bitmap_opt8_h(&screen, bitmap, 0, 3, 8, 8);
+    SSD1306_draw_bitmap_opt8_h(&screen, bitmap, 0, 8, 8, 5);
+    CHECK(test_buffer_is(buffer, ref, "unaligned bitmap_opt8"));
+}
+
+/* Scaled bitmap with nearest neighbor in Q8.8, merged with a draw mode, the slow way */
+static void ref_scaled(uint8_t x0, uint8_t y0, uint8_t len_x, uint8_t len_y, uint16_t scale, uint8_t rop)
+{
+    int out_x = (len_x * scale) >> 8, out_y = (len_y * scale) >> 8;
+
+    for(int j = 0; j < out_y; j++)
+    {
+        for(int i = 0; i < out_x; i++)
+        {
+            int x = x0 + i, y = y0 + j;
+            bool src = bitmap_pixel(len_x, (i << 8) / scale, (j << 8) / scale);
+
+            if(rop == SSD1306_ROP_COPY) test_ref_set(ref, x, y, src);
+            else if(src && rop == SSD1306_ROP_OR) test_ref_set(ref, x, y, true);
+            else if(src && rop == SSD1306_ROP_AND_NOT) test_ref_set(ref, x, y, false);
+            else if(src && rop == SSD1306_ROP_XOR) test_ref_set(ref, x, y, !test_ref_get(ref, x, y));
+        }
+    }
+}
+
+static void test_scale(void)
+{
+    char what[64];
+
+    scramble();
+    for(int i = 0; i < 20000; i++)
+    {
+        uint8_t len_x = 1 + test_rand() % 16, len_y = 1 + test_rand() % 16;
+        uint8_t x0 = test_rand() % SSD1306_WIDTH, y0 = test_rand() % SSD1306_HEIGHT;
+        uint8_t rop = test_rand() % 4;
+        uint16_t scale;
+
+        random_bitmap(len_x, len_y);
+        SSD1306_draw_mode_h(&screen, rop);
+        if(i & 0x01)
+        {
+            scale = (1 + test_rand() % 5) << 8;
+            SSD1306_draw_bitmap_h(&screen, bitmap, x0, y0, len_x, len_y, scale >> 8);
+        }
+        else
+        {
+            scale = 0x0100 + test_rand() % 0x0300;
+            SSD1306_draw_bitmap_q8_h(&screen, bitmap, x0, y0, len_x, len_y, scale);
+        }
+        ref_scaled(x0, y0, len_x, len_y, scale, rop);
+        snprintf(what, sizeof(what), "bitmap(%u, %u, %u, %u) x0x%04x mode %u", x0, y0, len_x, len_y, scale, rop);
+
+        if(!test_buffer_is(buffer, ref, what))
+        {
+            test_failures++;
+            break;
+        }
+    }
+    SSD1306_draw_mode_h(&screen, SSD1306_ROP_COPY);
+
+    /* Factors below 1 draw nothing */
+    memcpy(ref, buffer, SSD1306_BUFFER_SZ);
+    SSD1306_draw_bitmap_q8_h(&screen, bitmap, 0, 0, 8, 8, 0x00ff);
+    SSD1306_draw_bitmap_h(&screen, bitmap, 0, 0, 8, 8, 0);
+    CHECK(test_buffer_is(buffer, ref, "scale below 1"));
+
+    /* Integer factors of text in Q8.8 are the integer scales */
+    SSD1306_fill_h(&screen, false);
+    SSD1306_print_fstr_h(&screen, "Ag9", MEDIUM_FONT, 3, 5, 3, false);
+    memcpy(ref, buffer, SSD1306_BUFFER_SZ);
+    SSD1306_fill_h(&screen, false);
+    SSD1306_print_fstr_q8_h(&screen, "Ag9", MEDIUM_FONT, 3, 5, SSD1306_SCALE_Q8(3), false);
+    CHECK(test_buffer_is(buffer, ref, "print_fstr_q8"));
+}
+
+/* Bitmaps crossing the page boundaries */
+static void draw_bitmaps(void *arg)
+{
+    ssd_1306_t *h = arg;
+
+    SSD1306_draw_bitmap_h(h, bitmap, 3, 5, 20, 19, 1);
+    SSD1306_draw_bitmap_h(h, bitmap, SSD1306_WIDTH - 10, SSD1306_HEIGHT - 11, 20, 19, 1);
+    SSD1306_draw_bitmap_opt8_h(h, bitmap, 40, 8, 20, 8);
+    SSD1306_draw_bitmap_h(h, bitmap, 70, 3, 20, 19, 2);
+    SSD1306_draw_bitmap_q8_h(h, bitmap, 10, 20, 20, 19, SSD1306_SCALE_Q8(1.5));
+}
+
+static void test_strips(void)
+{
+    random_bitmap(20, 19);
+
+    SSD1306_fill_h(&screen, false);
+    draw_bitmaps(&screen);
+
+    CHECK(test_init(&strip_screen, strip, 1));
+    CHECK(SSD1306_render_strips_h(&strip_screen, draw_bitmaps, &strip_screen));
+    test_flush();
+    CHECK(test_panel_is(1, buffer));
+}
+
+int main(void)
+{
+    mock_reset();
+    CHECK(test_init(&screen, buffer, 0));
+
+    test_blit();
+    test_scale();
+    test_strips();
+
+    return test_report("test_bitmap");
+}
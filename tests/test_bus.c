@@ -0,0 +1,131 @@
+/*
+ * Shared bus - The DMA ISR serves the screens of a bus by priority, then by deadline,
+ * then in turns, with only one of them selected at a time.
+ */
+
+#include "test.h"
+
+#ifdef SSD1306_DMA_ACTIVE
+#define SCREENS     3
+
+static uint8_t buffers[SCREENS][SSD1306_BUFFER_SZ];
+static ssd_1306_t screens[SCREENS];
+static ssd_1306_bus_t bus;
+
+/* Completes the transfer in flight and returns the panel it was sent to */
+static int served(void)
+{
+    uint32_t before[SCREENS];
+
+    for(int i = 0; i < SCREENS; i++) before[i] = mock_panels[i].data_bytes + mock_panels[i].cmd_bytes;
+    if(!mock_dma_complete()) return -1;
+
+    for(int i = 0; i < SCREENS; i++)
+    {
+        if(mock_panels[i].data_bytes + mock_panels[i].cmd_bytes != before[i]) return i;
+    }
+    return -1;
+}
+
+static void setup(void)
+{
+    mock_reset();
+    test_spi[0].Instance = &test_spi_inst[0];
+    bus = (ssd_1306_bus_t){.h_spi = &test_spi[0]};
+
+    for(int i = 0; i < SCREENS; i++)
+    {
+        memset(&screens[i], 0, sizeof(screens[i]));
+        test_wire(&screens[i], buffers[i], i);
+        mock_panel_spi[i] = &test_spi[0];
+        CHECK(SSD1306_bus_attach(&bus, &screens[i]));
+        CHECK(SSD1306_init_h(&screens[i]));
+    }
+    test_flush();
+
+    for(int i = 0; i < SCREENS; i++)
+    {
+        SSD1306_fill_h(&screens[i], i & 0x01);
+        SSD1306_draw_circle_h(&screens[i], 20 + 10 * i, 8, 6, !(i & 0x01));
+    }
+}
+
+static void test_priority(void)
+{
+    setup();
+    screens[1].priority = 1;
+
+    /* Screen 0 takes the idle bus, then the higher priority goes first */
+    mock_dma_stall = true;
+    CHECK(SSD1306_refresh_h(&screens[0]));
+    CHECK(SSD1306_refresh_h(&screens[2]));
+    CHECK(SSD1306_refresh_h(&screens[1]));
+    CHECK(bus.active == &screens[0]);
+
+    CHECK(served() == 0);
+    CHECK(served() == 1);
+    CHECK(served() == 2);
+    CHECK(served() == -1);
+    CHECK(!bus.active);
+
+    for(int i = 0; i < SCREENS; i++) CHECK(test_panel_is(i, buffers[i]));
+    mock_dma_stall = false;
+}
+
+static void test_deadline(void)
+{
+    setup();
+    screens[0].period = 5;
+    screens[1].period = 50;
+    screens[2].period = 20;
+
+    /* Equal priorities, the earliest deadline goes first */
+    mock_dma_stall = true;
+    CHECK(SSD1306_contrast_h(&screens[0], 0x10));
+    CHECK(SSD1306_refresh_h(&screens[1]));
+    CHECK(SSD1306_refresh_h(&screens[2]));
+    CHECK(SSD1306_refresh_h(&screens[0]));
+
+    CHECK(served() == 0);
+    CHECK(served() == 0);
+    CHECK(served() == 2);
+    CHECK(served() == 1);
+    CHECK(mock_panels[0].contrast == 0x10);
+
+    for(int i = 0; i < SCREENS; i++) CHECK(test_panel_is(i, buffers[i]));
+    mock_dma_stall = false;
+}
+
+static void test_turns(void)
+{
+    setup();
+
+    /* Equal screens share the bus command by command */
+    mock_dma_stall = true;
+    for(int i = 0; i < SCREENS; i++)
+    {
+        CHECK(SSD1306_contrast_h(&screens[i], 0x20 + i));
+        CHECK(SSD1306_contrast_h(&screens[i], 0x30 + i));
+    }
+
+    CHECK(served() == 0);
+    CHECK(served() == 1);
+    CHECK(served() == 2);
+    CHECK(served() == 0);
+    CHECK(served() == 1);
+    CHECK(served() == 2);
+    for(int i = 0; i < SCREENS; i++) CHECK(mock_panels[i].contrast == 0x30 + i);
+    mock_dma_stall = false;
+}
+#endif
+
+int main(void)
+{
+#ifdef SSD1306_DMA_ACTIVE
+    test_priority();
+    test_deadline();
+    test_turns();
+#endif
+
+    return test_report("test_bus");
+}
@@ -0,0 +1,246 @@
+/*
+ * C++ front end - The inline primitives of ssd_1306.hpp must draw what the C routines draw in every draw mode,
+ * hand what they drew to the partial refresh, and work within strips. Built as C++11 with -pedantic.
+ */
+
+#include "test.h"
+#include <ssd_1306.hpp>
+
+/* Mock panel n, reached the way the library is built */
+template<int N>
+struct MockPanel
+#ifdef SSD1306_DMA_ACTIVE
+    : ssd1306::Dma
+#else
+    : ssd1306::Polling
+#endif
+{
+    static void wire(ssd_1306_t &h) { test_wire(&h, NULL, N); }
+};
+
+typedef ssd1306::Display<MockPanel<0> > Screen;
+typedef ssd1306::Framebuffer<20, 13> Sprite;
+
+/* The page math folds at compile time */
+static_assert(Screen::Frame::size == SSD1306_BUFFER_SZ, "Framebuffer - Size of the screen");
+static_assert(Screen::Frame::index(5, 17) == 2 * SSD1306_WIDTH + 5, "Framebuffer - Index of a pixel");
+static_assert(Screen::Frame::bit(17) == 0x02, "Framebuffer - Bit of a pixel");
+static_assert(Sprite::pages == 2 && Sprite::size == 40, "Framebuffer - Partial bank");
+
+static Screen disp;
+static ssd1306::Display<MockPanel<1> > strips;
+static uint8_t buffer[SSD1306_BUFFER_SZ];
+static ssd_1306_t screen;
+
+static const uint8_t rops[4] = {SSD1306_ROP_COPY, SSD1306_ROP_OR, SSD1306_ROP_AND_NOT, SSD1306_ROP_XOR};
+
+/* A random primitive up to max pixels long, on both screens - Lines and rectangles may run off the screen */
+static void random_primitive(uint8_t max, bool c_too)
+{
+    uint8_t x = test_rand() % (SSD1306_WIDTH + 8), y = test_rand() % (SSD1306_HEIGHT + 8);
+    uint8_t len_x = test_rand() % max, len_y = test_rand() % max;
+    bool color = test_rand() & 0x01;
+
+    switch(test_rand() % 4)
+    {
+        case 0:
+            disp.set_pixel(x, y, color);
+            if(c_too) SSD1306_set_pixel_h(&screen, x, y, color);
+            break;
+        case 1:
+            disp.draw_hline(x, y, len_x, color);
+            if(c_too) SSD1306_draw_hline_h(&screen, x, y, len_x, color);
+            break;
+        case 2:
+            disp.draw_vline(x, y, len_y, color);
+            if(c_too) SSD1306_draw_vline_h(&screen, x, y, len_y, color);
+            break;
+        default:
+            /* The C rectangle takes corners on the screen */
+            x %= SSD1306_WIDTH;
+            y %= SSD1306_HEIGHT;
+            len_x = 1 + len_x % (SSD1306_WIDTH - x);
+            len_y = 1 + len_y % (SSD1306_HEIGHT - y);
+            disp.fill_rect(x, y, len_x, len_y, color);
+            if(c_too) SSD1306_draw_rectangle_h(&screen, x, x + len_x - 1, y, y + len_y - 1, color, true);
+            break;
+    }
+}
+
+static void test_primitives(void)
+{
+    char what[64];
+
+    for(int i = 0; i < 2000; i++)
+    {
+        /* From time to time, the same random contents */
+        if(!(i % 100))
+        {
+            for(int n = 0; n < SSD1306_BUFFER_SZ; n++) buffer[n] = test_rand();
+            memcpy(disp.buffer(), buffer, SSD1306_BUFFER_SZ);
+        }
+
+        const uint8_t rop = rops[test_rand() % 4];
+        disp.draw_mode(rop);
+        SSD1306_draw_mode_h(&screen, rop);
+
+        random_primitive(SSD1306_WIDTH, true);
+
+        snprintf(what, sizeof(what), "primitive %d in draw mode %u", i, rop);
+        if(!test_buffer_is(disp.buffer(), buffer, what))
+        {
+            test_failures++;
+            return;
+        }
+    }
+
+    /* Reading back, off the screen too */
+    for(int i = 0; i < 500; i++)
+    {
+        uint8_t x = test_rand() % (SSD1306_WIDTH + 8), y = test_rand() % (SSD1306_HEIGHT + 8);
+        CHECK(disp.get_pixel(x, y) == SSD1306_get_pixel_h(&screen, x, y));
+    }
+
+    disp.draw_mode(SSD1306_ROP_COPY);
+    SSD1306_draw_mode_h(&screen, SSD1306_ROP_COPY);
+}
+
+static void test_refresh(void)
+{
+    CHECK(disp.refresh());
+    test_flush();
+    CHECK(test_panel_is(0, disp.buffer()));
+
+    /* Only the area drawn by the primitives is passed on, it must be enough - Small ones, so that it is not all */
+    for(int i = 0; i < 300; i++)
+    {
+        disp.draw_mode(rops[test_rand() % 4]);
+        for(int n = test_rand() % 4; n >= 0; n--) random_primitive(12, false);
+
+#ifdef SSD1306_PARTIAL_REFRESH
+        CHECK(disp.refresh_partial());
+#else
+        CHECK(disp.refresh());
+#endif
+        test_flush();
+        if(!test_panel_is(0, disp.buffer()))
+        {
+            test_failures++;
+            break;
+        }
+    }
+    disp.draw_mode(SSD1306_ROP_COPY);
+}
+
+static void test_framebuffer(void)
+{
+    static Sprite sprite;
+    bool ref[Sprite::height][Sprite::width] = {};
+
+    /* Against a plain array of pixels, with parts off the framebuffer */
+    sprite.fill(false);
+    for(int i = 0; i < 300; i++)
+    {
+        uint8_t x = test_rand() % (Sprite::width + 4), y = test_rand() % (Sprite::height + 4);
+        uint8_t len = test_rand() % Sprite::width;
+        bool color = test_rand() & 0x01;
+
+        switch(test_rand() % 3)
+        {
+            case 0:
+                sprite.set_pixel(x, y, color);
+                if(x < Sprite::width && y < Sprite::height) ref[y][x] = color;
+                break;
+            case 1:
+                sprite.draw_hline(x, y, len, color);
+                for(int n = 0; n < len && y < Sprite::height && x + n < Sprite::width; n++) ref[y][x + n] = color;
+                break;
+            default:
+                sprite.draw_vline(x, y, len, color);
+                for(int n = 0; n < len && x < Sprite::width && y + n < Sprite::height; n++) ref[y + n][x] = color;
+                break;
+        }
+    }
+
+    for(int y = 0; y < Sprite::height + 4; y++)
+    {
+        for(int x = 0; x < Sprite::width + 4; x++)
+        {
+            bool pixel = (x < Sprite::width && y < Sprite::height) && ref[y][x];
+            CHECK(sprite.get_pixel(x, y) == pixel);
+        }
+    }
+
+    /* Blitted, the pixels land on the screen and nothing else changes */
+    for(int i = 0; i < 50; i++)
+    {
+        uint8_t x0 = test_rand() % SSD1306_WIDTH, y0 = test_rand() % SSD1306_HEIGHT;
+
+        for(int n = 0; n < SSD1306_BUFFER_SZ; n++) buffer[n] = disp.buffer()[n] = test_rand();
+        for(int y = 0; y < Sprite::height; y++)
+        {
+            for(int x = 0; x < Sprite::width; x++) test_ref_set(buffer, x0 + x, y0 + y, ref[y][x]);
+        }
+
+        disp.blit(sprite, x0, y0);
+        if(!test_buffer_is(disp.buffer(), buffer, "blit"))
+        {
+            test_failures++;
+            return;
+        }
+    }
+}
+
+/* Lines and rectangles across the pages, and a framebuffer */
+template<typename D>
+static void draw_scene(D &d)
+{
+    static Sprite sprite;
+
+    sprite.fill(false);
+    sprite.draw_hline(0, 0, Sprite::width, true);
+    sprite.draw_vline(3, 0, Sprite::height, true);
+    sprite.set_pixel(Sprite::width - 1, Sprite::height - 1, true);
+
+    d.fill_rect(2, 3, SSD1306_WIDTH / 2, SSD1306_HEIGHT - 6, true);
+    d.draw_mode(SSD1306_ROP_XOR);
+    d.fill_rect(SSD1306_WIDTH / 4, 1, SSD1306_WIDTH / 2, SSD1306_HEIGHT / 2, true);
+    d.draw_mode(SSD1306_ROP_COPY);
+    d.draw_hline(0, SSD1306_HEIGHT - 1, SSD1306_WIDTH, true);
+    d.draw_vline(SSD1306_WIDTH - 1, 0, SSD1306_HEIGHT, true);
+    d.set_pixel(SSD1306_WIDTH / 2, 9, false);
+    d.blit(sprite, SSD1306_WIDTH - Sprite::width - 4, 5);
+}
+
+static void test_strips(void)
+{
+    disp.fill(false);
+    draw_scene(disp);
+    CHECK(disp.refresh());
+    test_flush();
+
+    CHECK(strips.init());
+    test_flush();
+    CHECK(strips.render_strips([] { draw_scene(strips); }));
+    test_flush();
+    CHECK(test_panel_is(1, disp.buffer()));
+
+    /* The full screen is back after the strips */
+    strips.set_pixel(0, SSD1306_HEIGHT - 1, true);
+    CHECK(strips.get_pixel(0, SSD1306_HEIGHT - 1) == 1);
+}
+
+int main(void)
+{
+    mock_reset();
+    CHECK(disp.init());
+    test_flush();
+    CHECK(test_init(&screen, buffer, 2));
+
+    test_primitives();
+    test_refresh();
+    test_framebuffer();
+    test_strips();
+
+    return test_report("test_cpp");
+}
@@ -0,0 +1,339 @@
+/*
+ * Primitives - Lines, rectangles and filled shapes must light exactly the pixels
+ * a per-pixel reference does, whatever their position and clipping.
+ */
+
+#include "test.h"
+
+static uint8_t buffer[SSD1306_BUFFER_SZ], ref[SSD1306_BUFFER_SZ];
+static ssd_1306_t screen;
+
+/* Random coordinate, sometimes off the screen */
+static uint8_t rand_coord(uint8_t size)
+{
+    return test_rand() % (size + 24);
+}
+
+/* Starts from random contents, so that both colors show */
+static void scramble(void)
+{
+    for(int i = 0; i < SSD1306_BUFFER_SZ; i++) buffer[i] = test_rand();
+    memcpy(ref, buffer, SSD1306_BUFFER_SZ);
+}
+
+static void test_lines(void)
+{
+    char what[64];
+
+    scramble();
+    for(int i = 0; i < 20000; i++)
+    {
+        uint8_t x = rand_coord(SSD1306_WIDTH), y = rand_coord(SSD1306_HEIGHT);
+        uint8_t len = test_rand() % ((test_rand() & 0x01) ? 12 : 256);
+        bool color = test_rand() & 0x01;
+
+        if(i & 0x01)
+        {
+            SSD1306_draw_hline_h(&screen, x, y, len, color);
+            for(int n = 0; n < len; n++) test_ref_set(ref, x + n, y, color);
+            snprintf(what, sizeof(what), "hline(%u, %u, %u)", x, y, len);
+        }
+        else
+        {
+            SSD1306_draw_vline_h(&screen, x, y, len, color);
+            for(int n = 0; n < len; n++) test_ref_set(ref, x, y + n, color);
+            snprintf(what, sizeof(what), "vline(%u, %u, %u)", x, y, len);
+        }
+        if(!test_buffer_is(buffer, ref, what))
+        {
+            test_failures++;
+            return;
+        }
+    }
+}
+
+static void test_rectangles(void)
+{
+    char what[64];
+
+    scramble();
+    for(int i = 0; i < 20000; i++)
+    {
+        uint8_t x0 = rand_coord(SSD1306_WIDTH), x1 = rand_coord(SSD1306_WIDTH);
+        uint8_t y0 = rand_coord(SSD1306_HEIGHT), y1 = rand_coord(SSD1306_HEIGHT);
+        bool color = test_rand() & 0x01, fill = test_rand() & 0x01;
+
+        /* Small ones end inside their first bank */
+        if(test_rand() & 0x01) { x1 = x0 + test_rand() % 4; y1 = y0 + test_rand() % 4; }
+
+        SSD1306_draw_rectangle_h(&screen, x0, x1, y0, y1, color, fill);
+        snprintf(what, sizeof(what), "rectangle(%u, %u, %u, %u, %d)", x0, x1, y0, y1, fill);
+
+        /* Nothing is drawn from a corner off the screen */
+        if(x0 >= SSD1306_WIDTH || y0 >= SSD1306_HEIGHT) continue;
+        if(x0 > x1) { uint8_t x = x0; x0 = x1; x1 = x; }
+        if(y0 > y1) { uint8_t y = y0; y0 = y1; y1 = y; }
+
+        for(int y = y0; y <= y1; y++)
+        {
+            for(int x = x0; x <= x1; x++)
+            {
+                if(fill || x == x0 || x == x1 || y == y0 || y == y1) test_ref_set(ref, x, y, color);
+            }
+        }
+        if(!test_buffer_is(buffer, ref, what))
+        {
+            test_failures++;
+            return;
+        }
+    }
+}
+
+static void test_triangles(void)
+{
+    /* A flat top on row 0 */
+    SSD1306_fill_h(&screen, false);
+    SSD1306_draw_fill_triangle_h(&screen, 10, 30, 20, 0, 0, 10, true);
+
+    for(int x = 0; x < SSD1306_WIDTH; x++) CHECK(test_ref_get(buffer, x, 0) == (x >= 10 && x <= 30));
+    for(int x = 0; x < SSD1306_WIDTH; x++) CHECK(test_ref_get(buffer, x, 10) == (x == 20));
+    for(int x = 0; x < SSD1306_WIDTH; x++) CHECK(!test_ref_get(buffer, x, 11));
+
+    /* Every row of a filled triangle is one run inside its bounding box */
+    for(int y = 1; y < 10; y++)
+    {
+        int runs = 0;
+
+        for(int x = 0; x < SSD1306_WIDTH; x++)
+        {
+            if(test_ref_get(buffer, x, y) && !test_ref_get(buffer, x - 1, y)) runs++;
+            if(test_ref_get(buffer, x, y)) CHECK(x >= 10 && x <= 30);
+        }
+        CHECK(runs == 1);
+    }
+
+    /* Random ones against the scanline formulas, with sides going either way */
+    scramble();
+    for(int i = 0; i < 5000; i++)
+    {
+        int x[3], y[3];
+        bool color = test_rand() & 0x01;
+        char what[64];
+
+        for(int n = 0; n < 3; n++) { x[n] = test_rand() % SSD1306_WIDTH; y[n] = test_rand() % SSD1306_HEIGHT; }
+        SSD1306_draw_fill_triangle_h(&screen, x[0], x[1], x[2], y[0], y[1], y[2], color);
+        snprintf(what, sizeof(what), "fill_triangle(%d, %d, %d, %d, %d, %d)", x[0], x[1], x[2], y[0], y[1], y[2]);
+
+        /* Sorted by y */
+        for(int n = 0; n < 2; n++)
+        {
+            for(int m = 0; m < 2 - n; m++)
+            {
+                if(y[m] <= y[m + 1]) continue;
+                int t = y[m]; y[m] = y[m + 1]; y[m + 1] = t;
+                t = x[m]; x[m] = x[m + 1]; x[m + 1] = t;
+            }
+        }
+
+        for(int row = y[0]; row <= y[2]; row++)
+        {
+            int a, b;
+
+            if(y[0] == y[2])
+            {
+                a = x[0] < x[1] ? x[0] : x[1]; a = a < x[2] ? a : x[2];
+                b = x[0] > x[1] ? x[0] : x[1]; b = b > x[2] ? b : x[2];
+            }
+            else if(row < y[1] || (row == y[1] && y[1] == y[2]))
+            {
+                a = x[0] + (x[1] - x[0]) * (row - y[0]) / (y[1] - y[0]);
+                b = x[0] + (x[2] - x[0]) * (row - y[0]) / (y[2] - y[0]);
+            }
+            else
+            {
+                a = x[1] + (x[2] - x[1]) * (row - y[1]) / (y[2] - y[1]);
+                b = x[0] + (x[2] - x[0]) * (row - y[0]) / (y[2] - y[0]);
+            }
+            if(a > b) { int t = a; a = b; b = t; }
+            for(int col = a; col <= b; col++) test_ref_set(ref, col, row, color);
+        }
+        if(!test_buffer_is(buffer, ref, what))
+        {
+            test_failures++;
+            return;
+        }
+    }
+}
+
+/* The filled circle as it was drawn pixel by pixel, with the 8-bit wrap-around of the coordinates */
+static void ref_fill_circle(uint8_t x0, uint8_t y0, uint8_t r, bool color)
+{
+    int f = 1 - r, ddF_x = 1, ddF_y = -2 * r, x = 0, y = r, px = x, py = y;
+
+    for(int i = 0; i < 2 * r + 1; i++) test_ref_set(ref, x0, (uint8_t)(y0 - r + i), color);
+
+    while(x < y)
+    {
+        if(f >= 0)
+        {
+            y--;
+            ddF_y += 2;
+            f += ddF_y;
+        }
+        x++;
+        ddF_x += 2;
+        f += ddF_x;
+
+        if(x < (y + 1))
+        {
+            for(int i = 0; i < 2 * y; i++)
+            {
+                test_ref_set(ref, (uint8_t)(x0 + x), (uint8_t)(y0 - y + i), color);
+                test_ref_set(ref, (uint8_t)(x0 - x), (uint8_t)(y0 - y + i), color);
+            }
+        }
+        if(y != py)
+        {
+            for(int i = 0; i < 2 * px; i++)
+            {
+                test_ref_set(ref, (uint8_t)(x0 + py), (uint8_t)(y0 - px + i), color);
+                test_ref_set(ref, (uint8_t)(x0 - py), (uint8_t)(y0 - px + i), color);
+            }
+            py = y;
+        }
+        px = x;
+    }
+}
+
+static void test_circles(void)
+{
+    char what[64];
+
+    scramble();
+    for(int i = 0; i < 5000; i++)
+    {
+        uint8_t x = rand_coord(SSD1306_WIDTH), y = rand_coord(SSD1306_HEIGHT);
+        uint8_t r = test_rand() % ((i & 0x01) ? 16 : 100);
+        bool color = test_rand() & 0x01;
+
+        /* Radii of 128 and above used to hang */
+        if(!(i % 100)) r = 128 + test_rand() % 128;
+
+        SSD1306_draw_fill_circle_h(&screen, x, y, r, color);
+        ref_fill_circle(x, y, r, color);
+        snprintf(what, sizeof(what), "fill_circle(%u, %u, %u)", x, y, r);
+        if(!test_buffer_is(buffer, ref, what))
+        {
+            test_failures++;
+            return;
+        }
+    }
+}
+
+/* Every kind of primitive, with random arguments in p */
+#define SHAPES  14
+
+static void draw_shape(int kind, const uint8_t *p, bool color)
+{
+    static const uint8_t glyphs[16] = {0x3c, 0x42, 0x81, 0xa5, 0x81, 0x99, 0x42, 0x3c,
+                                       0x18, 0x24, 0x42, 0xff, 0x42, 0x24, 0x18, 0x00};
+    uint8_t x0 = p[0] % SSD1306_WIDTH, x1 = p[1] % SSD1306_WIDTH, x2 = p[2] % SSD1306_WIDTH;
+    uint8_t y0 = p[3] % SSD1306_HEIGHT, y1 = p[4] % SSD1306_HEIGHT, y2 = p[5] % SSD1306_HEIGHT;
+
+    switch(kind)
+    {
+        case 0:  SSD1306_set_pixel_h(&screen, x0, y0, color); break;
+        case 1:  SSD1306_draw_hline_h(&screen, x0, y0, p[6], color); break;
+        case 2:  SSD1306_draw_vline_h(&screen, x0, y0, p[6] % 80, color); break;
+        case 3:  SSD1306_draw_line_h(&screen, x0, x1, y0, y1, color); break;
+        case 4:  SSD1306_draw_rectangle_h(&screen, x0, x1, y0, y1, color, p[7] & 0x01); break;
+        case 5:  SSD1306_draw_circle_h(&screen, x0, y0, p[6] % 40, color); break;
+        case 6:  SSD1306_draw_fill_circle_h(&screen, x0, y0, p[6] % 40, color); break;
+        case 7:  SSD1306_draw_fill_triangle_h(&screen, x0, x1, x2, y0, y1, y2, color); break;
+        case 8:  SSD1306_draw_round_rect_h(&screen, x0, y0, x1, y1, color, p[7] & 0x01); break;
+        case 9:  SSD1306_draw_bitmap_h(&screen, glyphs, x0, y0, 8, 16, 1 + p[6] % 3); break;
+        case 10: SSD1306_draw_bitmap_opt8_h(&screen, glyphs, x0, y0 & ~0x07, 8, 16); break;
+        case 11: SSD1306_draw_bitmap_q8_h(&screen, glyphs, x0, y0, 8, 16, 0x100 + p[6]); break;
+        case 12: SSD1306_print_fstr_h(&screen, "Rop 42", p[7] % 3, x0, y0, 1 + p[6] % 2, !color); break;
+        default:
+            SSD1306_coord_h(&screen, x0, y0 / 8);
+            SSD1306_print_str_h(&screen, "Rop 42", p[7] % 3, !color);
+            break;
+    }
+}
+
+static void test_rop(void)
+{
+    static uint8_t base[SSD1306_BUFFER_SZ], mask[SSD1306_BUFFER_SZ];
+    char what[64];
+
+    for(int i = 0; i < 20000; i++)
+    {
+        uint8_t p[8];
+        int kind = i % SHAPES, rop = SSD1306_ROP_OR + (i / SHAPES) % 3;
+
+        for(int n = 0; n < 8; n++) p[n] = test_rand();
+        snprintf(what, sizeof(what), "shape %d in mode %d (%u, %u, %u, %u, %u, %u, %u, %u)",
+                 kind, rop, p[0], p[1], p[2], p[3], p[4], p[5], p[6], p[7]);
+
+        /* The pixels drawn, as copied on a blank buffer */
+        SSD1306_draw_mode_h(&screen, SSD1306_ROP_COPY);
+        SSD1306_fill_h(&screen, false);
+        draw_shape(kind, p, true);
+        memcpy(mask, buffer, SSD1306_BUFFER_SZ);
+
+        scramble();
+        memcpy(base, buffer, SSD1306_BUFFER_SZ);
+        SSD1306_draw_mode_h(&screen, rop);
+
+        /* White draws nothing (bitmaps have no color, inverted text is a mask of its own) */
+        if(kind < 9)
+        {
+            draw_shape(kind, p, false);
+            if(!test_buffer_is(buffer, base, what)) goto fail;
+        }
+
+        draw_shape(kind, p, true);
+        for(int n = 0; n < SSD1306_BUFFER_SZ; n++)
+        {
+            if(rop == SSD1306_ROP_OR) ref[n] = base[n] | mask[n];
+            else if(rop == SSD1306_ROP_AND_NOT) ref[n] = base[n] & ~mask[n];
+            else ref[n] = base[n] ^ mask[n];
+        }
+        if(!test_buffer_is(buffer, ref, what)) goto fail;
+
+        /* A second XOR draw restores the buffer */
+        if(rop == SSD1306_ROP_XOR)
+        {
+            draw_shape(kind, p, true);
+            if(!test_buffer_is(buffer, base, what)) goto fail;
+        }
+    }
+
+    /* Triangle outlines only overlap where their sides meet, drawing them twice still undoes them */
+    scramble();
+    SSD1306_draw_mode_h(&screen, SSD1306_ROP_XOR);
+    SSD1306_draw_triangle_h(&screen, 5, 60, 30, 3, 10, 40, true);
+    SSD1306_draw_triangle_h(&screen, 5, 60, 30, 3, 10, 40, true);
+    CHECK(test_buffer_is(buffer, ref, "triangle"));
+    SSD1306_draw_mode_h(&screen, SSD1306_ROP_COPY);
+    return;
+
+fail:
+    test_failures++;
+    SSD1306_draw_mode_h(&screen, SSD1306_ROP_COPY);
+}
+
+int main(void)
+{
+    mock_reset();
+    CHECK(test_init(&screen, buffer, 0));
+
+    test_lines();
+    test_rectangles();
+    test_triangles();
+    test_circles();
+    test_rop();
+
+    return test_report("test_draw");
+}
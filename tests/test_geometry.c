@@ -0,0 +1,120 @@
+/*
+ * Geometry - Every panel size must be set up for its rows, and its pixels must land in the part of the
+ * display RAM that the panel shows, whatever the refresh.
+ */
+
+#include "test.h"
+
+static uint8_t buffer[SSD1306_BUFFER_SZ];
+static ssd_1306_t screen;
+
+/* COM pins configuration of the panel - Alternative on the 64-row panels and the 64x48 */
+#if (SSD1306_HEIGHT == 64) || (SSD1306_HEIGHT == 48)
+#define TEST_COM_PINS   0x12
+#else
+#define TEST_COM_PINS   0x02
+#endif
+
+/* Checks that the display RAM that the panel does not show was never written */
+static bool outside_blank(int n)
+{
+    for(int p = 0; p < MOCK_RAM_PAGES; p++)
+    {
+        for(int x = 0; x < MOCK_RAM_W; x++)
+        {
+            if(p < SSD1306_PAGES && x >= TEST_COLUMN_OFFSET && x < TEST_COLUMN_OFFSET + SSD1306_WIDTH) continue;
+            if(!mock_panels[n].ram[p][x]) continue;
+
+            fprintf(stderr, "panel %d: page %d column %d written outside the panel\n", n, p, x);
+            return false;
+        }
+    }
+    return true;
+}
+
+static void test_setup(void)
+{
+    CHECK(SSD1306_BUFFER_SZ == SSD1306_WIDTH * SSD1306_HEIGHT / 8);
+    CHECK(SSD1306_PAGES == SSD1306_HEIGHT / 8);
+
+    CHECK(test_init(&screen, buffer, 0));
+    CHECK(mock_panels[0].mux == SSD1306_HEIGHT - 1);
+    CHECK(mock_panels[0].com_pins == TEST_COM_PINS);
+
+    /* The scrolls end at the last page of the panel */
+    CHECK(SSD1306_hscroll_h(&screen, 0, true));
+    test_flush();
+    CHECK(mock_panels[0].scroll_end == SSD1306_PAGES - 1);
+    mock_panels[0].scroll_end = 0;
+    CHECK(SSD1306_hvscroll_h(&screen, 0, 1, false));
+    test_flush();
+    CHECK(mock_panels[0].scroll_end == SSD1306_PAGES - 1);
+    CHECK(SSD1306_scroll_disable_h(&screen));
+    test_flush();
+}
+
+static void test_corners(void)
+{
+    /* The first and the last pixel */
+    SSD1306_fill_h(&screen, false);
+    SSD1306_set_pixel_h(&screen, 0, 0, true);
+    SSD1306_set_pixel_h(&screen, SSD1306_WIDTH - 1, SSD1306_HEIGHT - 1, true);
+    CHECK(buffer[0] == 0x01 && buffer[SSD1306_BUFFER_SZ - 1] == 0x80);
+
+    CHECK(SSD1306_refresh_h(&screen));
+    test_flush();
+    CHECK(mock_panels[0].ram[0][TEST_COLUMN_OFFSET] == 0x01);
+    CHECK(mock_panels[0].ram[SSD1306_PAGES - 1][TEST_COLUMN_OFFSET + SSD1306_WIDTH - 1] == 0x80);
+    CHECK(test_panel_is(0, buffer));
+    CHECK(outside_blank(0));
+
+    /* Off the panel, nothing is drawn */
+    SSD1306_set_pixel_h(&screen, SSD1306_WIDTH, 0, true);
+    SSD1306_set_pixel_h(&screen, 0, SSD1306_HEIGHT, true);
+    CHECK(buffer[0] == 0x01 && buffer[SSD1306_BUFFER_SZ - 1] == 0x80);
+
+    /* The whole panel, and no more */
+    SSD1306_fill_h(&screen, true);
+    CHECK(SSD1306_refresh_h(&screen));
+    test_flush();
+    CHECK(test_panel_is(0, buffer));
+    CHECK(outside_blank(0));
+}
+
+#ifdef SSD1306_PARTIAL_REFRESH
+static void test_partial(void)
+{
+    SSD1306_fill_h(&screen, false);
+    CHECK(SSD1306_refresh_h(&screen));
+    test_flush();
+
+    for(int i = 0; i < 200; i++)
+    {
+        uint8_t x = test_rand() % SSD1306_WIDTH, y = test_rand() % SSD1306_HEIGHT;
+
+        SSD1306_set_pixel_h(&screen, x, y, test_rand() & 0x01);
+        if(i & 0x01) SSD1306_draw_vline_h(&screen, test_rand() % SSD1306_WIDTH, 0, SSD1306_HEIGHT, true);
+
+        CHECK(SSD1306_refresh_partial_h(&screen));
+        test_flush();
+        if(!test_panel_is(0, buffer) || !outside_blank(0))
+        {
+            test_failures++;
+            return;
+        }
+    }
+}
+#endif
+
+int main(void)
+{
+    mock_reset();
+
+    test_setup();
+    test_corners();
+#ifdef SSD1306_PARTIAL_REFRESH
+    test_partial();
+#endif
+
+    return test_report("test_geometry");
+}
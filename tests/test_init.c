@@ -0,0 +1,122 @@
+/*
+ * Initialization - The fields managed by the library are reset, whatever the handle held before,
+ * while the ones set by the user (and the bus a screen is attached to) are kept.
+ */
+
+#include "test.h"
+
+static uint8_t buffer[SSD1306_BUFFER_SZ], other_buffer[SSD1306_BUFFER_SZ];
+static ssd_1306_t screen, other;
+
+#ifdef SSD1306_DMA_ACTIVE
+static uint8_t left_buffer[SSD1306_BUFFER_SZ], right_buffer[SSD1306_BUFFER_SZ];
+static ssd_1306_t left, right;
+static ssd_1306_bus_t bus;
+#endif
+
+static void test_stale_handle(void)
+{
+    /* A handle filled field by field, over whatever was in memory */
+    memset(&screen, 0xa5, sizeof(screen));
+    test_wire(&screen, buffer, 0);
+    CHECK(SSD1306_init_h(&screen));
+    test_flush();
+
+    CHECK(screen.rop == SSD1306_ROP_COPY);
+    CHECK(!screen.sprites && !screen.sprite_top);
+    CHECK(screen.x_pos == 0 && screen.y_pos == 0);
+    CHECK(screen.clip_y0 == 0 && screen.clip_y1 == SSD1306_HEIGHT - 1 && screen.strip_page == 0);
+#ifdef SSD1306_DMA_ACTIVE
+    CHECK(!screen.bus);
+    CHECK(!screen.dma_transfer && !screen.q_frames);
+#endif
+#ifdef SSD1306_PARTIAL_REFRESH
+    CHECK(!screen.shadow_valid && !screen.partial_window);
+    CHECK(screen.stats.bytes_sent == 0);
+#endif
+
+    /* Drawing and refreshing behave as on a zeroed handle */
+    SSD1306_fill_h(&screen, false);
+    SSD1306_sprites_draw_h(&screen);
+    SSD1306_draw_rectangle_h(&screen, 3, 40, 2, 30, true, true);
+    SSD1306_draw_rectangle_h(&screen, 10, 20, 5, 9, true, true);
+    CHECK(buffer[10] == 0xfc && buffer[SSD1306_WIDTH + 10] == 0xff);
+    CHECK(SSD1306_refresh_h(&screen));
+    test_flush();
+    CHECK(test_panel_is(0, buffer));
+}
+
+static void test_current_screen(void)
+{
+    /* SSD1306_init() makes the screen the current one, SSD1306_init_h() does not */
+    memset(&screen, 0, sizeof(screen));
+    test_wire(&screen, buffer, 0);
+    CHECK(SSD1306_init(&screen));
+    CHECK(test_init(&other, other_buffer, 1));
+    test_flush();
+
+    SSD1306_fill(true);
+    SSD1306_fill_h(&other, false);
+    CHECK(buffer[0] == 0xff && other_buffer[0] == 0x00);
+
+    SSD1306_handle_swap(&other);
+    SSD1306_set_pixel(0, 0, true);
+    CHECK(other_buffer[0] == 0x01);
+    CHECK(SSD1306_refresh());
+    test_flush();
+    CHECK(test_panel_is(1, other_buffer));
+}
+
+#ifdef SSD1306_DMA_ACTIVE
+static void test_shared_bus(void)
+{
+    /* Screens on one SPI, attached before their initialization */
+    memset(&left, 0x5a, sizeof(left));
+    memset(&right, 0x5a, sizeof(right));
+    test_wire(&left, left_buffer, 2);
+    test_wire(&right, right_buffer, 3);
+    left.priority = right.priority = 0;
+    left.period = right.period = 20;
+
+    test_spi[2].Instance = &test_spi_inst[2];
+    bus = (ssd_1306_bus_t){.h_spi = &test_spi[2]};
+    CHECK(SSD1306_bus_attach(&bus, &left));
+    CHECK(SSD1306_bus_attach(&bus, &right));
+    mock_panel_spi[3] = &test_spi[2];
+    CHECK(SSD1306_init_h(&left));
+    CHECK(SSD1306_init_h(&right));
+    test_flush();
+
+    CHECK(left.bus == &bus && right.bus == &bus);
+    CHECK(left.h_spi == right.h_spi);
+
+    /* Both frames are queued at once, the bus serves them in turns */
+    SSD1306_fill_h(&left, false);
+    SSD1306_fill_h(&right, true);
+    SSD1306_draw_circle_h(&left, 30, 30, 20, true);
+    SSD1306_draw_circle_h(&right, 30, 30, 20, false);
+    CHECK(SSD1306_refresh_h(&left));
+    CHECK(SSD1306_refresh_h(&right));
+    test_flush();
+    CHECK(test_panel_is(2, left_buffer));
+    CHECK(test_panel_is(3, right_buffer));
+
+    /* A screen initialized again keeps its bus */
+    CHECK(SSD1306_init_h(&right));
+    test_flush();
+    CHECK(right.bus == &bus);
+}
+#endif
+
+int main(void)
+{
+    mock_reset();
+
+    test_stale_handle();
+    test_current_screen();
+#ifdef SSD1306_DMA_ACTIVE
+    test_shared_bus();
+#endif
+
+    return test_report("test_init");
+}
@@ -0,0 +1,175 @@
+/*
+ * Text layout - The lines of a box must hold the text in order, measured, justified and within the box,
+ * nothing may be lost when the layout reports a fit, and drawing must not leave the box.
+ */
+
+#include "test.h"
+
+static uint8_t buffer[SSD1306_BUFFER_SZ], before[SSD1306_BUFFER_SZ], ref[SSD1306_BUFFER_SZ];
+static ssd_1306_t screen, other;
+
+static const ssd_1306_font_t *const fonts[5] = {&medium_prop_font, &narrow_prop_font, NULL, NULL, NULL};
+static const uint8_t options[5] = {0, 0, SMALL_FONT, MEDIUM_FONT, LARGE_FONT};
+
+/* Words of random characters, a few of them in UTF-8, between spaces and newlines */
+static void random_text(char *str, int max)
+{
+    static const char *const extra[4] = {"\xc2\xb0", "\xc2\xb5", "\xce\xa9", "\xe2\x86\x91"};
+    int len = 0, words = 1 + test_rand() % 12;
+
+    for(int w = 0; w < words && len < max - 16; w++)
+    {
+        for(int n = 1 + test_rand() % 9; n; n--)
+        {
+            if(!(test_rand() % 20))
+            {
+                strcpy(str + len, extra[test_rand() % 4]);
+                len += strlen(str + len);
+            }
+            else
+            {
+                str[len++] = '!' + test_rand() % 0x5e;
+            }
+        }
+
+        uint8_t r = test_rand() % 10;
+        str[len++] = r ? ' ' : '\n';
+        if(r == 1) str[len++] = ' ';
+    }
+    str[len] = '\0';
+}
+
+/* The characters of a string that are drawn, without the spaces - The fixed-width fonts only have ASCII */
+static void ink(const char *str, uint16_t len, bool ascii, char *out)
+{
+    for(uint16_t i = 0; i < len && str[i]; i++)
+    {
+        if(str[i] != ' ' && str[i] != '\n' && !(ascii && (str[i] & 0x80))) *out++ = str[i];
+    }
+    *out = '\0';
+}
+
+static void test_boxes(void)
+{
+    char str[96], sub[96], text[96], lines[256], what[160];
+
+    for(int i = 0; i < 1000; i++)
+    {
+        const int font = test_rand() % 5;
+        ssd_1306_text_box_t box = {.str = str, .font = fonts[font], .option = options[font]};
+        uint16_t line_h, dots_w;
+
+        box.scale = 1 + ((test_rand() % 4) == 0);
+        box.x = test_rand() % (SSD1306_WIDTH / 2);
+        box.y = test_rand() % (SSD1306_HEIGHT / 2);
+        box.len_x = 1 + test_rand() % (SSD1306_WIDTH - 1 - box.x);
+        box.len_y = 1 + test_rand() % (SSD1306_HEIGHT - box.y);
+        box.justify = test_rand() % 3;
+        box.wrap = test_rand() & 0x01;
+        box.ellipsis = test_rand() & 0x01;
+        random_text(str, sizeof(str));
+
+        SSD1306_text_measure("A", box.option, box.font, box.scale, NULL, &line_h);
+        SSD1306_text_measure("...", box.option, box.font, box.scale, &dots_w, NULL);
+        snprintf(what, sizeof(what), "box %d of font %d at %u, %u (%u x %u), justify %u, wrap %d, ellipsis %d",
+                 i, font, box.x, box.y, box.len_x, box.len_y, box.justify, box.wrap, box.ellipsis);
+
+        bool fits = SSD1306_text_layout(&box);
+
+        /* The extent */
+        uint8_t widest = 0;
+        for(uint8_t n = 0; n < box.nb_lines; n++) widest = (box.lines[n].width > widest) ? box.lines[n].width : widest;
+        CHECK(box.width == widest);
+        CHECK(box.height == box.nb_lines * line_h);
+        CHECK(box.height <= box.len_y && box.nb_lines <= SSD1306_TEXT_LINES);
+
+        lines[0] = '\0';
+        for(uint8_t n = 0; n < box.nb_lines; n++)
+        {
+            const ssd_1306_text_line_t *line = &box.lines[n];
+            uint16_t width;
+
+            /* In order, measured and justified */
+            if(n) CHECK(line->start >= box.lines[n - 1].start + box.lines[n - 1].len);
+            CHECK(line->start + line->len <= strlen(str));
+
+            memcpy(sub, str + line->start, line->len);
+            sub[line->len] = '\0';
+            SSD1306_text_measure(sub, box.option, box.font, box.scale, &width, NULL);
+
+            if(line->ellipsis) CHECK(box.ellipsis && line->width <= box.len_x && line->width >= width + dots_w - 1);
+            else CHECK(line->width == width);
+            if(box.wrap || line->ellipsis) CHECK(line->width <= box.len_x);
+
+            if(line->width >= box.len_x) CHECK(line->x == 0);
+            else if(box.justify == SSD1306_JUSTIFY_CENTER) CHECK(line->x == (box.len_x - line->width) / 2);
+            else if(box.justify == SSD1306_JUSTIFY_RIGHT) CHECK(line->x == box.len_x - line->width);
+            else CHECK(line->x == 0);
+
+            ink(sub, line->len, !box.font, lines + strlen(lines));
+        }
+
+        /* Nothing lost when the whole text fits */
+        ink(str, strlen(str), !box.font, text);
+        if(fits) CHECK(!strcmp(text, lines));
+        if(test_failures) return;
+
+        /* Over random contents, nothing drawn outside the box */
+        bool invert = test_rand() & 0x01;
+
+        for(int n = 0; n < SSD1306_BUFFER_SZ; n++) buffer[n] = test_rand();
+        memcpy(before, buffer, SSD1306_BUFFER_SZ);
+        SSD1306_text_draw_h(&screen, &box, invert);
+
+        for(int y = 0; y < SSD1306_HEIGHT; y++)
+        {
+            for(int x = 0; x < SSD1306_WIDTH; x++)
+            {
+                if(x >= box.x && x < box.x + box.len_x && y >= box.y && y < box.y + box.len_y) continue;
+                if(test_ref_get(buffer, x, y) == test_ref_get(before, x, y)) continue;
+
+                fprintf(stderr, "%s: pixel %d, %d drawn outside\n", what, x, y);
+                test_failures++;
+                return;
+            }
+        }
+
+        /* On a blank screen, the lines are the text printed from their place */
+        SSD1306_fill_h(&screen, false);
+        SSD1306_fill_h(&other, false);
+        SSD1306_text_draw_h(&screen, &box, false);
+
+        for(uint8_t n = 0; n < box.nb_lines; n++)
+        {
+            const ssd_1306_text_line_t *line = &box.lines[n];
+            uint8_t x = box.x + line->x, y = box.y + n * line_h;
+
+            if(line->ellipsis) continue;
+
+            memcpy(sub, str + line->start, line->len);
+            sub[line->len] = '\0';
+
+            if(box.font) SSD1306_print_fstr_font_h(&other, sub, box.font, x, y, box.scale, false);
+            else SSD1306_print_fstr_h(&other, sub, box.option, x, y, box.scale, false);
+        }
+
+        bool dots = false;
+        for(uint8_t n = 0; n < box.nb_lines; n++) dots |= box.lines[n].ellipsis;
+        if(!dots && !test_buffer_is(buffer, ref, what))
+        {
+            test_failures++;
+            return;
+        }
+    }
+}
+
+int main(void)
+{
+    mock_reset();
+    CHECK(test_init(&screen, buffer, 0));
+    CHECK(test_init(&other, ref, 1));
+
+    test_boxes();
+
+    return test_report("test_layout");
+}
@@ -0,0 +1,221 @@
+/*
+ * Numbers - The number fonts, printed and kept on live readouts, must match a reference drawn pixel by pixel
+ * from the font tables, and a readout must only redraw (and send) the characters that changed.
+ */
+
+#include "test.h"
+
+static uint8_t buffer[SSD1306_BUFFER_SZ], ref[SSD1306_BUFFER_SZ];
+static uint8_t strip[SSD1306_STRIP_SZ];
+static ssd_1306_t screen, strip_screen;
+
+static const uint8_t *const fonts[2] = {MediumNumbers, BigNumbers};
+
+/* A value in units of its last decimal, in text - "-21.50" for -2150 with 2 decimals */
+static void ref_format(int32_t value, uint8_t decimals, char *str)
+{
+    int64_t magnitude = (value < 0) ? -(int64_t)value : value;
+    int64_t unit = 1;
+
+    for(uint8_t i = 0; i < decimals; i++) unit *= 10;
+
+    if(decimals) sprintf(str, "%s%lld.%0*lld", (value < 0) ? "-" : "", (long long)(magnitude / unit), decimals,
+                         (long long)(magnitude % unit));
+    else sprintf(str, "%s%lld", (value < 0) ? "-" : "", (long long)magnitude);
+}
+
+/* Cells of a number font, opaque - Characters that the font lacks are blank */
+static void ref_cells(const char *str, const uint8_t *font, int x, int y, bool invert)
+{
+    const uint8_t width = font[0], height = font[1];
+
+    for(; *str; str++, x += width)
+    {
+        const bool drawn = ((uint8_t)*str >= font[2]) && (((uint8_t)*str - font[2]) < font[3]);
+        const uint8_t *glyph = font + 4 + ((uint8_t)*str - font[2]) * width * ((height + 7) / 8);
+
+        for(int col = 0; col < width; col++)
+        {
+            for(int row = 0; row < height; row++)
+            {
+                bool pixel = drawn && ((glyph[(row / 8) * width + col] >> (row % 8)) & 0x01);
+                test_ref_set(ref, x + col, y + row, pixel != invert);
+            }
+        }
+    }
+}
+
+/* A random value, of any number of digits */
+static int32_t random_value(void)
+{
+    int32_t value = test_rand() >> (test_rand() % 32);
+
+    return (test_rand() & 0x01) ? -value : value;
+}
+
+static void test_print_num(void)
+{
+    char str[24], what[64];
+
+    for(int i = 0; i < 2000; i++)
+    {
+        const uint8_t *font = fonts[i & 0x01];
+        uint8_t x = test_rand() % SSD1306_WIDTH, y = test_rand() % SSD1306_HEIGHT, decimals = test_rand() % 10;
+        int32_t value = (i == 0) ? INT32_MIN : random_value();
+        bool invert = test_rand() & 0x01;
+
+        if(i & 0x02) y &= ~0x07;
+
+        SSD1306_print_num_h(&screen, value, decimals, font, x, y, invert);
+        ref_format(value, decimals, str);
+        ref_cells(str, font, x, y, invert);
+
+        snprintf(what, sizeof(what), "print_num(%s) at %u, %u", str, x, y);
+        if(!test_buffer_is(buffer, ref, what))
+        {
+            test_failures++;
+            return;
+        }
+    }
+
+    /* Illegal decimals draw nothing */
+    SSD1306_print_num_h(&screen, 42, 10, MediumNumbers, 0, 0, false);
+    CHECK(test_buffer_is(buffer, ref, "print_num with 10 decimals"));
+}
+
+/* The characters of a readout, right-aligned in its cells or dashes */
+static void ref_readout(const ssd_1306_number_t *num, int32_t value, char *cells)
+{
+    char str[24];
+
+    ref_format(value, num->decimals, str);
+
+    int len = strlen(str), pad = num->cells - len;
+
+    for(int i = 0; i < num->cells; i++) cells[i] = (pad < 0) ? '-' : ((i < pad) ? ' ' : str[i - pad]);
+    cells[num->cells] = '\0';
+}
+
+static void test_readout(void)
+{
+    ssd_1306_number_t num = {.font = BigNumbers, .x = 2, .y = 8, .cells = 6, .decimals = 1};
+    char cells[SSD1306_NUMBER_SZ + 1], shown[SSD1306_NUMBER_SZ + 1] = "";
+    const uint8_t pages = (BigNumbers[1] + 7) / 8;
+    uint8_t onscreen = 0;
+
+    if(num.y + BigNumbers[1] > SSD1306_HEIGHT) num.font = MediumNumbers, num.y = 0;
+    num.invert = SSD1306_HEIGHT > 32;
+
+    /* On a narrow panel, the last cells are off the right edge */
+    for(int n = 0; n < num.cells; n++) onscreen += (num.x + n * num.font[0] < SSD1306_WIDTH);
+
+#ifdef SSD1306_PARTIAL_REFRESH
+    CHECK(SSD1306_refresh_h(&screen));
+    test_flush();
+#endif
+
+    for(int i = 0; i < 500; i++)
+    {
+        /* Mostly the last digits moving, as on a live readout */
+        int32_t value = (i % 50) ? 1234 + (int32_t)(test_rand() % 30) - 15 : random_value() % 10000000;
+        uint8_t changed = 0;
+
+        ref_readout(&num, value, cells);
+        for(int n = 0; n < num.cells; n++)
+        {
+            changed += (num.x + n * num.font[0] < SSD1306_WIDTH) && (!shown[0] || (cells[n] != shown[n]));
+        }
+        memcpy(shown, cells, sizeof(cells));
+
+        CHECK(SSD1306_number_update_h(&screen, &num, value) == changed);
+        ref_cells(cells, num.font, num.x, num.y, num.invert);
+        if(!test_buffer_is(buffer, ref, cells))
+        {
+            test_failures++;
+            return;
+        }
+
+#ifdef SSD1306_PARTIAL_REFRESH
+        /* Only the cells redrawn reach the display */
+        SSD1306_reset_stats_h(&screen);
+        CHECK(SSD1306_refresh_partial_h(&screen));
+        test_flush();
+        CHECK(screen.stats.bytes_sent - 6 * screen.stats.windows <= (uint32_t)changed * num.font[0] * pages);
+        CHECK(test_panel_is(0, buffer));
+#else
+        (void)pages;
+#endif
+    }
+
+    /* Drawn in any draw mode, the cells stay opaque */
+    num.drawn = false;
+    SSD1306_draw_mode_h(&screen, SSD1306_ROP_XOR);
+    CHECK(SSD1306_number_update_h(&screen, &num, 1234) == onscreen);
+    SSD1306_draw_mode_h(&screen, SSD1306_ROP_COPY);
+    ref_readout(&num, 1234, cells);
+    ref_cells(cells, num.font, num.x, num.y, num.invert);
+    CHECK(test_buffer_is(buffer, ref, "readout in XOR"));
+
+    /* The same value redraws nothing */
+    CHECK(SSD1306_number_update_h(&screen, &num, 1234) == 0);
+}
+
+/* A readout that runs off the right edge draws the cells that fit, and nothing at the left */
+static void test_readout_edge(void)
+{
+    ssd_1306_number_t num = {.font = BigNumbers, .x = SSD1306_WIDTH - 20, .y = 0, .cells = 5};
+    const uint8_t fit = (SSD1306_WIDTH - num.x + BigNumbers[0] - 1) / BigNumbers[0];
+
+    SSD1306_fill_h(&screen, false);
+    memset(ref, 0, SSD1306_BUFFER_SZ);
+
+    CHECK(SSD1306_number_update_h(&screen, &num, 12345) == fit);
+    ref_cells("12345", num.font, num.x, num.y, num.invert);
+    CHECK(test_buffer_is(buffer, ref, "readout off the right edge"));
+    CHECK(memcmp(num.shown, "12345", num.cells) == 0);
+
+    /* The cells off the edge are remembered, so the same value redraws nothing */
+    CHECK(SSD1306_number_update_h(&screen, &num, 12345) == 0);
+    CHECK(SSD1306_number_update_h(&screen, &num, 12399) == 0);
+    CHECK(memcmp(num.shown, "12399", num.cells) == 0);
+    CHECK(test_buffer_is(buffer, ref, "readout changed off the right edge"));
+}
+
+/* A readout and numbers across the page boundaries */
+static void draw_numbers(void *arg)
+{
+    static ssd_1306_number_t num = {.font = MediumNumbers, .x = 60, .y = 3, .cells = 5, .decimals = 2};
+    ssd_1306_t *h = arg;
+
+    SSD1306_draw_rectangle_h(h, 0, SSD1306_WIDTH / 2, 2, SSD1306_HEIGHT - 3, true, true);
+    SSD1306_print_num_h(h, -2150, 2, MediumNumbers, 4, 5, false);
+    SSD1306_print_num_h(h, 42, 0, BigNumbers, 20, 0, true);
+    SSD1306_number_update_h(h, &num, 31415);
+}
+
+static void test_strips(void)
+{
+    SSD1306_fill_h(&screen, false);
+    draw_numbers(&screen);
+    CHECK(SSD1306_refresh_h(&screen));
+    test_flush();
+
+    CHECK(test_init(&strip_screen, strip, 1));
+    CHECK(SSD1306_render_strips_h(&strip_screen, draw_numbers, &strip_screen));
+    test_flush();
+    CHECK(test_panel_is(1, buffer));
+}
+
+int main(void)
+{
+    mock_reset();
+    CHECK(test_init(&screen, buffer, 0));
+    memcpy(ref, buffer, SSD1306_BUFFER_SZ);
+
+    test_print_num();
+    test_readout();
+    test_readout_edge();
+    test_strips();
+
+    return test_report("test_numbers");
+}
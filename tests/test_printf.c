@@ -0,0 +1,179 @@
+/*
+ * Formatted text - SSD1306_printf() must draw what snprintf() followed by SSD1306_print_str() draws,
+ * and %q what the number formatting of SSD1306_print_num() gives.
+ */
+
+#include "test.h"
+
+static uint8_t buffer[SSD1306_BUFFER_SZ], other_buffer[SSD1306_BUFFER_SZ];
+static ssd_1306_t screen, other;
+
+static const uint8_t fonts[3] = {SMALL_FONT, MEDIUM_FONT, LARGE_FONT};
+
+/* Random printable ASCII, without '%' that would start a conversion in a format */
+static void random_text(char *str, int max)
+{
+    int len = test_rand() % max;
+
+    for(int i = 0; i < len; i++)
+    {
+        do str[i] = 0x20 + test_rand() % 0x5f; while(str[i] == '%');
+    }
+    str[len] = '\0';
+}
+
+/* A fixed-point value, in units of its last decimal, padded like a %d */
+static void ref_fixed(char *str, size_t size, int32_t value, int decimals, char flags, int width)
+{
+    int64_t magnitude = (value < 0) ? -(int64_t)value : value, unit = 1;
+    char digits[24];
+
+    for(int i = 0; i < decimals; i++) unit *= 10;
+    if(decimals) snprintf(digits, sizeof(digits), "%lld.%0*lld", (long long)(magnitude / unit), decimals,
+                          (long long)(magnitude % unit));
+    else snprintf(digits, sizeof(digits), "%lld", (long long)magnitude);
+
+    int len = strlen(digits) + (value < 0), pad = (width > len) ? width - len : 0;
+
+    if(flags == '-') snprintf(str, size, "%s%s%*s", (value < 0) ? "-" : "", digits, pad, "");
+    else if(flags == '0') snprintf(str, size, "%s%.*s%s", (value < 0) ? "-" : "", pad, "000000000000", digits);
+    else snprintf(str, size, "%*s%s%s", pad, "", (value < 0) ? "-" : "", digits);
+}
+
+/* A random value, of any number of digits */
+static int32_t random_value(void)
+{
+    int32_t value = test_rand() >> (test_rand() % 32);
+
+    return (test_rand() & 0x01) ? -value : value;
+}
+
+static void test_formats(void)
+{
+    static const char *const flag_set[] = {"", "-", "0", "-0"};
+    char fmt[64], expected[2048], text[24], before[12], after[12], what[128];
+
+    for(int i = 0; i < 1000; i++)
+    {
+        uint8_t option = fonts[i % 3] | (test_rand() & ALIGMENT_MASK);
+        bool invert = test_rand() & 0x01;
+        const char *flags = flag_set[test_rand() % 4];
+        int width = (test_rand() & 0x01) ? (int)(test_rand() % 12) : -1;
+        char field[16] = "";
+
+        if(width >= 0) snprintf(field, sizeof(field), "%s%d", flags, width);
+        random_text(before, sizeof(before));
+        random_text(after, sizeof(after));
+
+        /* From time to time, a fresh screen */
+        if(!(i % 20))
+        {
+            SSD1306_fill_h(&screen, false);
+            SSD1306_fill_h(&other, false);
+            uint8_t x = test_rand() % SSD1306_WIDTH, y = test_rand() % SSD1306_HEIGHT;
+            SSD1306_coord_h(&screen, x, y);
+            SSD1306_coord_h(&other, x, y);
+        }
+
+        switch(test_rand() % 9)
+        {
+            case 0:
+            {
+                int value = random_value();
+                snprintf(fmt, sizeof(fmt), "%s%%%sd%s", before, field, after);
+                SSD1306_printf_h(&screen, option, invert, fmt, value);
+                snprintf(expected, sizeof(expected), fmt, value);
+                break;
+            }
+            case 1:
+            {
+                long value = random_value();
+                snprintf(fmt, sizeof(fmt), "%s%%%sli%s", before, field, after);
+                SSD1306_printf_h(&screen, option, invert, fmt, value);
+                snprintf(expected, sizeof(expected), fmt, value);
+                break;
+            }
+            case 2:
+            {
+                unsigned value = test_rand() >> (test_rand() % 32);
+                const char *conv = (test_rand() & 0x01) ? "u" : ((test_rand() & 0x01) ? "x" : "X");
+                snprintf(fmt, sizeof(fmt), "%s%%%s%s%s", before, field, conv, after);
+                SSD1306_printf_h(&screen, option, invert, fmt, value);
+                snprintf(expected, sizeof(expected), fmt, value);
+                break;
+            }
+            case 3:
+            {
+                /* %05c is left to the library */
+                int c = 0x20 + test_rand() % 0x5f;
+                if(width >= 0) snprintf(field, sizeof(field), "%s%d", (flags[0] == '-') ? "-" : "", width);
+                snprintf(fmt, sizeof(fmt), "%s%%%sc%s", before, field, after);
+                SSD1306_printf_h(&screen, option, invert, fmt, c);
+                snprintf(expected, sizeof(expected), fmt, c);
+                break;
+            }
+            case 4:
+            {
+                /* %05s too */
+                int precision = (test_rand() & 0x01) ? (int)(test_rand() % 8) : -1;
+                if(width >= 0) snprintf(field, sizeof(field), "%s%d", (flags[0] == '-') ? "-" : "", width);
+                if(precision >= 0) snprintf(field + strlen(field), sizeof(field) - strlen(field), ".%d", precision);
+                random_text(text, sizeof(text));
+                snprintf(fmt, sizeof(fmt), "%s%%%ss%s", before, field, after);
+                SSD1306_printf_h(&screen, option, invert, fmt, text);
+                snprintf(expected, sizeof(expected), fmt, text);
+                break;
+            }
+            case 5:
+            {
+                int value = random_value(), star = test_rand() % 10;
+                snprintf(fmt, sizeof(fmt), "%s%%*d%s", before, after);
+                SSD1306_printf_h(&screen, option, invert, fmt, star, value);
+                snprintf(expected, sizeof(expected), fmt, star, value);
+                break;
+            }
+            case 6:
+            {
+                int star = test_rand() % 8;
+                random_text(text, sizeof(text));
+                snprintf(fmt, sizeof(fmt), "%s%%.*s%s%%%%", before, after);
+                SSD1306_printf_h(&screen, option, invert, fmt, star, text);
+                snprintf(expected, sizeof(expected), fmt, star, text);
+                break;
+            }
+            default:
+            {
+                int32_t value = random_value();
+                int decimals = test_rand() % 10;
+                char number[64];
+
+                snprintf(fmt, sizeof(fmt), "%s%%%s.%dq%s", before, field, decimals, after);
+                SSD1306_printf_h(&screen, option, invert, fmt, value);
+                ref_fixed(number, sizeof(number), value, decimals,
+                          (flags[0] == '-') ? '-' : (flags[0] ? '0' : 0), (width < 0) ? 0 : width);
+                snprintf(expected, sizeof(expected), "%s%s%s", before, number, after);
+                break;
+            }
+        }
+
+        SSD1306_print_str_h(&other, expected, option, invert);
+
+        snprintf(what, sizeof(what), "printf(\"%s\") as \"%.40s\"", fmt, expected);
+        if(!test_buffer_is(buffer, other_buffer, what) || screen.x_pos != other.x_pos || screen.y_pos != other.y_pos)
+        {
+            test_failures++;
+            return;
+        }
+    }
+}
+
+int main(void)
+{
+    mock_reset();
+    CHECK(test_init(&screen, buffer, 0));
+    CHECK(test_init(&other, other_buffer, 1));
+
+    test_formats();
+
+    return test_report("test_printf");
+}
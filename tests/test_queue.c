@@ -0,0 +1,104 @@
+/*
+ * DMA queue - Commands are queued behind a frame in flight instead of being rejected,
+ * while a refresh waits for the previous frame to be sent.
+ */
+
+#include "test.h"
+
+#ifdef SSD1306_DMA_ACTIVE
+static uint8_t buffer[SSD1306_BUFFER_SZ], other_buffer[SSD1306_BUFFER_SZ];
+static ssd_1306_t screen, other;
+
+static void test_commands_behind_frame(void)
+{
+    CHECK(test_init(&screen, buffer, 0));
+    SSD1306_fill_h(&screen, false);
+    SSD1306_draw_rectangle_h(&screen, 5, 50, 5, 14, true, true);
+
+    /* The frame stays in flight, the commands return at once */
+    mock_dma_stall = true;
+    CHECK(SSD1306_refresh_h(&screen));
+    CHECK(SSD1306_contrast_h(&screen, 0x40));
+    CHECK(SSD1306_invert_h(&screen, false));
+    CHECK(SSD1306_contrast_h(&screen, 0x41));
+    CHECK(screen.q_frames == 1);
+
+    /* The refresh is rejected, nothing is queued */
+    CHECK(!SSD1306_refresh_h(&screen));
+#ifdef SSD1306_PARTIAL_REFRESH
+    CHECK(!SSD1306_refresh_partial_h(&screen));
+#endif
+    CHECK(screen.q_frames == 1);
+
+    /* The copied commands go out after the frame, in order */
+    mock_dma_stall = false;
+    test_flush();
+    CHECK(!screen.q_frames && !screen.dma_transfer);
+    CHECK(mock_panels[0].contrast == 0x41);
+    CHECK(test_panel_is(0, buffer));
+    CHECK(SSD1306_refresh_h(&screen));
+    test_flush();
+}
+
+static void test_full_rings(void)
+{
+    uint8_t accepted = 0;
+
+    CHECK(test_init(&screen, buffer, 0));
+
+    /* Commands are refused once the rings are full, never overwritten */
+    mock_dma_stall = true;
+    CHECK(SSD1306_refresh_h(&screen));
+    for(int i = 0; i < 200; i++)
+    {
+        if(!SSD1306_contrast_h(&screen, (uint8_t)i)) break;
+        accepted = (uint8_t)i;
+    }
+    CHECK(accepted > 8 && accepted < 200);
+
+    mock_dma_stall = false;
+    test_flush();
+    CHECK(mock_panels[0].contrast == accepted);
+    CHECK(test_panel_is(0, buffer));
+
+    /* And accepted again once drained */
+    CHECK(SSD1306_contrast_h(&screen, 0x22));
+    test_flush();
+    CHECK(mock_panels[0].contrast == 0x22);
+}
+
+static void test_two_buses(void)
+{
+    CHECK(test_init(&screen, buffer, 0));
+    CHECK(test_init(&other, other_buffer, 1));
+    SSD1306_fill_h(&screen, false);
+    SSD1306_fill_h(&other, true);
+    SSD1306_draw_line_h(&screen, 0, SSD1306_WIDTH - 1, 0, SSD1306_HEIGHT - 1, true);
+    SSD1306_draw_line_h(&other, 0, SSD1306_WIDTH - 1, SSD1306_HEIGHT - 1, 0, false);
+
+    /* Both frames are sent at the same time, each completion advances its own screen */
+    mock_dma_stall = true;
+    CHECK(SSD1306_refresh_h(&screen));
+    CHECK(SSD1306_refresh_h(&other));
+    CHECK(screen.dma_transfer && other.dma_transfer);
+
+    mock_dma_stall = false;
+    test_flush();
+    CHECK(!screen.q_frames && !other.q_frames);
+    CHECK(test_panel_is(0, buffer));
+    CHECK(test_panel_is(1, other_buffer));
+}
+#endif
+
+int main(void)
+{
+    mock_reset();
+
+#ifdef SSD1306_DMA_ACTIVE
+    test_commands_behind_frame();
+    test_full_rings();
+    test_two_buses();
+#endif
+
+    return test_report("test_queue");
+}
@@ -0,0 +1,252 @@
+/*
+ * Refreshes - What reaches the display RAM must be the buffer, whatever the refresh path,
+ * and a partial refresh must only cost the bytes that changed.
+ */
+
+#include "test.h"
+
+static uint8_t buffer[SSD1306_BUFFER_SZ];
+static uint8_t strip[SSD1306_STRIP_SZ];
+static ssd_1306_t screen, strip_screen;
+
+/* Draws a random shape */
+static void draw_random(ssd_1306_t *h)
+{
+    uint8_t x0 = test_rand() % SSD1306_WIDTH, x1 = test_rand() % SSD1306_WIDTH;
+    uint8_t y0 = test_rand() % SSD1306_HEIGHT, y1 = test_rand() % SSD1306_HEIGHT;
+    bool color = test_rand() & 0x01;
+
+    if(x0 > x1) { uint8_t x = x0; x0 = x1; x1 = x; }
+    if(y0 > y1) { uint8_t y = y0; y0 = y1; y1 = y; }
+
+    switch(test_rand() % 5)
+    {
+        case 0:
+            SSD1306_set_pixel_h(h, x0, y0, color);
+            break;
+        case 1:
+            SSD1306_draw_line_h(h, x0, x1, y0, y1, color);
+            break;
+        case 2:
+            SSD1306_draw_rectangle_h(h, x0, x0 + (x1 - x0) / 4, y0, y0 + (y1 - y0) / 4, color, true);
+            break;
+        case 3:
+            SSD1306_draw_circle_h(h, x0, y0, test_rand() % 12, color);
+            break;
+        default:
+            SSD1306_print_fstr_h(h, "42", SMALL_FONT, x0, y0, 1, color);
+            break;
+    }
+}
+
+/* The strip scene, drawn the same way on a full buffer and page by page */
+static void draw_scene(void *arg)
+{
+    ssd_1306_t *h = arg;
+
+    SSD1306_draw_rectangle_h(h, 2, SSD1306_WIDTH - 3, 1, SSD1306_HEIGHT - 2, true, false);
+    SSD1306_draw_line_h(h, 0, SSD1306_WIDTH - 1, 0, SSD1306_HEIGHT - 1, true);
+    SSD1306_draw_fill_circle_h(h, SSD1306_WIDTH / 2, SSD1306_HEIGHT / 2, SSD1306_HEIGHT / 3, true);
+    SSD1306_print_fstr_h(h, "Strip", MEDIUM_FONT, 5, 3, 1, true);
+}
+
+static void test_full(void)
+{
+    CHECK(test_init(&screen, buffer, 0));
+
+    for(int i = 0; i < 50; i++) draw_random(&screen);
+    CHECK(SSD1306_refresh_h(&screen));
+    test_flush();
+    CHECK(test_panel_is(0, buffer));
+}
+
+#ifdef SSD1306_PARTIAL_REFRESH
+static uint8_t shadow[SSD1306_BUFFER_SZ];
+
+static void test_one_digit(void)
+{
+    uint32_t full, sent;
+
+    CHECK(test_init(&screen, buffer, 0));
+    SSD1306_fill_h(&screen, false);
+
+    SSD1306_print_fstr_h(&screen, "12:34", MEDIUM_FONT, 10, 8, 1, false);
+    sent = mock_spi_bytes;
+    CHECK(SSD1306_refresh_h(&screen));
+    test_flush();
+    full = mock_spi_bytes - sent;
+    CHECK(full == SSD1306_BUFFER_SZ);
+    CHECK(screen.stats.bytes_sent == full);
+
+    /* Only the last digit is redrawn: its glyph cell (5 columns and the spacing) in one window */
+    SSD1306_reset_stats_h(&screen);
+    SSD1306_print_fstr_h(&screen, "5", MEDIUM_FONT, 10 + 4 * 6, 8, 1, false);
+    sent = mock_spi_bytes;
+    CHECK(SSD1306_refresh_partial_h(&screen));
+    test_flush();
+    CHECK(screen.stats.windows == 1);
+    CHECK(screen.stats.bytes_sent == mock_spi_bytes - sent);
+    CHECK(screen.stats.bytes_sent <= 6 + 6);
+    CHECK(screen.stats.bytes_sent + screen.stats.bytes_skipped == SSD1306_BUFFER_SZ + 6);
+    CHECK(test_panel_is(0, buffer));
+
+    /* Nothing changed, nothing sent */
+    sent = mock_spi_bytes;
+    CHECK(SSD1306_refresh_partial_h(&screen));
+    test_flush();
+    CHECK(mock_spi_bytes == sent);
+
+    /* With a shadow, redrawing the whole string only sends the columns that differ */
+    screen.shadow = shadow;
+    CHECK(SSD1306_refresh_h(&screen));
+    test_flush();
+    SSD1306_reset_stats_h(&screen);
+    SSD1306_print_fstr_h(&screen, "12:36", MEDIUM_FONT, 10, 8, 1, false);
+    sent = mock_spi_bytes;
+    CHECK(SSD1306_refresh_h(&screen));
+    test_flush();
+    CHECK(screen.stats.bytes_sent == mock_spi_bytes - sent);
+    CHECK(screen.stats.bytes_sent <= 6 + 5);
+    CHECK(test_panel_is(0, buffer));
+    screen.shadow = NULL;
+}
+
+static void test_partial(void)
+{
+    CHECK(test_init(&screen, buffer, 0));
+    CHECK(SSD1306_refresh_h(&screen));
+    test_flush();
+
+    for(int i = 0; i < 300; i++)
+    {
+        for(int n = test_rand() % 4; n >= 0; n--) draw_random(&screen);
+
+        /* Mixed with full refreshes, which must restore the address window */
+        CHECK((i % 37) ? SSD1306_refresh_partial_h(&screen) : SSD1306_refresh_h(&screen));
+        test_flush();
+        CHECK(test_panel_is(0, buffer));
+    }
+}
+
+static void test_shadow(void)
+{
+    uint32_t sent;
+
+    CHECK(test_init(&screen, buffer, 0));
+    screen.shadow = shadow;
+    CHECK(SSD1306_refresh_h(&screen));
+    test_flush();
+
+    for(int i = 0; i < 300; i++)
+    {
+        for(int n = test_rand() % 4; n >= 0; n--) draw_random(&screen);
+
+        CHECK((i & 0x01) ? SSD1306_refresh_partial_h(&screen) : SSD1306_refresh_h(&screen));
+        test_flush();
+        CHECK(test_panel_is(0, buffer));
+    }
+
+    /* Drawing the same pixels again does not change the display */
+    SSD1306_draw_rectangle_h(&screen, 0, 20, 0, 20, true, true);
+    CHECK(SSD1306_refresh_h(&screen));
+    test_flush();
+    SSD1306_draw_rectangle_h(&screen, 0, 20, 0, 20, true, true);
+    sent = mock_spi_bytes;
+    CHECK(SSD1306_refresh_h(&screen));
+    test_flush();
+    CHECK(mock_spi_bytes == sent);
+    CHECK(test_panel_is(0, buffer));
+}
+#endif
+
+#ifdef SSD1306_DMA_ACTIVE
+static uint8_t front[SSD1306_BUFFER_SZ];
+static uint8_t expected[SSD1306_BUFFER_SZ];
+
+static void test_double_buffer(void)
+{
+    CHECK(test_init(&screen, buffer, 0));
+    screen.front_buffer = front;
+
+    for(int i = 0; i < 200; i++)
+    {
+        for(int n = test_rand() % 4; n >= 0; n--) draw_random(&screen);
+        memcpy(expected, screen.buffer, SSD1306_BUFFER_SZ);
+
+        /* Hold the frame in flight while the next one is drawn */
+        mock_dma_stall = true;
+#ifdef SSD1306_PARTIAL_REFRESH
+        CHECK((i % 5) ? SSD1306_refresh_partial_h(&screen) : SSD1306_refresh_h(&screen));
+#else
+        CHECK(SSD1306_refresh_h(&screen));
+#endif
+        if(mock_dma_busy()) CHECK(!SSD1306_refresh_h(&screen));
+
+        /* The new back buffer starts as the frame sent */
+        CHECK(!memcmp(screen.buffer, expected, SSD1306_BUFFER_SZ));
+        for(int n = test_rand() % 4; n >= 0; n--) draw_random(&screen);
+
+        mock_dma_stall = false;
+        test_flush();
+        CHECK(test_panel_is(0, expected));
+
+        /* Carry on from what was drawn during the transfer */
+    }
+
+#ifdef SSD1306_PARTIAL_REFRESH
+    /* Writes straight into the buffer reach the next frame when marked */
+    screen.buffer[SSD1306_WIDTH + 7] ^= 0x5a;
+    SSD1306_mark_dirty_h(&screen, 7, 7, 8, 15);
+    memcpy(expected, screen.buffer, SSD1306_BUFFER_SZ);
+    CHECK(SSD1306_refresh_partial_h(&screen));
+    test_flush();
+    CHECK(!memcmp(screen.buffer, expected, SSD1306_BUFFER_SZ));
+    CHECK(test_panel_is(0, expected));
+#endif
+}
+#endif
+
+static void test_strips(void)
+{
+    /* Reference on a whole buffer */
+    CHECK(test_init(&screen, buffer, 0));
+    SSD1306_fill_h(&screen, false);
+    draw_scene(&screen);
+    CHECK(SSD1306_refresh_h(&screen));
+    test_flush();
+
+    /* With DMA, the strips wait for each other as time passes */
+    CHECK(test_init(&strip_screen, strip, 1));
+    CHECK(SSD1306_render_strips_h(&strip_screen, draw_scene, &strip_screen));
+    test_flush();
+
+    CHECK(test_panel_is(1, buffer));
+    CHECK(!memcmp(mock_panels[0].ram, mock_panels[1].ram, sizeof(mock_panels[0].ram)));
+
+#ifdef SSD1306_DMA_ACTIVE
+    /* A transfer that never completes fails the rendering instead of hanging it (two pages never wait) */
+    mock_dma_stall = true;
+    CHECK(SSD1306_render_strips_h(&strip_screen, draw_scene, &strip_screen) == (SSD1306_PAGES <= 2));
+    CHECK(strip_screen.buffer == strip);
+    mock_dma_stall = false;
+    test_flush();
+#endif
+}
+
+int main(void)
+{
+    mock_reset();
+
+    test_full();
+#ifdef SSD1306_PARTIAL_REFRESH
+    test_one_digit();
+    test_partial();
+    test_shadow();
+#endif
+#ifdef SSD1306_DMA_ACTIVE
+    test_double_buffer();
+#endif
+    test_strips();
+
+    return test_report("test_refresh");
+}
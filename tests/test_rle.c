@@ -0,0 +1,193 @@
+/*
+ * Compressed bitmaps - SSD1306_draw_bitmap_rle() must draw what SSD1306_draw_bitmap() draws from the same bitmap,
+ * in every draw mode, at any place and over any contents, mark the same area for the partial refresh, and work
+ * in strips. The bitmaps are compressed with packets split at random, so that any valid stream is decoded.
+ */
+
+#include "test.h"
+
+#define BITMAP_MAX  (255 * 32)
+
+static uint8_t buffer[SSD1306_BUFFER_SZ], rle_buffer[SSD1306_BUFFER_SZ];
+static uint8_t strip[SSD1306_STRIP_SZ];
+static uint8_t bitmap[BITMAP_MAX], packed[BITMAP_MAX + BITMAP_MAX / 128 + 1];
+static ssd_1306_t screen, rle_screen, strip_screen;
+
+static const uint8_t rops[4] = {SSD1306_ROP_COPY, SSD1306_ROP_OR, SSD1306_ROP_AND_NOT, SSD1306_ROP_XOR};
+
+/* Compresses bytes, with runs and literals of lengths drawn from the seed - Returns the size */
+static uint16_t ref_rle(const uint8_t *data, uint16_t len, uint8_t *out, uint32_t seed)
+{
+    uint16_t size = 0;
+
+    for(uint16_t i = 0; i < len;)
+    {
+        uint16_t same = 1;
+        while(i + same < len && same < 129 && data[i + same] == data[i]) same++;
+        seed = seed * 1103515245 + 12345;
+
+        if(same >= 2 && ((seed >> 8) & 0x03))
+        {
+            uint8_t n = 2 + (seed >> 16) % (same - 1);
+            out[size++] = 0x80 + n - 2;
+            out[size++] = data[i];
+            i += n;
+            continue;
+        }
+
+        uint16_t n = 1 + (seed >> 16) % ((len - i < 128) ? len - i : 128);
+        out[size++] = n - 1;
+        memcpy(out + size, data + i, n);
+        size += n;
+        i += n;
+    }
+    return size;
+}
+
+/* Mostly blank art - Runs of blank, black or a random byte, and noise */
+static void random_bitmap(uint16_t len)
+{
+    for(uint16_t i = 0; i < len;)
+    {
+        uint16_t n = 1 + test_rand() % 200;
+        uint8_t kind = test_rand() % 8, value = (kind < 4) ? 0x00 : ((kind == 4) ? 0xff : test_rand());
+
+        if(n > len - i) n = len - i;
+        for(uint16_t k = 0; k < n; k++) bitmap[i + k] = (kind == 7) ? test_rand() : value;
+        i += n;
+    }
+}
+
+/* Draws a bitmap on both screens, plain and compressed - False on the first difference */
+static bool draw_both(uint8_t x0, uint8_t y0, uint8_t len_x, uint8_t len_y, uint8_t rop, const char *what)
+{
+    const uint16_t len = len_x * ((len_y + 7) / 8);
+
+    random_bitmap(len);
+    uint16_t size = ref_rle(bitmap, len, packed, test_rand());
+
+    /* Exactly the size of the stream, so that reading past it is caught */
+    uint8_t *rle = malloc(size);
+    memcpy(rle, packed, size);
+
+    SSD1306_draw_mode_h(&screen, rop);
+    SSD1306_draw_mode_h(&rle_screen, rop);
+    SSD1306_draw_bitmap_h(&screen, bitmap, x0, y0, len_x, len_y, 1);
+    SSD1306_draw_bitmap_rle_h(&rle_screen, rle, x0, y0, len_x, len_y);
+    free(rle);
+
+    char msg[128];
+    snprintf(msg, sizeof(msg), "%s %u x %u at %u, %u in draw mode %u", what, len_x, len_y, x0, y0, rop);
+    if(!test_buffer_is(rle_buffer, buffer, msg)) return false;
+
+#ifdef SSD1306_PARTIAL_REFRESH
+    if(memcmp(screen.dirty_map, rle_screen.dirty_map, sizeof(screen.dirty_map)))
+    {
+        fprintf(stderr, "%s: not the same dirty map\n", msg);
+        return false;
+    }
+#endif
+    return true;
+}
+
+static void test_random(void)
+{
+    for(int i = 0; i < 3000; i++)
+    {
+        uint8_t x0 = test_rand() % SSD1306_WIDTH, y0 = test_rand() % SSD1306_HEIGHT;
+        uint8_t len_x = 1 + test_rand() % (SSD1306_WIDTH + 20), len_y = 1 + test_rand() % (SSD1306_HEIGHT + 10);
+        uint8_t rop = rops[test_rand() % 4];
+
+        /* From time to time, splash screens - Whole pages, full width */
+        if(!(i % 5))
+        {
+            x0 = 0;
+            len_x = SSD1306_WIDTH;
+            y0 &= ~0x07;
+            len_y = 8 * (1 + test_rand() % SSD1306_PAGES);
+            if(i % 10) rop = SSD1306_ROP_COPY;
+        }
+
+        /* Over the same random contents */
+        if(!(i % 4))
+        {
+            for(int n = 0; n < SSD1306_BUFFER_SZ; n++) buffer[n] = test_rand();
+            memcpy(rle_buffer, buffer, SSD1306_BUFFER_SZ);
+        }
+
+#ifdef SSD1306_PARTIAL_REFRESH
+        memset(screen.dirty_map, 0, sizeof(screen.dirty_map));
+        memset(rle_screen.dirty_map, 0, sizeof(rle_screen.dirty_map));
+#endif
+
+        if(!draw_both(x0, y0, len_x, len_y, rop, "bitmap"))
+        {
+            test_failures++;
+            break;
+        }
+    }
+
+    SSD1306_draw_mode_h(&screen, SSD1306_ROP_COPY);
+    SSD1306_draw_mode_h(&rle_screen, SSD1306_ROP_COPY);
+}
+
+/* Bitmaps across the pages and a splash, the same ones on every call */
+static void draw_scene(void *arg)
+{
+    ssd_1306_t *h = arg;
+    uint32_t seed = 0x2545f491;
+
+    for(int i = 0; i < 6; i++)
+    {
+        uint8_t x0 = (seed >> 3) % SSD1306_WIDTH, y0 = (seed >> 11) % SSD1306_HEIGHT;
+        uint8_t len_x = 1 + (seed >> 17) % SSD1306_WIDTH, len_y = 1 + (seed >> 24) % SSD1306_HEIGHT;
+        uint16_t len = len_x * ((len_y + 7) / 8);
+
+        if(!i) x0 = y0 = 0, len_x = SSD1306_WIDTH, len_y = SSD1306_HEIGHT, len = SSD1306_BUFFER_SZ;
+
+        for(uint16_t n = 0; n < len; n++) bitmap[n] = (n / 37) & 0x01 ? (uint8_t)(seed >> (n % 24)) : 0x00;
+
+        SSD1306_draw_mode_h(h, rops[i % 4]);
+
+        /* The same packets for every strip */
+        if(h == &strip_screen)
+        {
+            ref_rle(bitmap, len, packed, seed);
+            SSD1306_draw_bitmap_rle_h(h, packed, x0, y0, len_x, len_y);
+        }
+        else
+        {
+            SSD1306_draw_bitmap_h(h, bitmap, x0, y0, len_x, len_y, 1);
+        }
+
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+    }
+    SSD1306_draw_mode_h(h, SSD1306_ROP_COPY);
+}
+
+static void test_strips(void)
+{
+    SSD1306_fill_h(&screen, false);
+    draw_scene(&screen);
+    CHECK(SSD1306_refresh_h(&screen));
+    test_flush();
+
+    CHECK(SSD1306_render_strips_h(&strip_screen, draw_scene, &strip_screen));
+    test_flush();
+    CHECK(test_panel_is(2, buffer));
+}
+
+int main(void)
+{
+    mock_reset();
+    CHECK(test_init(&screen, buffer, 0));
+    CHECK(test_init(&rle_screen, rle_buffer, 1));
+    CHECK(test_init(&strip_screen, strip, 2));
+
+    test_random();
+    test_strips();
+
+    return test_report("test_rle");
+}
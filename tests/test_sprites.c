@@ -0,0 +1,159 @@
+/*
+ * Sprites - Over many frames of moves, hides, z-order and background changes, the buffer
+ * must be the background with the visible sprites composited on top, and the panel must follow.
+ */
+
+#include "test.h"
+
+#define SPRITES     5
+#define SPRITE_MAX  24
+
+static uint8_t buffer[SSD1306_BUFFER_SZ], ref[SSD1306_BUFFER_SZ], background[SSD1306_BUFFER_SZ];
+static uint8_t images[SPRITES][SPRITE_MAX * SPRITE_MAX / 8], masks[SPRITES][SPRITE_MAX * SPRITE_MAX / 8];
+static uint8_t saves[SPRITES][SSD1306_SPRITE_SAVE_SZ(SPRITE_MAX, SPRITE_MAX)];
+static ssd_1306_sprite_t sprites[SPRITES];
+static ssd_1306_t screen;
+
+/* Pixel (x, y) of a sprite bitmap */
+static bool bitmap_pixel(const uint8_t *bmp, uint8_t len_x, int x, int y)
+{
+    return (bmp[(y / 8) * len_x + x] >> (y % 8)) & 0x01;
+}
+
+/* The background with the visible sprites on top, in the order of the list */
+static void composite(void)
+{
+    int z = 0;
+
+    memcpy(ref, background, SSD1306_BUFFER_SZ);
+    for(ssd_1306_sprite_t *s = screen.sprites; s; s = s->next)
+    {
+        CHECK(s->z >= z);
+        z = s->z;
+        if(!s->visible) continue;
+
+        for(int y = 0; y < s->len_y; y++)
+        {
+            for(int x = 0; x < s->len_x; x++)
+            {
+                if(s->mask && !bitmap_pixel(s->mask, s->len_x, x, y)) continue;
+                test_ref_set(ref, s->x + x, s->y + y, bitmap_pixel(s->image, s->len_x, x, y));
+            }
+        }
+    }
+}
+
+/* Changes of the background, made with the sprites off it */
+static void draw_background(void)
+{
+    uint8_t x = test_rand() % SSD1306_WIDTH, y = test_rand() % SSD1306_HEIGHT;
+
+    switch(test_rand() % 3)
+    {
+        case 0:
+            SSD1306_draw_rectangle_h(&screen, x, x + test_rand() % 30, y, y + test_rand() % 20, test_rand() & 0x01, true);
+            break;
+        case 1:
+            SSD1306_draw_circle_h(&screen, x, y, test_rand() % 20, test_rand() & 0x01);
+            break;
+        default:
+            SSD1306_print_fstr_h(&screen, "BG", SMALL_FONT, x, y, 1, test_rand() & 0x01);
+            break;
+    }
+}
+
+int main(void)
+{
+#ifdef SSD1306_PARTIAL_REFRESH
+    uint32_t data = 0, covered = 0;
+#endif
+
+    mock_reset();
+    CHECK(test_init(&screen, buffer, 0));
+
+    for(int i = 0; i < SSD1306_BUFFER_SZ; i++) buffer[i] = test_rand();
+    memcpy(background, buffer, SSD1306_BUFFER_SZ);
+    CHECK(SSD1306_refresh_h(&screen));
+    test_flush();
+
+    /* Overlapping sprites, the odd ones without a mask */
+    for(int n = 0; n < SPRITES; n++)
+    {
+        ssd_1306_sprite_t *s = &sprites[n];
+
+        *s = (ssd_1306_sprite_t){.image = images[n], .mask = (n & 0x01) ? NULL : masks[n], .save = saves[n],
+                                 .len_x = 4 + test_rand() % (SPRITE_MAX - 3), .len_y = 4 + test_rand() % (SPRITE_MAX - 3),
+                                 .x = 30 + n * 8, .y = 10 + n * 3, .z = test_rand() % 4, .visible = true};
+        /* The black pixels of a masked image are opaque */
+        for(unsigned b = 0; b < sizeof(images[n]); b++)
+        {
+            masks[n][b] = test_rand() | 0x18;
+            images[n][b] = test_rand() & (s->mask ? masks[n][b] : 0xff);
+        }
+        CHECK(SSD1306_sprite_add_h(&screen, s));
+    }
+    CHECK(!SSD1306_sprite_add_h(&screen, &sprites[0]));
+
+    for(int frame = 0; frame < 3000; frame++)
+    {
+        ssd_1306_sprite_t *s = &sprites[test_rand() % SPRITES];
+
+        switch(test_rand() % 8)
+        {
+            case 0:
+                s->visible = !s->visible;
+                break;
+            case 1:
+                SSD1306_sprite_remove_h(&screen, s);
+                s->z = test_rand() % 4;
+                CHECK(SSD1306_sprite_add_h(&screen, s));
+                break;
+            case 2:
+                SSD1306_sprites_erase_h(&screen);
+                CHECK(!memcmp(buffer, background, SSD1306_BUFFER_SZ));
+                draw_background();
+                memcpy(background, buffer, SSD1306_BUFFER_SZ);
+                break;
+            default:
+                /* Moves, sometimes across the edges */
+                s->x += test_rand() % 9 - 4;
+                s->y += test_rand() % 9 - 4;
+                if(s->x >= SSD1306_WIDTH + 10) s->x = 0;
+                if(s->y >= SSD1306_HEIGHT + 10) s->y = 0;
+                break;
+        }
+
+        SSD1306_sprites_draw_h(&screen);
+        composite();
+        if(!test_buffer_is(buffer, ref, "sprites"))
+        {
+            fprintf(stderr, "frame %d\n", frame);
+            test_failures++;
+            break;
+        }
+
+#ifdef SSD1306_PARTIAL_REFRESH
+        SSD1306_reset_stats_h(&screen);
+        CHECK(SSD1306_refresh_partial_h(&screen));
+        test_flush();
+        data += SSD1306_BUFFER_SZ - screen.stats.bytes_skipped;
+#else
+        CHECK(SSD1306_refresh_h(&screen));
+        test_flush();
+#endif
+        if(!test_panel_is(0, buffer))
+        {
+            fprintf(stderr, "frame %d\n", frame);
+            test_failures++;
+            break;
+        }
+    }
+
+#ifdef SSD1306_PARTIAL_REFRESH
+    /* Only the pages around the sprites are sent, on average less than all of their save-under areas */
+    for(int n = 0; n < SPRITES; n++) covered += SSD1306_SPRITE_SAVE_SZ(sprites[n].len_x, sprites[n].len_y);
+    CHECK(data / 3000 <= covered);
+#endif
+
+    return test_report("test_sprites");
+}
@@ -0,0 +1,347 @@
+/*
+ * Text - The fixed-width fonts printed at the cursor or anywhere, aligned, inverted and scaled,
+ * must match a reference drawn pixel by pixel from the font tables, and the output of before.
+ * So must the narrow proportional font, kerned.
+ */
+
+#include "test.h"
+
+static uint8_t buffer[SSD1306_BUFFER_SZ], ref[SSD1306_BUFFER_SZ];
+static uint8_t strip[SSD1306_STRIP_SZ];
+static ssd_1306_t screen, strip_screen;
+
+static const uint8_t fonts[3] = {SMALL_FONT, MEDIUM_FONT, LARGE_FONT};
+
+/* Width, height and last character of a fixed-width font */
+static void font_size(uint8_t font, uint8_t *width, uint8_t *height, uint8_t *last)
+{
+    switch(font)
+    {
+        case SMALL_FONT:    *width = 4; *height = 6; *last = 0x7e; break;
+        case MEDIUM_FONT:   *width = 5; *height = 7; *last = 0x7f; break;
+        default:            *width = 6; *height = 8; *last = 0x7f; break;
+    }
+}
+
+/* Column of a glyph, straight from the font tables - The small font packs 4 columns of 6 bits in 3 bytes */
+static uint8_t glyph_col(uint8_t font, uint8_t c, uint8_t col)
+{
+    const uint8_t g = c - 0x20;
+
+    if(font == MEDIUM_FONT) return medium_font[g * 5 + col];
+    if(font == LARGE_FONT) return large_font[g * 6 + col];
+
+    uint32_t bits = ((uint32_t)small_font[g * 3] << 16) | (small_font[g * 3 + 1] << 8) | small_font[g * 3 + 2];
+    return (bits >> (18 - 6 * col)) & 0x3f;
+}
+
+/* A random string, mostly printable, with some newlines and characters the fonts lack */
+static void random_string(char *str, int max)
+{
+    int len = 1 + test_rand() % (max - 1);
+
+    for(int i = 0; i < len; i++)
+    {
+        uint8_t r = test_rand() % 100;
+
+        if(r < 3) str[i] = '\n';
+        else if(r < 5) str[i] = 0x7f;
+        else if(r < 6) str[i] = 0x01;
+        else str[i] = 0x20 + test_rand() % 0x5f;
+    }
+    str[len] = '\0';
+}
+
+/* The printer at the cursor: whole glyph bytes on a page, shifted by the alignment */
+static void ref_print_str(uint8_t *x_pos, uint8_t *y_pos, const char *str, uint8_t option, bool invert)
+{
+    uint8_t font = option & FONT_MASK, width, height, last, shift = option & ALIGMENT_MASK;
+
+    font_size(font, &width, &height, &last);
+    if(font == MEDIUM_FONT) shift >>= 1;
+    if(font == LARGE_FONT) shift = 0;
+
+    for(; *str; str++)
+    {
+        uint8_t c = *str;
+
+        if((*x_pos + width) >= SSD1306_WIDTH || c == '\n')
+        {
+            *x_pos = 0;
+            (*y_pos)++;
+        }
+        if(*y_pos >= SSD1306_PAGES) *y_pos = 0;
+        if(c < 0x20 || c > last) continue;
+
+        for(uint8_t i = 0; i < width; i++)
+        {
+            uint8_t col = glyph_col(font, c, i) << shift;
+            ref[*y_pos * SSD1306_WIDTH + *x_pos + i] = invert ? ~col : col;
+        }
+        *x_pos += width;
+    }
+}
+
+/* The printer from any position, pixel by pixel with nearest neighbor in Q8.8 */
+static void ref_print_fstr(const char *str, uint8_t option, uint8_t x, uint8_t y, uint16_t scale, bool invert)
+{
+    uint8_t font = option & FONT_MASK, width, height, last;
+
+    font_size(font, &width, &height, &last);
+    uint8_t real_width = (width * scale) >> 8, real_height = (height * scale) >> 8;
+
+    for(; *str; str++)
+    {
+        uint8_t c = *str;
+
+        if((x + real_width) >= SSD1306_WIDTH || c == '\n')
+        {
+            x = 0;
+            y += real_height;
+        }
+        if(y >= SSD1306_HEIGHT) y = 0;
+        if(c < 0x20 || c > last) continue;
+
+        for(int j = 0; j < real_height; j++)
+        {
+            for(int i = 0; i < real_width; i++)
+            {
+                bool pixel = (glyph_col(font, c, (i << 8) / scale) >> ((j << 8) / scale)) & 0x01;
+                test_ref_set(ref, x + i, y + j, pixel ^ invert);
+            }
+        }
+        x += real_width;
+    }
+}
+
+static void test_print_str(void)
+{
+    char str[80], what[128];
+
+    for(int i = 0; i < 3000; i++)
+    {
+        uint8_t option = fonts[i % 3] | (test_rand() & ALIGMENT_MASK);
+        uint8_t x = test_rand() % SSD1306_WIDTH, y = test_rand() % SSD1306_HEIGHT, ref_x = x, ref_y = y >> 3;
+        bool invert = test_rand() & 0x01;
+
+        random_string(str, sizeof(str));
+        SSD1306_coord_h(&screen, x, y);
+        SSD1306_print_str_h(&screen, str, option, invert);
+        ref_print_str(&ref_x, &ref_y, str, option, invert);
+
+        snprintf(what, sizeof(what), "print_str(0x%02x, %d) at %u, %u", option, invert, x, y);
+        if(!test_buffer_is(buffer, ref, what) || screen.x_pos != ref_x || screen.y_pos != ref_y)
+        {
+            test_failures++;
+            return;
+        }
+    }
+}
+
+static void test_print_fstr(void)
+{
+    char str[40], what[128];
+
+    for(int i = 0; i < 3000; i++)
+    {
+        uint8_t option = fonts[i % 3];
+        uint8_t x = test_rand() % SSD1306_WIDTH, y = test_rand() % SSD1306_HEIGHT;
+        uint16_t scale = (i & 0x01) ? 0x0100 : 0x0100 + test_rand() % 0x0200;
+        bool invert = test_rand() & 0x01;
+
+        random_string(str, sizeof(str));
+        SSD1306_print_fstr_q8_h(&screen, str, option, x, y, scale, invert);
+        ref_print_fstr(str, option, x, y, scale, invert);
+
+        snprintf(what, sizeof(what), "print_fstr(0x%02x, 0x%04x, %d) at %u, %u", option, scale, invert, x, y);
+        if(!test_buffer_is(buffer, ref, what))
+        {
+            test_failures++;
+            return;
+        }
+    }
+}
+
+/* Scenes of labels over random contents, in every font, scale, draw mode and inversion, wrapping included */
+#define GOLDEN_SCENES   50
+#define GOLDEN_LABELS   10
+
+#if (SSD1306_WIDTH == 128) && (SSD1306_HEIGHT == 64)
+/* FNV-1a of the buffer after each scene, as drawn by the print_fstr of before the run blitter.
+ * Build with -DTEST_PRINT_GOLDEN to print them */
+static const uint32_t golden[GOLDEN_SCENES] =
+{
+    0xd00760df, 0xe1078d04, 0x91ad5794, 0x256d5bb6, 0x492a0f8d, 0x61b50c48,
+    0xc2481724, 0xa3c1da63, 0xcd0d42ef, 0x26b615f1, 0xdce03377, 0xf77c2e37,
+    0x50290dba, 0x6e7aa857, 0x2aeeee8e, 0xda90a1f6, 0x681b8062, 0x878a1c28,
+    0x9f21ef8f, 0xc4347636, 0x198581cd, 0x0d16e865, 0x4868de3a, 0x85141736,
+    0x35b7247a, 0xe3ab1555, 0x848c0cd1, 0x210d9046, 0x6df11c18, 0xcab98037,
+    0xf9475942, 0x03492b9c, 0xdcb584ad, 0xf1b17f29, 0xb2795770, 0xdfe6c7f7,
+    0xe4ca1f55, 0xe1c73b63, 0x620c8db9, 0x8726a90a, 0x357fa9b3, 0x5bf95f33,
+    0xc9447c04, 0x3efdeb93, 0x0708a7e9, 0x8e7bdfef, 0xd266f940, 0x70b27ca0,
+    0xf1e4ce33, 0xef90d5fe
+};
+
+static uint32_t fnv1a(const uint8_t *data, uint16_t len)
+{
+    uint32_t hash = 2166136261u;
+
+    for(uint16_t i = 0; i < len; i++) hash = (hash ^ data[i]) * 16777619u;
+    return hash;
+}
+#endif
+
+static void golden_scene(void)
+{
+    char str[40];
+
+    for(int i = 0; i < SSD1306_BUFFER_SZ; i++) buffer[i] = test_rand();
+
+    for(int n = 0; n < GOLDEN_LABELS; n++)
+    {
+        uint8_t option = fonts[test_rand() % 3], rop = test_rand() % 4;
+        uint8_t x = test_rand() % SSD1306_WIDTH, y = test_rand() % SSD1306_HEIGHT;
+        uint16_t scale = (test_rand() & 0x01) ? (1 + test_rand() % 3) << 8 : 0x0100 + test_rand() % 0x0200;
+        bool invert = test_rand() & 0x01;
+
+        /* Before, 0x7f was read past the end of the small font */
+        random_string(str, sizeof(str));
+        for(char *c = str; *c; c++) if(*c == 0x7f) *c = '~';
+
+        SSD1306_draw_mode_h(&screen, rop);
+        SSD1306_print_fstr_q8_h(&screen, str, option, x, y, scale, invert);
+    }
+    SSD1306_draw_mode_h(&screen, SSD1306_ROP_COPY);
+}
+
+static void test_golden(void)
+{
+    for(int i = 0; i < GOLDEN_SCENES; i++)
+    {
+        golden_scene();
+#if (SSD1306_WIDTH == 128) && (SSD1306_HEIGHT == 64)
+#ifdef TEST_PRINT_GOLDEN
+        printf("%s0x%08x,%s", (i % 6) ? " " : "    ", fnv1a(buffer, SSD1306_BUFFER_SZ),
+               (i % 6 == 5 || i == GOLDEN_SCENES - 1) ? "\n" : "");
+#else
+        if(fnv1a(buffer, SSD1306_BUFFER_SZ) != golden[i])
+        {
+            fprintf(stderr, "golden scene %d differs\n", i);
+            test_failures++;
+        }
+#endif
+#endif
+    }
+}
+
+/* Columns added to the spacing of the narrow font between two characters */
+static int narrow_kerning(char first, char second)
+{
+    for(int i = 0; i < narrow_prop_font.nb_kerning; i++)
+    {
+        const ssd_1306_kern_t *k = &narrow_prop_font.kerning[i];
+        if(k->first == (uint8_t)first && k->second == (uint8_t)second) return k->adjust;
+    }
+    return 0;
+}
+
+static void test_narrow_font(void)
+{
+    static const char sample[] = "The quick brown fox jumps over";
+    uint16_t narrow, medium;
+    char str[24], what[64];
+
+    /* About a third more characters on a line than the medium font */
+    SSD1306_text_measure(sample, MEDIUM_FONT, NULL, 1, &medium, NULL);
+    SSD1306_text_measure(sample, 0, &narrow_prop_font, 1, &narrow, NULL);
+    CHECK(narrow * 13 <= medium * 10);
+
+    /* Random strings that fit on a line, against the glyph table and the kerning pairs */
+    for(int i = 0; i < 1000; i++)
+    {
+        uint8_t y = test_rand() % (SSD1306_HEIGHT - 6);
+        int len = 1 + test_rand() % (sizeof(str) - 1), x = test_rand() % 8, width = x;
+
+        /* Half of the characters from the kerning pairs */
+        for(int n = 0; n < len; n++)
+        {
+            if(test_rand() & 0x01) str[n] = "TAVYLFPr.,aceosu"[test_rand() % 16];
+            else str[n] = 0x20 + test_rand() % 0x5f;
+        }
+        str[len] = '\0';
+
+        for(int n = 0; n < len; n++) width += narrow_prop_font.glyphs[str[n] - 0x20].width + 1 + narrow_kerning(str[n], str[n + 1]);
+        if(width > SSD1306_WIDTH) continue;
+
+        SSD1306_fill_h(&screen, false);
+        memset(ref, 0, SSD1306_BUFFER_SZ);
+        SSD1306_print_fstr_font_h(&screen, str, &narrow_prop_font, x, y, 1, false);
+
+        for(int n = 0; n < len; n++)
+        {
+            const ssd_1306_glyph_t *g = &narrow_prop_font.glyphs[str[n] - 0x20];
+
+            for(int col = 0; col < g->width; col++)
+            {
+                for(int row = 0; row < 7; row++)
+                {
+                    if((narrow_prop_font.bitmap[g->offset + col] >> row) & 0x01) test_ref_set(ref, x + col, y + row, true);
+                }
+            }
+            x += g->width + 1 + narrow_kerning(str[n], str[n + 1]);
+        }
+
+        snprintf(what, sizeof(what), "narrow \"%s\" at %u", str, y);
+        if(!test_buffer_is(buffer, ref, what))
+        {
+            test_failures++;
+            return;
+        }
+    }
+}
+
+/* Labels across the page boundaries, scaled, merged and wrapped */
+static void draw_labels(void *arg)
+{
+    ssd_1306_t *h = arg;
+
+    SSD1306_draw_rectangle_h(h, 0, SSD1306_WIDTH / 2, 2, SSD1306_HEIGHT - 3, true, true);
+    SSD1306_print_fstr_h(h, "Strips 12:34", MEDIUM_FONT, 3, 5, 1, false);
+    SSD1306_print_fstr_h(h, "Big", LARGE_FONT, 20, 3, 2, true);
+    SSD1306_print_fstr_q8_h(h, "Wrapped around the edge", SMALL_FONT, 90, 9, SSD1306_SCALE_Q8(1.5), false);
+    SSD1306_draw_mode_h(h, SSD1306_ROP_XOR);
+    SSD1306_print_fstr_h(h, "XOR\nnext", LARGE_FONT, 40, 1, 1, false);
+    SSD1306_draw_mode_h(h, SSD1306_ROP_COPY);
+}
+
+static void test_strips(void)
+{
+    SSD1306_fill_h(&screen, false);
+    draw_labels(&screen);
+    CHECK(SSD1306_refresh_h(&screen));
+    test_flush();
+
+    CHECK(test_init(&strip_screen, strip, 1));
+    CHECK(SSD1306_render_strips_h(&strip_screen, draw_labels, &strip_screen));
+    test_flush();
+    CHECK(test_panel_is(1, buffer));
+}
+
+int main(void)
+{
+    mock_reset();
+    CHECK(test_init(&screen, buffer, 0));
+
+    /* First, so that the scenes do not depend on the other tests */
+    test_golden();
+#ifdef TEST_PRINT_GOLDEN
+    return 0;
+#endif
+    memcpy(ref, buffer, SSD1306_BUFFER_SZ);
+    test_print_str();
+    test_print_fstr();
+    test_narrow_font();
+    test_strips();
+
+    return test_report("test_text");
+}
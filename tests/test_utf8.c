@@ -0,0 +1,226 @@
+/*
+ * UTF-8 - Text is decoded a character at a time, malformed bytes one at a time, and the glyphs beyond the main
+ * range of a proportional font are found in its sparse ranges. Checked against a reference drawn pixel by pixel.
+ */
+
+#include "test.h"
+
+static uint8_t buffer[SSD1306_BUFFER_SZ], ref[SSD1306_BUFFER_SZ], other_buffer[SSD1306_BUFFER_SZ];
+static ssd_1306_t screen, other;
+
+static const ssd_1306_font_t *const fonts[2] = {&medium_prop_font, &narrow_prop_font};
+
+/* Writes a code point in UTF-8, returns its number of bytes */
+static int utf8_encode(uint32_t code, char *out)
+{
+    if(code < 0x80)
+    {
+        out[0] = code;
+        return 1;
+    }
+    if(code < 0x800)
+    {
+        out[0] = 0xc0 | (code >> 6);
+        out[1] = 0x80 | (code & 0x3f);
+        return 2;
+    }
+    if(code < 0x10000)
+    {
+        out[0] = 0xe0 | (code >> 12);
+        out[1] = 0x80 | ((code >> 6) & 0x3f);
+        out[2] = 0x80 | (code & 0x3f);
+        return 3;
+    }
+    out[0] = 0xf0 | (code >> 18);
+    out[1] = 0x80 | ((code >> 12) & 0x3f);
+    out[2] = 0x80 | ((code >> 6) & 0x3f);
+    out[3] = 0x80 | (code & 0x3f);
+    return 4;
+}
+
+/* Decodes a character, longhand - Malformed bytes and code points beyond 16 bits are U+FFFD */
+static int ref_decode(const uint8_t *s, uint32_t *code)
+{
+    int len = (s[0] < 0x80) ? 1 : (s[0] >= 0xc2 && s[0] <= 0xdf) ? 2 : ((s[0] & 0xf0) == 0xe0) ? 3 : ((s[0] & 0xf8) == 0xf0) ? 4 : 0;
+    uint32_t value = (len == 1) ? s[0] : (s[0] & (0xff >> (len + 1)));
+
+    for(int i = 1; i < len; i++)
+    {
+        if((s[i] & 0xc0) != 0x80) len = 0;
+        else value = (value << 6) | (s[i] & 0x3f);
+    }
+
+    /* Overlong three bytes */
+    if(len == 3 && value < 0x800) len = 0;
+
+    *code = (len == 4 || !len) ? 0xfffd : value;
+    return len ? len : 1;
+}
+
+/* The glyph of a code point, with a linear search of the ranges */
+static const ssd_1306_glyph_t *ref_glyph(const ssd_1306_font_t *font, uint32_t code)
+{
+    if(code >= font->first && code <= font->last) return &font->glyphs[code - font->first];
+
+    for(int i = 0; i < font->nb_ranges; i++)
+    {
+        const ssd_1306_range_t *r = &font->ranges[i];
+        if(code >= r->first && code <= r->last) return &font->glyphs[r->glyph + code - r->first];
+    }
+    return NULL;
+}
+
+static int ref_kerning(const ssd_1306_font_t *font, uint32_t first, uint32_t second)
+{
+    for(int i = 0; i < font->nb_kerning; i++)
+    {
+        if(font->kerning[i].first == first && font->kerning[i].second == second) return font->kerning[i].adjust;
+    }
+    return 0;
+}
+
+/* Prints a string from a position, unscaled - False if it would wrap */
+static bool ref_print(const ssd_1306_font_t *font, const char *str, int x, int y)
+{
+    const uint8_t *s = (const uint8_t *)str;
+
+    while(*s)
+    {
+        uint32_t code, next = 0;
+        s += ref_decode(s, &code);
+        if(*s) ref_decode(s, &next);
+
+        const ssd_1306_glyph_t *g = ref_glyph(font, code);
+        if(!g || !g->width) continue;
+        if(x + g->width >= SSD1306_WIDTH) return false;
+
+        for(int col = 0; col < g->width; col++)
+        {
+            for(int row = 0; row < font->height; row++)
+            {
+                if((font->bitmap[g->offset + col] >> row) & 0x01) test_ref_set(ref, x + col, y + row, true);
+            }
+        }
+
+        int gap = font->spacing + ((code <= 0xff && next <= 0xff) ? ref_kerning(font, code, next) : 0);
+        x += g->width + (gap > 0 ? gap : 0);
+    }
+    return true;
+}
+
+/* Characters of the fonts, of other scripts, and malformed or cut sequences */
+static int random_piece(char *out)
+{
+    static const uint32_t codes[] = {0xb0, 0xb1, 0xb2, 0xb3, 0xb5, 0xd7, 0xe9, 0xf7, 0x394, 0x3a9, 0x3bc, 0x3c0, 0x3c1,
+                                     0x2190, 0x2191, 0x2193, 0x2194, 0x4e2d, 0xfffd, 0x1f600};
+    static const char *const bad[] = {"\x80", "\xbf", "\xc0\xaf", "\xc1\x81", "\xc2", "\xe2\x86", "\xe0\x80\xaf",
+                                      "\xf0\x9f\x98", "\xf8\x88\x80\x80\x80", "\xff", "\xed\xa0\x80"};
+    uint8_t r = test_rand() % 10;
+
+    if(r < 5)
+    {
+        out[0] = 0x20 + test_rand() % 0x5f;
+        return 1;
+    }
+    if(r < 8) return utf8_encode(codes[test_rand() % (sizeof(codes) / sizeof(codes[0]))], out);
+
+    const char *b = bad[test_rand() % (sizeof(bad) / sizeof(bad[0]))];
+    strcpy(out, b);
+    return strlen(b);
+}
+
+static void test_decode(void)
+{
+    char str[64], ascii[64], what[160];
+
+    for(int i = 0; i < 3000; i++)
+    {
+        const ssd_1306_font_t *font = fonts[i & 0x01];
+        uint8_t x = test_rand() % 32, y = test_rand() % (SSD1306_HEIGHT - 7);
+        int len = 0, n = 0;
+
+        for(int pieces = 1 + test_rand() % 12; pieces; pieces--) len += random_piece(str + len);
+        str[len] = '\0';
+
+        /* Proportional fonts, against the reference */
+        SSD1306_fill_h(&screen, false);
+        memset(ref, 0, SSD1306_BUFFER_SZ);
+        if(!ref_print(font, str, x, y)) continue;
+        SSD1306_print_fstr_font_h(&screen, str, font, x, y, 1, false);
+
+        snprintf(what, sizeof(what), "string %d of font %d at %u, %u", i, i & 0x01, x, y);
+        if(!test_buffer_is(buffer, ref, what))
+        {
+            test_failures++;
+            return;
+        }
+
+        /* Fixed-width fonts only have ASCII - No byte of a multi-byte character is ever an ASCII one */
+        for(int c = 0; c < len; c++)
+        {
+            if(!(str[c] & 0x80)) ascii[n++] = str[c];
+        }
+        ascii[n] = '\0';
+
+        SSD1306_fill_h(&screen, false);
+        SSD1306_fill_h(&other, false);
+        SSD1306_print_fstr_h(&screen, str, MEDIUM_FONT, x, y, 1, false);
+        SSD1306_print_fstr_h(&other, ascii, MEDIUM_FONT, x, y, 1, false);
+        if(!test_buffer_is(buffer, other_buffer, what))
+        {
+            test_failures++;
+            return;
+        }
+    }
+}
+
+static void test_ranges(void)
+{
+    char str[8];
+
+    /* Every 16-bit code point takes the columns of its glyph, or none */
+    for(int f = 0; f < 2; f++)
+    {
+        for(uint32_t code = 0x80; code < 0x10000; code++)
+        {
+            const ssd_1306_glyph_t *g = ref_glyph(fonts[f], code);
+            uint16_t width;
+
+            str[utf8_encode(code, str)] = '\0';
+            SSD1306_text_measure(str, 0, fonts[f], 1, &width, NULL);
+
+            if(width == (g ? g->width : 0)) continue;
+
+            fprintf(stderr, "U+%04x of font %d takes %u columns\n", (unsigned)code, f, width);
+            test_failures++;
+            return;
+        }
+    }
+}
+
+static void test_printf(void)
+{
+    /* Fields are padded and cut by characters */
+    SSD1306_fill_h(&screen, false);
+    SSD1306_fill_h(&other, false);
+    SSD1306_coord_h(&screen, 0, 0);
+    SSD1306_coord_h(&other, 0, 0);
+
+    SSD1306_printf_h(&screen, MEDIUM_FONT, false, "[%5s][%-4s][%.1s]", "\xc2\xb0" "C", "\xce\xa9", "\xe2\x86\x91" "x");
+    SSD1306_print_str_h(&other, "[   \xc2\xb0" "C][\xce\xa9   ][\xe2\x86\x91]", MEDIUM_FONT, false);
+    CHECK(test_buffer_is(buffer, other_buffer, "printf of UTF-8 fields"));
+    CHECK(screen.x_pos == other.x_pos && screen.y_pos == other.y_pos);
+}
+
+int main(void)
+{
+    mock_reset();
+    CHECK(test_init(&screen, buffer, 0));
+    CHECK(test_init(&other, other_buffer, 1));
+
+    test_decode();
+    test_ranges();
+    test_printf();
+
+    return test_report("test_utf8");
+}
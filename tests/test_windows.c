@@ -0,0 +1,73 @@
+/*
+ * Partial refresh windows - Dirty runs are grouped into as few address windows as pays off,
+ * and the statistics count what actually went on the bus.
+ */
+
+#include "test.h"
+
+#ifdef SSD1306_PARTIAL_REFRESH
+static uint8_t buffer[SSD1306_BUFFER_SZ];
+static ssd_1306_t screen;
+
+/* Partial refresh of what was drawn since the last one, checked against the bus and the panel */
+static void refresh(uint32_t windows, uint32_t data)
+{
+    uint32_t sent = mock_spi_bytes;
+
+    SSD1306_reset_stats_h(&screen);
+    CHECK(SSD1306_refresh_partial_h(&screen));
+    test_flush();
+
+    CHECK(screen.stats.windows == windows);
+    CHECK(screen.stats.bytes_sent == data + 6 * windows);
+    CHECK(screen.stats.bytes_skipped == SSD1306_BUFFER_SZ - data);
+    CHECK(mock_spi_bytes - sent == screen.stats.bytes_sent);
+    CHECK(test_panel_is(0, buffer));
+}
+#endif
+
+int main(void)
+{
+#ifdef SSD1306_PARTIAL_REFRESH
+    mock_reset();
+    CHECK(test_init(&screen, buffer, 0));
+    CHECK(SSD1306_refresh_h(&screen));
+    test_flush();
+
+    /* A clean gap up to the cost of a window is sent along */
+    SSD1306_draw_hline_h(&screen, 10, 9, 4, true);
+    SSD1306_draw_hline_h(&screen, 10 + 4 + SSD1306_WINDOW_COST, 9, 2, true);
+    refresh(1, 4 + SSD1306_WINDOW_COST + 2);
+
+    /* A wider one splits the windows */
+    SSD1306_draw_hline_h(&screen, 10, 9, 4, false);
+    SSD1306_draw_hline_h(&screen, 10 + 4 + SSD1306_WINDOW_COST + 1, 9, 2, false);
+    refresh(2, 6);
+
+    /* The same columns on consecutive pages share a window */
+    SSD1306_draw_vline_h(&screen, 20, 3, 12, true);
+    SSD1306_draw_vline_h(&screen, 21, 3, 12, true);
+    refresh(1, 2 * 2);
+
+    /* A run on the next page joins the window above when resending is cheaper */
+    SSD1306_draw_hline_h(&screen, 30, 4, 3, true);
+    SSD1306_draw_hline_h(&screen, 30, 12, 2, true);
+    refresh(1, 2 * 3);
+
+    /* Out of windows, the last one grows to cover the rest */
+    for(uint8_t x = 0; x + 1 < SSD1306_WIDTH; x += SSD1306_WINDOW_COST + 2)
+    {
+        for(uint8_t p = 0; p < SSD1306_PAGES; p++) SSD1306_set_pixel_h(&screen, x, p * 8 + 1, true);
+    }
+    SSD1306_reset_stats_h(&screen);
+    CHECK(SSD1306_refresh_partial_h(&screen));
+    test_flush();
+    CHECK(screen.stats.windows <= SSD1306_MAX_WINDOWS);
+    CHECK(test_panel_is(0, buffer));
+
+    /* Nothing drawn, nothing sent */
+    refresh(0, 0);
+#endif
+
+    return test_report("test_windows");
+}
@@ -0,0 +1,499 @@
+#!/usr/bin/env python3
+"""Converts images and fonts into C arrays for the SSD1306 library.
+
+Images (PBM, XBM) become bitmaps in the layout of SSD1306_draw_bitmap(): bank by bank
+(8 rows), a byte per column, the top row in bit 0. Fonts (BDF) become proportional
+ssd_1306_font_t fonts, with the characters beyond the main range in sparse ranges.
+
+    python3 tools/ssd1306_assets.py -o assets --rle --invert --scale 2 logo.pbm icons.xbm font.bdf=ui_font
+
+writes assets.h (sizes and declarations) and assets.c (the arrays). A name can be given
+after '=', otherwise it is taken from the file name.
+
+Variants of the bitmaps, computed here instead of at run time:
+    --pad8      Height rounded up to a multiple of 8, for SSD1306_draw_bitmap_opt8()
+    --invert    <name>_inv, the bitmap with its pixels inverted
+    --scale N   <name>_xN, the bitmap scaled N times, as SSD1306_draw_bitmap() scales it
+    --rle       <name>_rle, the bitmap compressed (see below) for SSD1306_draw_bitmap_rle(), for every variant
+
+RLE format - The bytes of the bitmap, bank by bank, as a sequence of packets. Runs go on
+across the banks. Every packet starts with a control byte c:
+    0x00 - 0x7f     c + 1 literal bytes follow (1 to 128)
+    0x80 - 0xff     The next byte is repeated c - 0x80 + 2 times (2 to 129)
+"""
+
+import argparse
+import os
+import re
+import sys
+
+RLE_LITERAL_MAX = 128
+RLE_REPEAT_MIN = 2
+RLE_REPEAT_MAX = 129
+
+
+class Image:
+    """A monochrome image, rows of 0/1 pixels (1 is black, a set bit on the screen)."""
+
+    def __init__(self, width, height, rows):
+        self.width = width
+        self.height = height
+        self.rows = rows
+
+    def pixel(self, x, y):
+        return self.rows[y][x]
+
+
+# ---------------------------------------------------------------------------
+# Readers
+# ---------------------------------------------------------------------------
+
+def _pbm_tokens(data):
+    """Header tokens of a PBM file, and the offset of the data after them."""
+    tokens, pos = [], 0
+
+    while len(tokens) < 3:
+        while data[pos:pos + 1].isspace():
+            pos += 1
+        if data[pos:pos + 1] == b'#':
+            while data[pos:pos + 1] not in (b'\n', b''):
+                pos += 1
+            continue
+        start = pos
+        while pos < len(data) and not data[pos:pos + 1].isspace():
+            pos += 1
+        tokens.append(data[start:pos])
+
+    # A single whitespace separates the header from the binary data
+    return tokens, pos + 1
+
+
+def read_pbm(path):
+    with open(path, 'rb') as f:
+        data = f.read()
+
+    tokens, pos = _pbm_tokens(data)
+    magic, width, height = tokens[0], int(tokens[1]), int(tokens[2])
+
+    if magic == b'P4':
+        stride = (width + 7) // 8
+        rows = []
+        for y in range(height):
+            line = data[pos + y * stride:pos + (y + 1) * stride]
+            if len(line) < stride:
+                raise ValueError('%s: truncated data' % path)
+            rows.append([(line[x >> 3] >> (7 - (x & 7))) & 1 for x in range(width)])
+        return Image(width, height, rows)
+
+    if magic == b'P1':
+        text = re.sub(rb'#[^\n]*', b'', data[pos:])
+        bits = [int(c) for c in re.sub(rb'\s', b'', text).decode('ascii')]
+        if len(bits) < width * height:
+            raise ValueError('%s: truncated data' % path)
+        return Image(width, height, [bits[y * width:(y + 1) * width] for y in range(height)])
+
+    raise ValueError('%s: not a PBM file (P1 or P4)' % path)
+
+
+def read_xbm(path):
+    with open(path) as f:
+        text = f.read()
+
+    width = re.search(r'#define\s+\w*width\s+(\d+)', text)
+    height = re.search(r'#define\s+\w*height\s+(\d+)', text)
+    body = re.search(r'\{([^}]*)\}', text)
+    if not (width and height and body):
+        raise ValueError('%s: not an XBM file' % path)
+
+    width, height = int(width.group(1)), int(height.group(1))
+    values = [int(v, 0) for v in re.findall(r'0[xX][0-9a-fA-F]+|\d+', body.group(1))]
+
+    # Rows are padded to whole bytes, the leftmost pixel in the lowest bit
+    stride = (width + 7) // 8
+    if len(values) < stride * height:
+        raise ValueError('%s: truncated data' % path)
+
+    rows = [[(values[y * stride + (x >> 3)] >> (x & 7)) & 1 for x in range(width)] for y in range(height)]
+    return Image(width, height, rows)
+
+
+class Glyph:
+    def __init__(self, code, columns, height):
+        self.code = code
+        self.columns = columns     # A column per x, as an integer of height bits (bit 0 on top)
+        self.height = height
+
+
+def read_bdf(path, spacing):
+    """Glyphs of a BDF font, in cells of the font's height with the baseline at its ascent."""
+    with open(path) as f:
+        lines = f.read().splitlines()
+
+    ascent = descent = None
+    box = None
+    glyphs = {}
+    i = 0
+
+    while i < len(lines):
+        words = lines[i].split()
+        i += 1
+        if not words:
+            continue
+
+        if words[0] == 'FONTBOUNDINGBOX':
+            box = [int(v) for v in words[1:5]]
+        elif words[0] == 'FONT_ASCENT':
+            ascent = int(words[1])
+        elif words[0] == 'FONT_DESCENT':
+            descent = int(words[1])
+        elif words[0] == 'STARTCHAR':
+            code, dwidth, bbx, bitmap = None, None, None, []
+
+            while i < len(lines) and not lines[i].startswith('ENDCHAR'):
+                words = lines[i].split()
+                i += 1
+                if not words:
+                    continue
+                if words[0] == 'ENCODING':
+                    code = int(words[1])
+                elif words[0] == 'DWIDTH':
+                    dwidth = int(words[1])
+                elif words[0] == 'BBX':
+                    bbx = [int(v) for v in words[1:5]]
+                elif words[0] == 'BITMAP':
+                    while i < len(lines) and not lines[i].startswith('ENDCHAR'):
+                        bitmap.append(lines[i].strip())
+                        i += 1
+            i += 1
+
+            if code is not None and code >= 0 and bbx is not None:
+                glyphs[code] = (dwidth if dwidth is not None else bbx[0] + bbx[2], bbx, bitmap)
+
+    if ascent is None or descent is None:
+        if box is None:
+            raise ValueError('%s: no FONT_ASCENT/FONT_DESCENT nor FONTBOUNDINGBOX' % path)
+        ascent, descent = box[1] + box[3], -box[3]
+
+    height = ascent + descent
+    if not 0 < height <= 255:
+        raise ValueError('%s: unsupported font height %d' % (path, height))
+
+    result = {}
+    for code, (dwidth, (w, h, xoff, yoff), bitmap) in glyphs.items():
+        columns = [0] * w
+        top = ascent - (h + yoff)   # Row of the glyph's first bitmap row in the cell
+
+        for r, line in enumerate(bitmap[:h]):
+            y = top + r
+            if not 0 <= y < height or not line:
+                continue
+            bits = int(line, 16)
+            nbits = len(line) * 4
+            for x in range(w):
+                if (bits >> (nbits - 1 - x)) & 1:
+                    columns[x] |= 1 << y
+
+        # The glyphs keep only their ink, the font's spacing separates them
+        while columns and not columns[-1]:
+            columns.pop()
+        while columns and not columns[0]:
+            columns.pop(0)
+        if not columns:
+            columns = [0] * max(1, dwidth - spacing)
+
+        result[code] = Glyph(code, columns, height)
+
+    return result, height
+
+
+# ---------------------------------------------------------------------------
+# Conversions
+# ---------------------------------------------------------------------------
+
+def banks(image, pad8=False):
+    """Bytes of the image, bank by bank like SSD1306_draw_bitmap()."""
+    height = (image.height + 7) & ~7 if pad8 else image.height
+    out = bytearray()
+
+    for bank in range((height + 7) // 8):
+        for x in range(image.width):
+            byte = 0
+            for bit in range(8):
+                y = bank * 8 + bit
+                if y < image.height and image.pixel(x, y):
+                    byte |= 1 << bit
+            out.append(byte)
+
+    return bytes(out), height
+
+
+def invert(image):
+    return Image(image.width, image.height, [[p ^ 1 for p in row] for row in image.rows])
+
+
+def scale(image, factor):
+    if image.width * factor > 255 or image.height * factor > 255:
+        raise ValueError('scaled bitmap larger than 255 pixels')
+    rows = [[p for p in row for _ in range(factor)] for row in image.rows for _ in range(factor)]
+    return Image(image.width * factor, image.height * factor, rows)
+
+
+def rle(data):
+    """Compresses bytes into the RLE format of the module docstring."""
+    out = bytearray()
+    literal = bytearray()
+    i = 0
+
+    def flush():
+        for start in range(0, len(literal), RLE_LITERAL_MAX):
+            chunk = literal[start:start + RLE_LITERAL_MAX]
+            out.append(len(chunk) - 1)
+            out.extend(chunk)
+        literal.clear()
+
+    while i < len(data):
+        run = 1
+        while i + run < len(data) and data[i + run] == data[i] and run < RLE_REPEAT_MAX:
+            run += 1
+
+        # A run of two only pays off between other runs, inside literals it costs a byte
+        if run > RLE_REPEAT_MIN or (run == RLE_REPEAT_MIN and not literal):
+            flush()
+            out.append(0x80 + run - RLE_REPEAT_MIN)
+            out.append(data[i])
+            i += run
+        else:
+            literal.append(data[i])
+            i += 1
+
+    flush()
+    return bytes(out)
+
+
+def unrle(data):
+    """Reference decoder of the RLE format, used to check the encoder."""
+    out = bytearray()
+    i = 0
+
+    while i < len(data):
+        c = data[i]
+        if c < 0x80:
+            out.extend(data[i + 1:i + 2 + c])
+            i += 2 + c
+        else:
+            out.extend(bytes([data[i + 1]]) * (c - 0x80 + RLE_REPEAT_MIN))
+            i += 2
+
+    return bytes(out)
+
+
+def font_tables(glyphs, height, first, last):
+    """Bitmap, glyph table and ranges of a proportional font."""
+    codes = sorted(c for c in glyphs if not first <= c <= last)
+    bitmap = bytearray()
+    table = []
+    nb_banks = (height + 7) // 8
+
+    def add(glyph):
+        if glyph is None:
+            table.append((len(bitmap), 0, None))
+            return
+        table.append((len(bitmap), len(glyph.columns), glyph.code))
+        for bank in range(nb_banks):
+            bitmap.extend((col >> (bank * 8)) & 0xff for col in glyph.columns)
+
+    # The main range is indexed straight - Characters missing from it are not drawn (width 0)
+    for code in range(first, last + 1):
+        add(glyphs.get(code))
+
+    ranges = []
+    for code in codes:
+        if code > 0xffff:
+            continue
+        if ranges and ranges[-1][1] + 1 == code:
+            ranges[-1][1] = code
+        else:
+            ranges.append([code, code, len(table)])
+        add(glyphs[code])
+
+    if len(ranges) > 255:
+        raise ValueError('more than 255 ranges')
+    if len(bitmap) > 0xffff:
+        raise ValueError('font bitmap larger than 64 KB')
+
+    return bytes(bitmap), table, ranges
+
+
+# ---------------------------------------------------------------------------
+# Output
+# ---------------------------------------------------------------------------
+
+def c_name(text):
+    name = re.sub(r'\W', '_', text)
+    return '_' + name if name[:1].isdigit() else name
+
+
+def c_bytes(data, indent='    ', per_line=16):
+    lines = []
+    for start in range(0, len(data), per_line):
+        lines.append(indent + ', '.join('0x%02x' % b for b in data[start:start + per_line]) + ',')
+    return '\n'.join(lines)
+
+
+def char_comment(code):
+    if 0x20 < code < 0x7f and chr(code) not in '\\':
+        return '%02x %s' % (code, chr(code))
+    return '%02x' % code
+
+
+class Output:
+    def __init__(self, base):
+        self.base = base
+        self.guard = '__%s_H' % c_name(os.path.basename(base)).upper()
+        self.header = []
+        self.source = []
+        self.fonts = False
+
+    def bitmap(self, name, image, data, height, comment):
+        upper = name.upper()
+        self.header.append('#define %s_WIDTH %d' % (upper, image.width))
+        self.header.append('#define %s_HEIGHT %d' % (upper, height))
+        self.header.append('#define %s_SZ %d' % (upper, len(data)))
+        self.header.append('extern const uint8_t %s[%s_SZ];\n' % (name, upper))
+        self.source.append('/* %s */\nconst uint8_t %s[%s_SZ] =\n{\n%s\n};\n' % (comment, name, upper, c_bytes(data)))
+
+    def rle(self, name, data, comment):
+        upper = name.upper()
+        packed = rle(data)
+        assert unrle(packed) == data
+        self.header.append('#define %s_RLE_SZ %d' % (upper, len(packed)))
+        self.header.append('extern const uint8_t %s_rle[%s_RLE_SZ];\n' % (name, upper))
+        self.source.append('/* %s - RLE, %d bytes for %d */\nconst uint8_t %s_rle[%s_RLE_SZ] =\n{\n%s\n};\n'
+                           % (comment, len(packed), len(data), name, upper, c_bytes(packed)))
+
+    def font(self, name, glyphs, height, spacing, first, last):
+        self.fonts = True
+        bitmap, table, ranges = font_tables(glyphs, height, first, last)
+
+        # The glyph columns, a line per glyph like the fonts of the library
+        bitmap_lines = []
+        glyph_lines = []
+        for i, (offset, width, code) in enumerate(table):
+            glyph_lines.append('    {%d, %d},' % (offset, width) + ('' if code is None else ' // ' + char_comment(code)))
+            if width:
+                end = table[i + 1][0] if i + 1 < len(table) else len(bitmap)
+                lines = c_bytes(bitmap[offset:end]).split('\n')
+                bitmap_lines.append((lines[0], char_comment(code)))
+                bitmap_lines += [(line, None) for line in lines[1:]]
+
+        column = max(len(line) for line, _ in bitmap_lines) + 4 if bitmap_lines else 0
+        bitmap_text = '\n'.join(line if comment is None else line.ljust(column) + '// ' + comment
+                                for line, comment in bitmap_lines)
+
+        src = '/* %s - %d glyphs, %d rows */\n' % (name, len(table), height)
+        src += 'static const uint8_t %s_bitmap[] =\n{\n%s\n};\n\n' % (name, bitmap_text)
+        src += 'static const ssd_1306_glyph_t %s_glyphs[] =\n{\n%s\n};\n\n' % (name, '\n'.join(glyph_lines))
+        if ranges:
+            src += 'static const ssd_1306_range_t %s_ranges[] =\n{\n%s\n};\n\n' % (
+                name, '\n'.join('    {0x%04x, 0x%04x, %d},' % tuple(r) for r in ranges))
+        src += 'const ssd_1306_font_t %s =\n{\n' % name
+        src += '    .bitmap = %s_bitmap,\n' % name
+        src += '    .glyphs = %s_glyphs,\n' % name
+        if ranges:
+            src += '    .ranges = %s_ranges,\n' % name
+            src += '    .nb_ranges = sizeof(%s_ranges) / sizeof(%s_ranges[0]),\n' % (name, name)
+        src += '    .first = 0x%02x,\n    .last = 0x%02x,\n' % (first, last)
+        src += '    .height = %d,\n    .spacing = %d\n};\n' % (height, spacing)
+
+        self.header.append('extern const ssd_1306_font_t %s;\n' % name)
+        self.source.append(src)
+
+    def write(self):
+        name = os.path.basename(self.base)
+        header = ['/* Generated by tools/ssd1306_assets.py - Do not edit */',
+                  '#ifndef %s' % self.guard, '#define %s' % self.guard, '',
+                  '#include <stdint.h>']
+        if self.fonts:
+            header.append('#include "ssd_1306_font.h"')
+        header += [''] + self.header + ['#endif /* %s */' % self.guard]
+
+        source = ['/* Generated by tools/ssd1306_assets.py - Do not edit */',
+                  '#include "%s.h"' % name, ''] + self.source
+
+        with open(self.base + '.h', 'w') as f:
+            f.write('\n'.join(header) + '\n')
+        with open(self.base + '.c', 'w') as f:
+            f.write('\n'.join(source))
+
+
+def parse_args(argv):
+    parser = argparse.ArgumentParser(description='Converts PBM/XBM images and BDF fonts into C arrays for the SSD1306 library.')
+    parser.add_argument('inputs', nargs='+', help='Input files, as path or path=name')
+    parser.add_argument('-o', '--output', required=True, help='Output base name, writes <output>.h and <output>.c')
+    parser.add_argument('--pad8', action='store_true', help='Round the bitmap heights up to a multiple of 8')
+    parser.add_argument('--invert', action='store_true', help='Add the inverted bitmaps')
+    parser.add_argument('--scale', type=int, action='append', default=[], help='Add the bitmaps scaled N times')
+    parser.add_argument('--rle', action='store_true', help='Add the RLE compressed bitmaps')
+    parser.add_argument('--spacing', type=int, default=1, help='Columns between the glyphs of the fonts (1)')
+    parser.add_argument('--first', type=lambda v: int(v, 0), default=0x20, help='First character of the fonts main range (0x20)')
+    parser.add_argument('--last', type=lambda v: int(v, 0), default=0x7e, help='Last character of the fonts main range (0x7e)')
+    parser.add_argument('--chars', default=None, help='Characters of the fonts beyond the main range, e.g. 0xb0-0xff,0x2190-0x2193 (all)')
+    return parser.parse_args(argv)
+
+
+def char_filter(spec):
+    if spec is None:
+        return lambda code: True
+    ranges = []
+    for part in spec.split(','):
+        lo, _, hi = part.partition('-')
+        ranges.append((int(lo, 0), int(hi or lo, 0)))
+    return lambda code: any(lo <= code <= hi for lo, hi in ranges)
+
+
+def main(argv):
+    args = parse_args(argv)
+    if not 0 <= args.first <= args.last <= 0xff:
+        sys.exit('error: the main range must be within 0x00-0xff')
+
+    out = Output(args.output)
+    wanted = char_filter(args.chars)
+
+    for item in args.inputs:
+        path, _, name = item.partition('=')
+        name = c_name(name or os.path.splitext(os.path.basename(path))[0])
+        ext = os.path.splitext(path)[1].lower()
+
+        try:
+            if ext == '.bdf':
+                glyphs, height = read_bdf(path, args.spacing)
+                glyphs = {c: g for c, g in glyphs.items() if args.first <= c <= args.last or wanted(c)}
+                out.font(name, glyphs, height, args.spacing, args.first, args.last)
+                continue
+
+            image = read_xbm(path) if ext == '.xbm' else read_pbm(path)
+            if image.width > 255 or image.height > 255:
+                raise ValueError('%s: bitmaps are limited to 255x255' % path)
+        except (OSError, ValueError) as e:
+            sys.exit('error: %s' % e)
+
+        variants = [(name, image, path)]
+        if args.invert:
+            variants.append((name + '_inv', invert(image), path + ', inverted'))
+        for factor in args.scale:
+            try:
+                variants.append((name + '_x%d' % factor, scale(image, factor), path + ', scaled x%d' % factor))
+            except ValueError as e:
+                sys.exit('error: %s: %s' % (path, e))
+
+        for var_name, var_image, comment in variants:
+            data, height = banks(var_image, args.pad8)
+            out.bitmap(var_name, var_image, data, height, comment)
+            if args.rle:
+                out.rle(var_name, data, comment)
+
+    out.write()
+
+
+if __name__ == '__main__':
+    main(sys.argv[1:])